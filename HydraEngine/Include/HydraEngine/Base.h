@@ -72,6 +72,9 @@
 #   define HE_ENABLE_LOGGING
 #else
     constexpr const char* c_BuildConfig = "Dist";
+#   ifdef HE_DIST_LOGGING
+#       define HE_ENABLE_LOGGING // opt-in for the engine and the app alike, meant for LogDesc::Mode::Binary in shipped builds
+#   endif
 #endif
 
 #define HE_EXPAND_MACRO(x) x
@@ -97,29 +100,70 @@
 // Log
 //////////////////////////////////////////////////////////////////////////
 
-#ifdef HE_ENABLE_LOGGING
-    #define HE_CORE_TRACE(...)    HE::Log::CoreTrace(std::format(__VA_ARGS__).c_str())
-    #define HE_CORE_INFO(...)     HE::Log::CoreInfo(std::format(__VA_ARGS__).c_str())
-    #define HE_CORE_WARN(...)     HE::Log::CoreWarn(std::format(__VA_ARGS__).c_str())
-    #define HE_CORE_ERROR(...)    HE::Log::CoreError(std::format(__VA_ARGS__).c_str())
-    #define HE_CORE_CRITICAL(...) HE::Log::CoreCritical(std::format(__VA_ARGS__).c_str())
+#define HE_LOG_LEVEL_TRACE    0
+#define HE_LOG_LEVEL_INFO     1
+#define HE_LOG_LEVEL_WARN     2
+#define HE_LOG_LEVEL_ERROR    3
+#define HE_LOG_LEVEL_CRITICAL 4
+#define HE_LOG_LEVEL_OFF      5
+
+// levels below HE_LOG_ACTIVE_LEVEL are compiled out, define it before including HydraEngine to override the per-config default.
+// Debug and Profile keep Trace, profiles should show what the traces cost, Release and Dist strip it.
+#ifndef HE_LOG_ACTIVE_LEVEL
+#   if HE_DEBUG || HE_PROFILE
+#       define HE_LOG_ACTIVE_LEVEL HE_LOG_LEVEL_TRACE
+#   else
+#       define HE_LOG_ACTIVE_LEVEL HE_LOG_LEVEL_INFO
+#   endif
+#endif
+
+// the arguments are only evaluated and formatted when the logger accepts the level and the call site is not rate limited
+#define HE_INTERNAL_LOG(logger, level, ...) do { static HE::Log::Site s_HELogSite(__FILE__, __LINE__); if (HE::Log::Admit(s_HELogSite, HE::Log::Logger::logger, HE::LogLevel::level)) HE::Log::Print(&s_HELogSite, HE::Log::Logger::logger, HE::LogLevel::level, __VA_ARGS__); } while (0)
 
-    #define HE_TRACE(...)         HE::Log::ClientTrace(std::format(__VA_ARGS__).c_str()) 
-    #define HE_INFO(...)          HE::Log::ClientInfo(std::format(__VA_ARGS__).c_str())
-    #define HE_WARN(...)          HE::Log::ClientWarn(std::format(__VA_ARGS__).c_str())
-    #define HE_ERROR(...)         HE::Log::ClientError(std::format(__VA_ARGS__).c_str())
-    #define HE_CRITICAL(...)      HE::Log::ClientCritical(std::format(__VA_ARGS__).c_str())
+// no call site state, usable in constexpr functions, used by asserts which should never be dropped
+#define HE_INTERNAL_LOG_NO_SITE(logger, level, ...) do { if (HE::Log::ShouldLog(HE::Log::Logger::logger, HE::LogLevel::level)) HE::Log::Print(nullptr, HE::Log::Logger::logger, HE::LogLevel::level, __VA_ARGS__); } while (0)
+
+#if defined(HE_ENABLE_LOGGING) && HE_LOG_ACTIVE_LEVEL <= HE_LOG_LEVEL_TRACE
+    #define HE_CORE_TRACE(...)    HE_INTERNAL_LOG(Core, Trace, __VA_ARGS__)
+    #define HE_TRACE(...)         HE_INTERNAL_LOG(Client, Trace, __VA_ARGS__)
 #else
     #define HE_CORE_TRACE(...)
-    #define HE_CORE_INFO(...)
-    #define HE_CORE_WARN(...)
-    #define HE_CORE_ERROR(...)
-    #define HE_CORE_CRITICAL(...)
-    
     #define HE_TRACE(...)
+#endif
+
+#if defined(HE_ENABLE_LOGGING) && HE_LOG_ACTIVE_LEVEL <= HE_LOG_LEVEL_INFO
+    #define HE_CORE_INFO(...)     HE_INTERNAL_LOG(Core, Info, __VA_ARGS__)
+    #define HE_INFO(...)          HE_INTERNAL_LOG(Client, Info, __VA_ARGS__)
+#else
+    #define HE_CORE_INFO(...)
     #define HE_INFO(...)
+#endif
+
+#if defined(HE_ENABLE_LOGGING) && HE_LOG_ACTIVE_LEVEL <= HE_LOG_LEVEL_WARN
+    #define HE_CORE_WARN(...)     HE_INTERNAL_LOG(Core, Warn, __VA_ARGS__)
+    #define HE_WARN(...)          HE_INTERNAL_LOG(Client, Warn, __VA_ARGS__)
+#else
+    #define HE_CORE_WARN(...)
     #define HE_WARN(...)
+#endif
+
+#if defined(HE_ENABLE_LOGGING) && HE_LOG_ACTIVE_LEVEL <= HE_LOG_LEVEL_ERROR
+    #define HE_CORE_ERROR(...)    HE_INTERNAL_LOG(Core, Error, __VA_ARGS__)
+    #define HE_ERROR(...)         HE_INTERNAL_LOG(Client, Error, __VA_ARGS__)
+    #define HE_INTERNAL_ASSERT_LOG_CORE_(...) HE_INTERNAL_LOG_NO_SITE(Core, Error, __VA_ARGS__)
+    #define HE_INTERNAL_ASSERT_LOG_(...)      HE_INTERNAL_LOG_NO_SITE(Client, Error, __VA_ARGS__)
+#else
+    #define HE_CORE_ERROR(...)
     #define HE_ERROR(...)
+    #define HE_INTERNAL_ASSERT_LOG_CORE_(...)
+    #define HE_INTERNAL_ASSERT_LOG_(...)
+#endif
+
+#if defined(HE_ENABLE_LOGGING) && HE_LOG_ACTIVE_LEVEL <= HE_LOG_LEVEL_CRITICAL
+    #define HE_CORE_CRITICAL(...) HE_INTERNAL_LOG(Core, Critical, __VA_ARGS__)
+    #define HE_CRITICAL(...)      HE_INTERNAL_LOG(Client, Critical, __VA_ARGS__)
+#else
+    #define HE_CORE_CRITICAL(...)
     #define HE_CRITICAL(...)
 #endif
 
@@ -137,7 +181,7 @@
 #   error "Platform doesn't support debugbreak yet!"
 #endif
 
-#define HE_INTERNAL_ASSERT_IMPL(type, check, msg, ...) { if(!(check)) { HE##type##ERROR(msg, __VA_ARGS__); HE_DEBUGBREAK(); } }
+#define HE_INTERNAL_ASSERT_IMPL(type, check, msg, ...) { if(!(check)) { HE_INTERNAL_ASSERT_LOG##type(msg, __VA_ARGS__); HE_DEBUGBREAK(); } }
 #define HE_INTERNAL_ASSERT_WITH_MSG(type, check, ...) HE_INTERNAL_ASSERT_IMPL(type, check, "Check failed: {0}", __VA_ARGS__)
 #define HE_INTERNAL_ASSERT_NO_MSG(type, check) HE_INTERNAL_ASSERT_IMPL(type, check, "Check '{0}' failed at {1}:{2}", HE_STRINGIFY_MACRO(check), std::filesystem::path(__FILE__).filename().string(), __LINE__)
 #define HE_INTERNAL_ASSERT_GET_MACRO_NAME(arg1, arg2, macro, ...) macro
@@ -163,26 +207,41 @@
 // Profiler
 //////////////////////////////////////////////////////////////////////////
 
+#define HE_CONCAT_IMPL(a, b) a##b
+#define HE_CONCAT(a, b) HE_CONCAT_IMPL(a, b)
+
+// engine profiler, compiled into every config unless HE_DISABLE_NATIVE_PROFILER is defined, off until Profiler::SetEnabled(true)
+#ifndef HE_DISABLE_NATIVE_PROFILER
+#   define HE_NATIVE_PROFILE_SCOPE(name)                                                                                             \
+        static constexpr HE::Profiler::ZoneDesc HE_CONCAT(s_HEProfileZone, __LINE__){ name, __FUNCTION__, __FILE__, uint32_t(__LINE__) }; \
+        HE::Profiler::Scope HE_CONCAT(s_HEProfileScope, __LINE__)(&HE_CONCAT(s_HEProfileZone, __LINE__))
+#else
+#   define HE_NATIVE_PROFILE_SCOPE(name)
+#endif
+
+// brackets the commands recorded in this scope with a GPU timer query, see GPUProfiler
+#define HE_GPU_PROFILE_SCOPE(commandList, name) HE::GPUProfiler::Scope HE_CONCAT(s_HEGPUProfileScope, __LINE__)(commandList, name)
+
 #if HE_PROFILE 
 #   ifndef TRACY_ENABLE
 #       define TRACY_ENABLE
 #   endif
 #   include "tracy/Tracy.hpp"
-#   define HE_PROFILE_SCOPE(name) ZoneScopedN(name)
-#   define HE_PROFILE_SCOPE_COLOR(color) ZoneScopedC(color)
-#   define HE_PROFILE_SCOPE_NC(name,color) ZoneScopedNC(name, color)
-#   define HE_PROFILE_FUNCTION() ZoneScoped
-#   define HE_PROFILE_FRAME() FrameMark 
+#   define HE_PROFILE_SCOPE(name) ZoneScopedN(name); HE_NATIVE_PROFILE_SCOPE(name)
+#   define HE_PROFILE_SCOPE_COLOR(color) ZoneScopedC(color); HE_NATIVE_PROFILE_SCOPE(__FUNCTION__)
+#   define HE_PROFILE_SCOPE_NC(name,color) ZoneScopedNC(name, color); HE_NATIVE_PROFILE_SCOPE(name)
+#   define HE_PROFILE_FUNCTION() ZoneScoped; HE_NATIVE_PROFILE_SCOPE(__FUNCTION__)
+#   define HE_PROFILE_FRAME() FrameMark
 #   define HE_PROFILE_TAG(y, x) ZoneText(x, strlen(x))
 #   define HE_PROFILE_LOG(text, size) TracyMessage(text, size)
 #   define HE_PROFILE_VALUE(text, value) TracyPlot(text, value)
 #   define HE_PROFILE_ALLOC(p, size) TracyAlloc(ptr, size)
 #   define HE_PROFILE_FREE(p) TracyFree(ptr);
 #else
-#   define HE_PROFILE_SCOPE(name)
-#   define HE_PROFILE_SCOPE_COLOR(color)
-#   define HE_PROFILE_SCOPE_NC(name, color)
-#   define HE_PROFILE_FUNCTION()
+#   define HE_PROFILE_SCOPE(name) HE_NATIVE_PROFILE_SCOPE(name)
+#   define HE_PROFILE_SCOPE_COLOR(color) HE_NATIVE_PROFILE_SCOPE(__FUNCTION__)
+#   define HE_PROFILE_SCOPE_NC(name, color) HE_NATIVE_PROFILE_SCOPE(name)
+#   define HE_PROFILE_FUNCTION() HE_NATIVE_PROFILE_SCOPE(__FUNCTION__)
 #   define HE_PROFILE_FRAME()
 #   define HE_PROFILE_TAG(y, x)
 #   define HE_PROFILE_LOG(text, size)
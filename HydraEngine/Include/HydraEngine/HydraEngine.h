@@ -23,6 +23,11 @@
 #include <filesystem>
 #include <string>
 #include <span>
+#include <format>
+#include <cstring>
+#include <typeinfo>
+#include <unordered_set>
+#include <shared_mutex>
 
 namespace Math = glm;
 
@@ -40,11 +45,50 @@ namespace HE {
     // Basic
     //////////////////////////////////////////////////////////////////////////
 
+    enum class LogLevel : uint8_t
+    {
+        Trace, Info, Warn, Error, Critical, Off
+    };
+
+    // per call site limits, a site is a single HE_CORE_*/HE_* macro invocation
+    struct LogRateLimit
+    {
+        uint32_t burst = 20;    // messages per site per interval, 0 disables rate limiting
+        float interval = 1.0f;  // seconds
+        bool coalesce = false;  // collapse identical messages from a site within an interval into a "repeated N times" line
+    };
+
+    struct LogDesc
+    {
+        enum class Mode : uint8_t
+        {
+            Sync,   // formatted and written on the calling thread
+            Async,  // queued on a bounded lock-free ring and written in batches by one dedicated writer thread
+            Binary  // format id and raw arguments written to a .helog file, decoded offline by LogDecoder, Warn and above also go to the console
+        };
+
+        enum class OverflowPolicy : uint8_t
+        {
+            Block,      // the caller waits for room in the queue
+            Drop,       // the new message is discarded
+            DropOldest  // the oldest queued message is discarded
+        };
+
+        Mode mode = Mode::Sync;
+        OverflowPolicy overflowPolicy = OverflowPolicy::Block;
+        uint32_t queueSize = 8192;              // messages, async only
+        std::optional<LogLevel> flushLevel;     // messages at or above this level flush the sinks, unset is Trace in Sync mode and Warn otherwise
+        float flushInterval = 0.0f;             // seconds, periodic flush, 0 disables it, binary mode drains thread buffers at least once a second
+        uint32_t binaryBufferSize = 64 * 1024;  // bytes, per thread, binary only
+        LogRateLimit coreRateLimit;
+        LogRateLimit clientRateLimit;
+    };
+
 #ifdef HE_ENABLE_LOGGING
 
     namespace Log {
 
-        HYDRA_API void Init(const std::filesystem::path& client);
+        HYDRA_API void Init(const std::filesystem::path& client, const LogDesc& desc = {});
         HYDRA_API void Shutdown();
 
         HYDRA_API void CoreTrace(const char* s);
@@ -58,6 +102,123 @@ namespace HE {
         HYDRA_API void ClientWarn(const char* s);
         HYDRA_API void ClientError(const char* s);
         HYDRA_API void ClientCritical(const char* s);
+
+        enum class Logger : uint8_t { Core, Client };
+
+        // counters of a site, owned by the engine so held back counts outlive the module the site lives in
+        struct SiteState;
+
+        // static state of one logging call site, constant initialized so the macros add no guard
+        struct Site
+        {
+            const char* file;
+            uint32_t line;
+            std::atomic<SiteState*> state = nullptr; // created on the first rate limited or coalesced message
+
+            constexpr Site(const char* file, uint32_t line) : file(file), line(line) {}
+        };
+
+        HYDRA_API bool ShouldLog(Logger logger, LogLevel level);
+        HYDRA_API void Write(Logger logger, LogLevel level, std::string_view message);
+
+        // level check plus the per site rate limit, reports messages dropped in the previous window
+        HYDRA_API bool Admit(Site& site, Logger logger, LogLevel level);
+
+        // false when the message repeats the previous one from this site, the key is hashed and never stored
+        HYDRA_API bool Coalesce(Site& site, Logger logger, LogLevel level, std::string_view key, std::string_view extra = {});
+
+        HYDRA_API void SetRateLimit(Logger logger, const LogRateLimit& limit); // safe while other threads log
+
+        // writes the suppressed and repeat counts of sites that went quiet, run by the main loop with the frame stats and by Shutdown
+        HYDRA_API void FlushSuppressed();
+
+        HYDRA_API bool IsBinary();
+        HYDRA_API void WriteBinary(Logger logger, LogLevel level, std::string_view format, const uint8_t* args, size_t size, uint8_t argCount);
+
+        enum class BinaryArgType : uint8_t { Int, UInt, Float, Double, Bool, Char, String };
+
+        template<typename T>
+        constexpr bool c_IsBinaryEncodable = std::is_arithmetic_v<std::remove_cvref_t<T>> || std::is_convertible_v<const std::remove_cvref_t<T>&, std::string_view>;
+
+        // packs a type tag followed by the raw value, strings are length prefixed
+        struct BinaryArgWriter
+        {
+            uint8_t* data;
+            size_t capacity;
+            size_t size = 0;
+            bool overflow = false;
+
+            void Put(const void* p, size_t n)
+            {
+                if (size + n > capacity) { overflow = true; return; }
+                std::memcpy(data + size, p, n);
+                size += n;
+            }
+
+            void Put(BinaryArgType type) { Put(&type, 1); }
+
+            template<typename T>
+            void Write(const T& value)
+            {
+                using U = std::remove_cvref_t<T>;
+
+                if constexpr (std::is_same_v<U, bool>)          { Put(BinaryArgType::Bool);   uint8_t v = value; Put(&v, 1); }
+                else if constexpr (std::is_same_v<U, char>)     { Put(BinaryArgType::Char);   Put(&value, 1); }
+                else if constexpr (std::is_same_v<U, float>)    { Put(BinaryArgType::Float);  Put(&value, 4); }
+                else if constexpr (std::is_floating_point_v<U>) { Put(BinaryArgType::Double); double v = double(value); Put(&v, 8); }
+                else if constexpr (std::is_signed_v<U>)         { Put(BinaryArgType::Int);    int64_t v = value; Put(&v, 8); }
+                else if constexpr (std::is_unsigned_v<U>)       { Put(BinaryArgType::UInt);   uint64_t v = value; Put(&v, 8); }
+                else
+                {
+                    std::string_view v = value;
+                    uint32_t length = uint32_t(v.size());
+                    Put(BinaryArgType::String);
+                    Put(&length, 4);
+                    Put(v.data(), v.size());
+                }
+            }
+        };
+
+        // formats into a stack buffer, only messages that do not fit fall back to a heap allocation
+        // in binary mode messages below Warn whose arguments are all encodable skip formatting entirely,
+        // Warn and above are formatted so they can be printed to the console as well
+        template<typename... Args>
+        void Print(Site* site, Logger logger, LogLevel level, std::format_string<Args...> fmt, Args&&... args)
+        {
+            if constexpr ((c_IsBinaryEncodable<Args> && ...))
+            {
+                if (level < LogLevel::Warn && IsBinary())
+                {
+                    uint8_t argBuffer[512];
+                    BinaryArgWriter writer{ argBuffer, sizeof(argBuffer) };
+                    (writer.Write(args), ...);
+
+                    if (!writer.overflow)
+                    {
+                        if (site && !Coalesce(*site, logger, level, fmt.get(), std::string_view((const char*)argBuffer, writer.size)))
+                            return;
+
+                        WriteBinary(logger, level, fmt.get(), argBuffer, writer.size, uint8_t(sizeof...(Args)));
+                        return;
+                    }
+                }
+            }
+
+            char buffer[512];
+            auto result = std::format_to_n(buffer, sizeof(buffer), fmt, std::forward<Args>(args)...);
+            if (size_t(result.size) <= sizeof(buffer))
+            {
+                std::string_view message(buffer, size_t(result.size));
+                if (!site || Coalesce(*site, logger, level, message))
+                    Write(logger, level, message);
+            }
+            else
+            {
+                std::string message = std::vformat(fmt.get(), std::make_format_args(args...));
+                if (!site || Coalesce(*site, logger, level, message))
+                    Write(logger, level, message);
+            }
+        }
     }
 
 #endif
@@ -77,6 +238,18 @@ namespace HE {
         return seed;
     }
 
+    // 64-bit FNV-1a, stable across runs and usable at compile time.
+    constexpr uint64_t HashString(std::string_view str)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (char c : str)
+        {
+            hash ^= uint8_t(c);
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
     // Aligns 'size' up to the next multiple of 'alignment' (power of two).
     template<typename T>
     constexpr T AlignUp(T size, T alignment)
@@ -88,6 +261,39 @@ namespace HE {
         return (size + alignment - 1) & ~(alignment - 1);
     }
 
+    // Lock-free single producer / single consumer ring, Capacity must be a power of two.
+    template<typename T, size_t Capacity>
+    struct SPSCQueue
+    {
+        static_assert((Capacity & (Capacity - 1)) == 0, "SPSCQueue capacity must be a power of two");
+
+        alignas(64) std::atomic<size_t> head = 0; // advanced by the consumer
+        alignas(64) std::atomic<size_t> tail = 0; // advanced by the producer
+        T items[Capacity];
+
+        bool Push(const T& item)
+        {
+            size_t t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) == Capacity)
+                return false;
+
+            items[t & (Capacity - 1)] = item;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool Pop(T& item)
+        {
+            size_t h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire))
+                return false;
+
+            item = items[h & (Capacity - 1)];
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+    };
+
     template<typename T>
     using Scope = std::unique_ptr<T>;
     template<typename T, typename ... Args>
@@ -279,6 +485,218 @@ namespace HE {
         int channels = 0;
     };
 
+    //////////////////////////////////////////////////////////////////////////
+    // Profiler
+    //////////////////////////////////////////////////////////////////////////
+
+    // Instrumentation profiler behind the HE_PROFILE_* scope macros, available in every build config.
+    // Each thread aggregates its own call tree without locks, readers only see relaxed atomic counters.
+    namespace Profiler {
+
+        struct ZoneDesc
+        {
+            const char* name;
+            const char* function;
+            const char* file;
+            uint32_t line;
+        };
+
+        struct ZoneStats
+        {
+            const ZoneDesc* zone = nullptr;
+            uint32_t parent = 0;        // index into ThreadStats::zones, the root is its own parent
+            uint32_t depth = 0;
+            uint64_t count = 0;
+            double totalMs = 0.0;
+            double selfMs = 0.0;        // total minus the time spent in child zones
+        };
+
+        struct ThreadStats
+        {
+            std::string name;
+            std::vector<ZoneStats> zones; // parents always precede their children, zones[0] is the thread root
+        };
+
+        HYDRA_API void SetEnabled(bool enabled);
+        HYDRA_API bool IsEnabled();
+        HYDRA_API void Reset();
+        HYDRA_API void SetThreadName(const char* name);
+        HYDRA_API void NewFrame();
+        HYDRA_API uint64_t GetFrameCount(); // frames since the last reset
+        HYDRA_API std::vector<ThreadStats> GetStats();
+        HYDRA_API std::string ToJson();
+        HYDRA_API bool DumpJson(const std::filesystem::path& filePath);
+
+        HYDRA_API bool BeginZone(const ZoneDesc* zone);
+        HYDRA_API void EndZone();
+
+        struct Scope
+        {
+            bool active;
+
+            Scope(const ZoneDesc* zone) : active(BeginZone(zone)) {}
+            ~Scope() { if (active) EndZone(); }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+        };
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Metrics
+    //////////////////////////////////////////////////////////////////////////
+
+    // Process wide counters, gauges and histograms exported in the Prometheus text format.
+    // Look a metric up once and keep the reference, updates are lock-free.
+    namespace Metrics {
+
+        struct Counter
+        {
+            std::atomic<uint64_t> value = 0;
+
+            void Increment(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+        };
+
+        struct Gauge
+        {
+            std::atomic<double> value = 0.0;
+
+            void Set(double v) { value.store(v, std::memory_order_relaxed); }
+            void Add(double v) { value.fetch_add(v, std::memory_order_relaxed); }
+        };
+
+        struct Histogram
+        {
+            std::vector<double> bounds;                       // ascending upper bounds, +Inf is implicit
+            std::unique_ptr<std::atomic<uint64_t>[]> buckets; // bounds.size() + 1, not cumulative
+            std::atomic<double> sum = 0.0;
+            std::atomic<uint64_t> count = 0;
+
+            void Observe(double v)
+            {
+                size_t i = std::lower_bound(bounds.begin(), bounds.end(), v) - bounds.begin();
+                buckets[i].fetch_add(1, std::memory_order_relaxed);
+                sum.fetch_add(v, std::memory_order_relaxed);
+                count.fetch_add(1, std::memory_order_relaxed);
+            }
+        };
+
+        struct ExporterDesc
+        {
+            enum class Format : uint8_t { Prometheus, OpenMetrics };
+
+            Format format = Format::Prometheus;
+            std::filesystem::path filePath;   // rewritten every interval, empty disables it
+            uint32_t fileHistory = 0;         // previous snapshots kept as <file>.1 ... <file>.N
+            std::filesystem::path socketPath; // Unix domain socket serving the current values to each connection, empty disables it
+            float interval = 10.0f;           // seconds between file exports
+        };
+
+        struct Exporter
+        {
+            ExporterDesc desc;
+            std::thread thread;
+            std::mutex mutex;
+            std::condition_variable cv;
+            bool running = false;
+
+            HYDRA_API ~Exporter();
+        };
+
+        HYDRA_API Counter& GetCounter(std::string_view name, std::string_view help = {});
+        HYDRA_API Gauge& GetGauge(std::string_view name, std::string_view help = {});
+        HYDRA_API Histogram& GetHistogram(std::string_view name, std::span<const double> bounds, std::string_view help = {});
+        HYDRA_API std::string Export(ExporterDesc::Format format = ExporterDesc::Format::Prometheus);
+        HYDRA_API void Start(Exporter& exporter, const ExporterDesc& desc);
+        HYDRA_API void Stop(Exporter& exporter);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // AsyncIO
+    //////////////////////////////////////////////////////////////////////////
+
+    namespace AsyncIO {
+
+        enum class Priority : uint8_t
+        {
+            High,
+            Normal,
+            Low,
+
+            Count
+        };
+
+        struct Request
+        {
+            std::filesystem::path path;
+            Buffer buffer;                        // read destination or write source, reads without one get a pooled buffer sized to the range
+            uint64_t offset = 0;
+            uint64_t size = 0;                    // 0 reads to the end of the file, or writes the whole buffer
+            Priority priority = Priority::Normal; // FIFO within a priority
+            bool truncate = false;                // writes only, empties the file first, requests run in no fixed order so truncate ahead of a chunked batch
+        };
+
+        struct Result
+        {
+            Buffer buffer;       // the request's buffer, or a pooled one to hand back with ReleaseBuffer
+            uint64_t bytes = 0;  // transferred
+            bool success = false;
+        };
+
+        struct ServiceDesc
+        {
+            uint32_t queueDepth = 64;                   // requests in flight at once
+            uint32_t threads = 4;                       // blocking workers, used where there is no kernel ring
+            uint64_t bufferPoolSize = 64 * 1024 * 1024; // bytes of released buffers kept for reuse
+        };
+
+        struct Service
+        {
+            struct Pending
+            {
+                Request request;
+                bool write = false;
+                bool pooled = false;
+                bool done = false;   // served while preparing, archive entries
+                bool issued = false; // taken by the ring, the reaper completes it
+                std::promise<Result> promise;
+            };
+
+            ServiceDesc desc;
+            intptr_t ring = -1;                        // io_uring on Linux, -1 runs the blocking workers
+            std::vector<std::thread> threads;
+            std::mutex mutex;
+            std::condition_variable cv;                // queued requests, free slots
+            std::condition_variable completionCV;      // requests in flight, ring mode only
+            std::array<std::deque<Pending>, (size_t)Priority::Count> queues;
+            std::vector<std::optional<Pending>> slots; // requests in flight by ring slot
+            std::vector<uint32_t> freeSlots;
+            int32_t inFlight = 0;                      // taken by the ring and not reaped, briefly negative when the reaper is ahead of the count
+            bool running = false;
+            bool submitting = false;
+            bool ringFailed = false;                   // the submitter serves the rest itself
+
+            std::mutex poolMutex;
+            std::array<std::vector<uint8_t*>, 64> pool;       // released buffers by power of two size class
+            std::unordered_map<uint8_t*, uint32_t> poolBlocks; // every block the pool allocated and still owns, to its size class
+            uint64_t pooledBytes = 0;
+
+            HYDRA_API ~Service();
+        };
+
+        HYDRA_API void Start(Service& service, const ServiceDesc& desc);
+        HYDRA_API void Stop(Service& service); // completes the queued requests first
+
+        // writes create a missing file and update the range in place, bytes outside it stay unless the request truncates
+        HYDRA_API std::future<Result> Read(const Request& request);
+        HYDRA_API std::future<Result> Write(const Request& request);
+        HYDRA_API std::vector<std::future<Result>> Read(std::span<const Request> requests);  // queued and submitted as one batch
+        HYDRA_API std::vector<std::future<Result>> Write(std::span<const Request> requests);
+
+        HYDRA_API Buffer AcquireBuffer(uint64_t size);
+        HYDRA_API void ReleaseBuffer(Buffer buffer); // recycles buffers from AcquireBuffer or a Result, anything else is left to its owner
+    }
+
     //////////////////////////////////////////////////////////////////////////
     // Event
     //////////////////////////////////////////////////////////////////////////
@@ -421,6 +839,7 @@ namespace HE {
     HYDRA_API constexpr std::string_view ToString(EventCategory code);
     HYDRA_API constexpr EventCategory FromStringToEventCategory(std::string_view code);
     HYDRA_API constexpr std::span<const CodeStrPair> EventCategoryMap();
+    HYDRA_API constexpr EventCategory GetEventCategory(EventType type);
 
 #define EVENT_CLASS_TYPE(type)  inline static EventType GetStaticType() { return EventType::type; }\
                                 inline virtual EventType GetEventType() const override { return GetStaticType(); }\
@@ -431,6 +850,7 @@ namespace HE {
     struct Event
     {
         bool handled = false;
+        uint64_t timestamp = 0; // Application::GetTimestamp() when the input was sampled
 
         virtual ~Event() = default;
         virtual EventType GetEventType() const = 0;
@@ -792,8 +1212,115 @@ namespace HE {
         std::string shortCut;
     };
 
+    // Dense index of a registered key binding, valid for the lifetime of the application.
+    struct ActionHandle
+    {
+        uint32_t index = ~0u;
+
+        constexpr bool IsValid() const { return index != ~0u; }
+        constexpr explicit operator bool() const { return IsValid(); }
+    };
+
+    // Action name paired with its hash, the hash of a string literal is computed at compile time.
+    struct ActionName
+    {
+        uint64_t hash;
+        std::string_view name;
+
+        template<size_t N>
+        consteval ActionName(const char(&str)[N]) : hash(HashString(std::string_view(str, N - 1))), name(str, N - 1) {}
+        ActionName(std::string_view str) : hash(HashString(str)), name(str) {}
+        ActionName(const std::string& str) : hash(HashString(str)), name(str) {}
+    };
+
+    // Fixed size record of one input event, written by the input recorder and fed back by replay.
+    struct InputRecord
+    {
+        uint64_t frameIndex;    // relative to the frame the recording started
+        uint8_t type;           // EventType
+        uint8_t flags;          // repeat, connected, entered
+        uint16_t code;          // key, mouse button or joystick
+        uint32_t value;         // gamepad button, axis or code point
+        float x, y;
+    };
+
+    struct InputSample
+    {
+        uint64_t timestamp;
+        InputRecord record;
+    };
+
+    // Immutable view of the input state, captured once per frame after Window::UpdateEvent.
+    // Pressed/Released bits are edges that happened during the captured frame.
+    struct InputSnapshot
+    {
+        std::bitset<Key::Count> keyDown;
+        std::bitset<Key::Count> keyPressed;
+        std::bitset<Key::Count> keyReleased;
+
+        std::bitset<MouseKey::Count> mouseButtonDown;
+        std::bitset<MouseKey::Count> mouseButtonPressed;
+        std::bitset<MouseKey::Count> mouseButtonReleased;
+
+        std::bitset<Joystick::Count> gamepadConnected;
+        std::bitset<GamepadButton::Count> gamepadButtonDown[Joystick::Count];
+        std::bitset<GamepadButton::Count> gamepadButtonPressed[Joystick::Count];
+        std::bitset<GamepadButton::Count> gamepadButtonReleased[Joystick::Count];
+        std::pair<float, float> gamepadAxes[Joystick::Count][GamepadAxis::Count] = {};
+
+        float mouseX = 0.0f, mouseY = 0.0f;
+        float mouseDeltaX = 0.0f, mouseDeltaY = 0.0f;
+        float scrollX = 0.0f, scrollY = 0.0f;
+
+        uint64_t latestInputTimestamp = 0; // newest input event of the captured frame
+        uint64_t frameIndex = 0;
+
+        bool IsKeyDown(KeyCode key) const { return key < Key::Count && keyDown.test(key); }
+        bool IsKeyUp(KeyCode key) const { return key < Key::Count && !keyDown.test(key); }
+        bool IsKeyPressed(KeyCode key) const { return key < Key::Count && keyPressed.test(key); }
+        bool IsKeyReleased(KeyCode key) const { return key < Key::Count && keyReleased.test(key); }
+
+        bool IsMouseButtonDown(MouseCode button) const { return button < MouseKey::Count && mouseButtonDown.test(button); }
+        bool IsMouseButtonUp(MouseCode button) const { return button < MouseKey::Count && !mouseButtonDown.test(button); }
+        bool IsMouseButtonPressed(MouseCode button) const { return button < MouseKey::Count && mouseButtonPressed.test(button); }
+        bool IsMouseButtonReleased(MouseCode button) const { return button < MouseKey::Count && mouseButtonReleased.test(button); }
+        std::pair<float, float> GetMousePosition() const { return { mouseX, mouseY }; }
+
+        bool IsGamepadButtonDown(JoystickCode id, GamepadCode code) const { return id < Joystick::Count && code < GamepadButton::Count && gamepadConnected.test(id) && gamepadButtonDown[id].test(code); }
+        bool IsGamepadButtonUp(JoystickCode id, GamepadCode code) const { return id < Joystick::Count && code < GamepadButton::Count && gamepadConnected.test(id) && !gamepadButtonDown[id].test(code); }
+        bool IsGamepadButtonPressed(JoystickCode id, GamepadCode code) const { return id < Joystick::Count && code < GamepadButton::Count && gamepadButtonPressed[id].test(code); }
+        bool IsGamepadButtonReleased(JoystickCode id, GamepadCode code) const { return id < Joystick::Count && code < GamepadButton::Count && gamepadButtonReleased[id].test(code); }
+        std::pair<float, float> GetGamepadLeftAxis(JoystickCode id) const { return id < Joystick::Count ? gamepadAxes[id][GamepadAxis::Left] : std::pair<float, float>(0.0f, 0.0f); }
+        std::pair<float, float> GetGamepadRightAxis(JoystickCode id) const { return id < Joystick::Count ? gamepadAxes[id][GamepadAxis::Right] : std::pair<float, float>(0.0f, 0.0f); }
+    };
+
+    // Pins the snapshot it points to, the slot is not reused for a later frame while any copy of the handle is alive.
+    // Copy it into jobs that may outlive the frame, every query through one handle sees the same frame.
+    class InputSnapshotHandle
+    {
+    public:
+        InputSnapshotHandle() = default;
+        InputSnapshotHandle(const InputSnapshot* snapshot, std::atomic<uint32_t>* pins) : m_Snapshot(snapshot), m_Pins(pins) {}
+        InputSnapshotHandle(const InputSnapshotHandle& other) : m_Snapshot(other.m_Snapshot), m_Pins(other.m_Pins) { if (m_Pins) m_Pins->fetch_add(1, std::memory_order_relaxed); }
+        InputSnapshotHandle(InputSnapshotHandle&& other) noexcept : m_Snapshot(std::exchange(other.m_Snapshot, nullptr)), m_Pins(std::exchange(other.m_Pins, nullptr)) {}
+        InputSnapshotHandle& operator=(InputSnapshotHandle other) noexcept { std::swap(m_Snapshot, other.m_Snapshot); std::swap(m_Pins, other.m_Pins); return *this; }
+        ~InputSnapshotHandle() { if (m_Pins) m_Pins->fetch_sub(1, std::memory_order_release); }
+
+        const InputSnapshot& operator*() const { return *m_Snapshot; }
+        const InputSnapshot* operator->() const { return m_Snapshot; }
+        explicit operator bool() const { return m_Snapshot; }
+
+    private:
+        const InputSnapshot* m_Snapshot = nullptr;
+        std::atomic<uint32_t>* m_Pins = nullptr;
+    };
+
     namespace Input {
 
+        // Pins the snapshot of the last completed frame, safe to call from worker jobs.
+        // The free queries below pin a snapshot per call, take one handle to read several values from the same frame.
+        HYDRA_API InputSnapshotHandle GetSnapshot();
+
         HYDRA_API bool IsKeyPressed(KeyCode key);
         HYDRA_API bool IsKeyReleased(KeyCode key);
         HYDRA_API bool IsKeyDown(KeyCode key);
@@ -818,14 +1345,26 @@ namespace HE {
         HYDRA_API void SetCursorMode(Cursor::Mode mode);
         HYDRA_API Cursor::Mode GetCursorMode();
 
-        HYDRA_API bool Triggered(const std::string_view& name);
+        // Actions are evaluated once per frame, Triggered is a bit test.
+        HYDRA_API bool Triggered(ActionHandle action);
+        HYDRA_API bool Triggered(ActionName name);
         HYDRA_API void BlockEventsUntilNextFrame();
         HYDRA_API bool IsEventsBlocked();
-        HYDRA_API bool RegisterKeyBinding(const KeyBindingDesc& name);
-        HYDRA_API std::map<uint64_t, KeyBindingDesc>& GetKeyBindings();
-        HYDRA_API std::string_view GetShortCut(std::string_view name);
+        HYDRA_API ActionHandle RegisterKeyBinding(const KeyBindingDesc& desc);
+        HYDRA_API ActionHandle GetActionHandle(ActionName name);
+        HYDRA_API std::vector<KeyBindingDesc>& GetKeyBindings();
+        HYDRA_API std::string_view GetShortCut(ActionName name);
         HYDRA_API void SerializeKeyBindings(const std::filesystem::path& filePath);
         HYDRA_API bool DeserializeKeyBindings(const std::filesystem::path& filePath);
+
+        // Keyboard, mouse and gamepad events are recorded with their frame index,
+        // while replaying live input events are ignored and the recorded ones are emitted instead.
+        HYDRA_API bool StartRecording(const std::filesystem::path& filePath);
+        HYDRA_API void StopRecording();
+        HYDRA_API bool IsRecording();
+        HYDRA_API bool StartReplay(const std::filesystem::path& filePath);
+        HYDRA_API void StopReplay();
+        HYDRA_API bool IsReplaying();
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -868,6 +1407,8 @@ namespace HE {
         bool scaleToMonitor = true;
         bool startVisible = true;
         bool setCallbacks = true;
+        bool inputThread = false;           // sample gamepads on a dedicated thread through OS::ReadGamepads instead of once per frame through GLFW
+        uint32_t inputSampleRate = 1000;    // Hz
 
         SwapChainDesc swapChainDesc;
     };
@@ -875,34 +1416,42 @@ namespace HE {
     // internal
     struct InputState
     {
-        InputState()
-        {
-            keyDownPrevFrame.set();
-            keyUpPrevFrame.set();
-            mouseButtonDownPrevFrame.set();
-            mouseButtonUpPrevFrame.set();
-
-            for (auto& gamepad : gamepadButtonDownPrevFrame) gamepad.set();
-            for (auto& gamepad : gamepadButtonUpPrevFrame) gamepad.set();
-        }
+        static constexpr uint32_t c_SnapshotCount = 4;
 
         Cursor cursor;
 
-        std::bitset<Key::Count> keyDownPrevFrame;
-        std::bitset<Key::Count> keyUpPrevFrame;
+        InputSnapshot live;                             // accumulated from events on the main thread
+        InputSnapshot snapshots[c_SnapshotCount];
+        std::atomic<uint32_t> snapshotPins[c_SnapshotCount] = {}; // live InputSnapshotHandles per slot, pinned slots are skipped by the capture
+        std::atomic<uint32_t> currentSnapshot = 0;
 
-        std::bitset<MouseKey::Count> mouseButtonDownPrevFrame;
-        std::bitset<MouseKey::Count> mouseButtonUpPrevFrame;
+        std::atomic<uint32_t> activeGamepads = 0; // one bit per connected joystick, GLFW ids from the joystick callback or input thread slots
+        std::bitset<GamepadButton::Count> gamepadButtonPrevFrame[Joystick::Count];
 
-        std::bitset<GamepadButton::Count> gamepadButtonDownPrevFrame[Joystick::Count];
-        std::bitset<GamepadButton::Count> gamepadButtonUpPrevFrame[Joystick::Count];
+        std::vector<InputRecord> records;
+        std::filesystem::path recordFilePath;
+        uint64_t recordStartFrame = 0;
+        bool recording = false;
 
-        std::bitset<GamepadButton::Count> gamepadEventButtonDownPrevFrame[Joystick::Count];
-        std::bitset<GamepadButton::Count> gamepadEventButtonUpPrevFrame[Joystick::Count];
+        SPSCQueue<InputSample, 1024> samples; // filled by the input thread, drained in Window::UpdateEvent
+        std::thread inputThread;
+        std::atomic<bool> inputThreadRunning = false;
+        std::atomic<uint32_t> droppedSamples = 0;
+
+        std::vector<InputRecord> replayRecords;
+        size_t replayCursor = 0;
+        uint64_t replayStartFrame = 0;
+        bool replaying = false;
 
         float deadZoon = 0.1f;
     };
 
+    struct PresentTiming
+    {
+        uint64_t presentId;
+        uint64_t presentTime; // Application::GetTimestamp() domain
+    };
+
     struct SwapChain
     {
         SwapChainDesc desc;
@@ -910,6 +1459,7 @@ namespace HE {
         std::vector<nvrhi::FramebufferHandle> swapChainFramebuffers;
         nvrhi::DeviceHandle nvrhiDevice;
         bool isVSync = false;
+        uint64_t presentCount = 0; // incremented before each Present, the current value is the id of that present
 
         virtual ~SwapChain() = default;
 
@@ -927,6 +1477,9 @@ namespace HE {
         virtual void ResizeSwapChain(uint32_t width, uint32_t height) = 0;
         virtual bool Present() = 0;
         virtual bool BeginFrame() = 0;
+
+        // Display times of completed presents, returns false when the backend can't report them.
+        virtual bool GetPastPresentTimings(std::vector<PresentTiming>& timings) { return false; }
     };
 
     using WindowEventCallback = std::function<void(Event&)>;
@@ -1115,6 +1668,73 @@ namespace HE {
         HYDRA_API nvrhi::ShaderLibraryHandle CreateShaderLibrary(nvrhi::IDevice* device, StaticShader staticShader, const std::vector<ShaderMacro>* pDefines);
     }
 
+    // GPU durations from nvrhi timer queries. Queries are pooled per frame slot and read back without
+    // waiting when their slot comes around again, maxFramesInFlight + 1 frames later.
+    // The automatic per-layer scopes are small command lists submitted between the layers' OnUpdate calls, so a
+    // layer is charged for what reaches the queue during its OnUpdate, work it records there but submits later lands
+    // in whichever scope is open at submission. Scope on the layer's own command list measures the work exactly.
+    namespace GPUProfiler {
+
+        struct ScopeResult
+        {
+            const char* name;   // interned, valid for the lifetime of the application
+            float ms = 0.0f;    // summed over every scope with this name in the frame
+            uint32_t count = 0;
+        };
+
+        // owned by ApplicationContext so the queries are released before the device
+        struct Context
+        {
+            struct Query
+            {
+                nvrhi::TimerQueryHandle handle;
+                const char* name = nullptr;
+                bool ended = false;
+            };
+
+            struct Frame
+            {
+                uint64_t frameIndex = 0;
+                std::vector<Query> queries;
+                uint32_t used = 0;
+            };
+
+            std::mutex mutex;
+            std::vector<Frame> frames;
+            Frame* current = nullptr;
+            std::unordered_set<std::string> names;
+            std::vector<ScopeResult> results;
+            uint64_t resultsFrameIndex = 0;
+            std::vector<nvrhi::CommandListHandle> bracketLists; // small command lists carrying the per-layer and frame brackets
+            uint32_t bracketCursor = 0;
+            uint32_t frameScope = ~0u;
+            uint32_t layerScope = ~0u;
+            bool enabled = false;
+        };
+
+        HYDRA_API void SetEnabled(bool enabled);
+        HYDRA_API bool IsEnabled();
+
+        // returns ~0u when profiling is off, scopes must begin and end within the same frame
+        HYDRA_API uint32_t BeginScope(nvrhi::ICommandList* commandList, const char* name);
+        HYDRA_API void EndScope(nvrhi::ICommandList* commandList, uint32_t scope);
+
+        HYDRA_API const std::vector<ScopeResult>& GetResults(); // latest resolved frame
+        HYDRA_API uint64_t GetResultsFrameIndex();
+
+        struct Scope
+        {
+            nvrhi::ICommandList* commandList;
+            uint32_t scope;
+
+            Scope(nvrhi::ICommandList* commandList, const char* name) : commandList(commandList), scope(BeginScope(commandList, name)) {}
+            ~Scope() { EndScope(commandList, scope); }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+        };
+    }
+
 
     //////////////////////////////////////////////////////////////////////////
     // Modules
@@ -1123,6 +1743,13 @@ namespace HE {
     // Use these callbacks in your module:
     // EXPORT void OnModuleLoaded() {}
     // EXPORT void OnModuleShutdown() {}
+    //
+    // Optional, hands state from the running instance to the new one when the module is hot reloaded:
+    // EXPORT void OnModuleSerialize(std::vector<uint8_t>& state) {}
+    // EXPORT void OnModuleDeserialize(const std::vector<uint8_t>& state) {}
+    //
+    // Optional, one table of function pointers resolved once after OnModuleLoaded, see ModuleInterface:
+    // EXPORT const HE::Modules::ModuleInterface* GetModuleInterface() { return &s_MyAPI.header; }
 
     namespace Modules {
 
@@ -1134,13 +1761,13 @@ namespace HE {
             SharedLib(const SharedLib&) = delete;
             SharedLib& operator=(const SharedLib&) = delete;
 
-            SharedLib(SharedLib&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
-            SharedLib& operator=(SharedLib&& other) noexcept { if (this != &other) std::swap(handle, other.handle); return *this; }
+            SharedLib(SharedLib&& other) noexcept : handle(other.handle), symbols(std::move(other.symbols)) { other.handle = nullptr; }
+            SharedLib& operator=(SharedLib&& other) noexcept { if (this != &other) { std::swap(handle, other.handle); std::swap(symbols, other.symbols); } return *this; }
 
-            explicit SharedLib(const std::filesystem::path& filePath, bool decorations = false)
+            explicit SharedLib(const std::filesystem::path& filePath, bool decorations = false, bool lazyBinding = false)
             {
                 std::string finalPath = decorations ? filePath.string() + c_SharedLibExtension : filePath.string();
-                handle = Open(finalPath.c_str());
+                handle = Open(finalPath.c_str(), lazyBinding);
                 if (!handle)
                 {
                     HE_CORE_ERROR("SharedLib : Could not load library {} : {}", finalPath, GetError());
@@ -1149,14 +1776,41 @@ namespace HE {
 
             ~SharedLib() { if (handle) Close(handle); }
 
+            void Unload() { std::unique_lock lock(symbolsMutex); if (handle) Close(handle); handle = nullptr; symbols.clear(); }
             bool IsLoaded() { return handle != nullptr; }
-            bool HasSymbol(const std::string_view& symbol) const noexcept { return !handle || !symbol.empty() ? false : GetSymbolAddress(handle, symbol.data()) != nullptr; }
+            bool HasSymbol(const std::string_view& symbol) const noexcept { return handle && !symbol.empty() && FindSymbol(symbol) != nullptr; }
             template<typename T> T& GetVariable(const std::string_view& symbolName) const { return *reinterpret_cast<T*>(GetSymbol(symbolName)); }
+
+            // cached lookup, the platform is asked once per found name, misses are asked again.
+            // The handle is only used under symbolsMutex so Unload cannot close it in the middle of a lookup
+            void* FindSymbol(const std::string_view& symbolName) const noexcept
+            {
+                {
+                    std::shared_lock lock(symbolsMutex);
+                    if (!handle)
+                        return nullptr;
+
+                    auto it = symbols.find(symbolName);
+                    if (it != symbols.end())
+                        return it->second;
+                }
+
+                std::unique_lock lock(symbolsMutex);
+                if (!handle)
+                    return nullptr;
+
+                void* symbol = GetSymbolAddress(handle, std::string(symbolName).c_str());
+                if (symbol)
+                    symbols.emplace(symbolName, symbol);
+
+                return symbol;
+            }
+
             void* GetSymbol(const std::string_view& symbolName) const
             {
                 HE_ASSERT(handle, "Modules::SharedLib::GetSymbol failed : The dynamic library handle is null");
 
-                auto symbol = GetSymbolAddress(handle, symbolName.data());
+                auto symbol = FindSymbol(symbolName);
 
                 if (!symbol)
                 {
@@ -1180,36 +1834,98 @@ namespace HE {
             }
 
         private:
-            static void* Open(const char* path) noexcept;
+            static void* Open(const char* path, bool lazyBinding) noexcept; // lazyBinding resolves functions on first call where the platform supports it
             static void* GetSymbolAddress(void* handle, const char* name) noexcept;
             static void Close(void* handle) noexcept;
             static std::string GetError() noexcept;
+
+            struct SymbolHash
+            {
+                using is_transparent = void;
+                size_t operator()(std::string_view name) const noexcept { return std::hash<std::string_view>{}(name); }
+            };
+
+            mutable std::shared_mutex symbolsMutex;
+            mutable std::unordered_map<std::string, void*, SymbolHash, std::equal_to<>> symbols; // name -> address, looked up without building a string
+        };
+
+        // Header of a module's exported function table. A table is a struct that starts with this header and
+        // declares its identity, callers get it through ModuleData::GetInterface<T>() with no name lookups:
+        //
+        // struct PhysicsAPI
+        // {
+        //     static constexpr uint64_t c_InterfaceID = HE::HashString("PhysicsAPI");
+        //     static constexpr uint32_t c_InterfaceVersion = 2;
+        //
+        //     HE::Modules::ModuleInterface header = { c_InterfaceID, c_InterfaceVersion, sizeof(PhysicsAPI) };
+        //     void (*Step)(float dt);
+        // };
+        struct ModuleInterface
+        {
+            uint64_t id;
+            uint32_t version;
+            uint32_t size;   // sizeof the whole table, a table built against an older header is smaller
         };
 
         using ModuleHandle = uint64_t;
 
+        struct ModuleLoadStats
+        {
+            std::string name;
+            std::string plugin;     // empty when loaded directly through LoadModule
+            uint64_t fileSize = 0;
+            float waitTime = 0.0f;  // ms, spent waiting for the plugin's dependencies to load
+            float openTime = 0.0f;  // ms, opening the library, includes its static initializers
+            float initTime = 0.0f;  // ms, OnModuleLoaded
+        };
+
         struct ModuleData
         {
             std::string name;
+            std::filesystem::path filePath;   // the module as built
+            std::filesystem::path shadowPath; // the copy actually opened, empty when the module is opened in place
             SharedLib lib;
 
-            uint32_t loadOrder;
+            uint32_t loadOrder = 0; // assigned when OnModuleLoaded runs, libraries may be opened concurrently
+            uint64_t lastUsed = 0;  // timestamp of the latest Plugins::RequestService, drives idle unloading
+            const ModuleInterface* moduleInterface = nullptr; // from GetModuleInterface, resolved once after OnModuleLoaded
+            ModuleLoadStats loadStats;
             inline static uint32_t currentLoadOrder = 0;
 
             ModuleData() = delete;
-            ModuleData(const std::filesystem::path& filePath) : name(filePath.stem().string()), lib(filePath), loadOrder(currentLoadOrder++) {}
+            ModuleData(const std::filesystem::path& filePath, const std::filesystem::path& shadowPath = {}, bool lazyBinding = false)
+                : name(filePath.stem().string())
+                , filePath(filePath)
+                , shadowPath(shadowPath)
+                , lib(shadowPath.empty() ? filePath : shadowPath, false, lazyBinding)
+            {
+            }
+
+            template<typename T>
+            const T* GetInterface() const
+            {
+                const ModuleInterface* i = moduleInterface;
+                if (!i || i->id != T::c_InterfaceID || i->version != T::c_InterfaceVersion || i->size < sizeof(T))
+                    return nullptr;
+
+                return reinterpret_cast<const T*>(i);
+            }
         };
 
         struct ModulesContext
         {
             std::unordered_map<ModuleHandle, Ref<ModuleData>> modules;
+            bool lazyBinding = false;
+            float slowLoadWarningTime = 0.0f;                            // ms, warn when open + OnModuleLoaded take longer, 0 disables
+            std::unordered_map<ModuleHandle, ModuleLoadStats> loadStats; // latest successful load of each module, a reload replaces it
 
             HYDRA_API ~ModulesContext();
         };
 
-        HYDRA_API bool LoadModule(const std::filesystem::path& filePath);
+        HYDRA_API bool LoadModule(const std::filesystem::path& filePath, bool shadowCopy = false); // a shadow copy leaves the built file free to be overwritten
         HYDRA_API bool IsModuleLoaded(ModuleHandle handle);
         HYDRA_API bool UnloadModule(ModuleHandle handle);
+        HYDRA_API bool ReloadModule(ModuleHandle handle); // a shadow copied module keeps running when the new binary fails to load, one opened in place is closed first
         HYDRA_API Ref<ModuleData> GetModuleData(ModuleHandle handle);
     }
 
@@ -1223,6 +1939,12 @@ namespace HE {
 
         using PluginHandle = uint64_t;
 
+        struct ServiceDesc
+        {
+            std::string name;
+            std::string module;                 // the module providing it
+        };
+
         struct PluginDesc
         {
             std::string name;
@@ -1230,8 +1952,25 @@ namespace HE {
             std::string URL;
             bool reloadable = false;
             bool enabledByDefault = false;
+            bool lazy = false;                  // modules are opened on the first RequestService instead of when the plugin loads
             std::vector<std::string> modules;	// the base name of module without extension
             std::vector<std::string> plugins;	// Plugins used by this plugin 
+            std::vector<ServiceDesc> services;  // "services": { "name": "module" }
+        };
+
+        struct PluginLoadStats
+        {
+            std::string name;
+            uint32_t level = 0;         // dependency depth it was loaded at, 0 needs nothing that was not already loaded
+            bool fromRegistry = false;  // the descriptor came from the registry cache and was not parsed
+            float parseTime = 0.0f;     // ms
+            float loadTime = 0.0f;      // ms, open and OnModuleLoaded of its modules
+        };
+
+        struct LoadReport
+        {
+            std::vector<Modules::ModuleLoadStats> modules; // slowest first
+            std::vector<PluginLoadStats> plugins;          // slowest first
         };
 
         struct Plugin
@@ -1239,6 +1978,7 @@ namespace HE {
             PluginDesc desc;
             std::filesystem::path descFilePath;
             bool enabled = false;
+            PluginLoadStats loadStats;
 
             Plugin(PluginDesc pDesc) : desc(pDesc) {}
 
@@ -1251,14 +1991,43 @@ namespace HE {
         struct PluginContext
         {
             std::unordered_map<PluginHandle, Ref<Plugin>> plugins;
+            std::unordered_map<uint64_t, PluginHandle> descFiles; // Hash(descFilePath) -> plugin, so a descriptor is parsed once
+
+            // hot reload, modules of reloadable plugins are opened from shadow copies and reloaded when their binaries change
+            bool hotReload = false;
+            uint32_t reloadDebounceMs = 300;                       // quiet time after the last change before reloading
+            intptr_t watcher = -1;
+            std::thread watcherThread;
+            std::atomic<bool> watching = false;
+            std::unordered_set<uint64_t> watchedDirectories;
+            std::mutex changedMutex;
+            std::vector<std::filesystem::path> changedBinaries;    // handed from the watcher thread to the main loop
+            std::atomic<bool> reloadPending = false;
+            std::unordered_set<uint64_t> cleanedModuleDirectories; // Hash(directory), stale shadow copies removed once per session
+
+            std::unordered_map<uint64_t, std::pair<PluginHandle, std::string>> services; // HashString(service) -> plugin and module
+            float idleUnloadTime = 0.0f;                                                  // seconds, 0 keeps lazy modules loaded
+            uint64_t lastIdleCheck = 0;
+
+            std::unordered_map<PluginHandle, PluginLoadStats> loadStats; // latest load of each plugin
+            std::filesystem::path loadReportFile;                        // rewritten after each batch of plugin loads when set
+            bool parallelOpen = false;                                   // open the modules of a dependency level on workers
+
+            HYDRA_API ~PluginContext();
         };
 
-        HYDRA_API void LoadPluginsInDirectory(const std::filesystem::path& directory);
+        HYDRA_API void LoadPluginsInDirectory(const std::filesystem::path& directory); // parsed descriptors are cached in <directory>.hregistry next to it
         HYDRA_API void LoadPlugin(const std::filesystem::path& descriptor);
         HYDRA_API void LoadPlugin(PluginHandle handle);
         HYDRA_API bool UnloadPlugin(PluginHandle handle);
         HYDRA_API void ReloadPlugin(PluginHandle handle);
         HYDRA_API const Ref<Plugin> GetPlugin(PluginHandle handle);
+        // Opens the providing module on first request, request again on each use so it counts as used.
+        // Keep the returned Ref while using functions or interfaces of the module, idle unloading skips held modules.
+        HYDRA_API Ref<Modules::ModuleData> RequestService(std::string_view service);
+        HYDRA_API LoadReport GetLoadReport();
+        HYDRA_API std::string LoadReportToJson();
+        HYDRA_API bool DumpLoadReport(const std::filesystem::path& filePath);
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -1269,6 +2038,8 @@ namespace HE {
     {
         Timestep ts;
         nvrhi::IFramebuffer* fb;
+        uint64_t inputTimestamp = 0; // newest input consumed by this frame, 0 when there was none
+        InputSnapshotHandle input;   // the frame's input, copy it into jobs instead of calling Input::* from them
     };
 
     class Layer
@@ -1282,6 +2053,40 @@ namespace HE {
         inline virtual void OnBegin(const FrameInfo& info) {}
         inline virtual void OnUpdate(const FrameInfo& info) {}
         inline virtual void OnEnd(const FrameInfo& info) {}
+        HYDRA_API virtual const char* GetName() const; // the readable type name by default
+    };
+
+    // Flat per-EventType handler table, ordered like the layer stack (overlays first).
+    // A layer that never subscribes keeps receiving every event through Layer::OnEvent,
+    // the first explicit subscription of a layer replaces that catch-all entry.
+    struct EventBus
+    {
+        using Handler = std::function<bool(Event&)>;
+
+        struct Subscription
+        {
+            Layer* layer = nullptr;
+            Handler handler;
+            bool catchAll = false;
+        };
+
+        std::array<std::vector<Subscription>, size_t(EventType::None)> handlers;
+        std::vector<std::pair<EventType, Subscription>> pending; // merged on the next dispatch once their layer is on the stack, handlers may subscribe while dispatching
+        uint32_t dispatchDepth = 0;
+        bool dirty = false;
+
+        HYDRA_API void Subscribe(Layer* layer, EventType type, const Handler& handler);
+        HYDRA_API void Subscribe(Layer* layer, EventCategory category, const Handler& handler);
+        HYDRA_API void SubscribeCatchAll(Layer* layer);
+        HYDRA_API void Unsubscribe(Layer* layer);
+        HYDRA_API void Sort(const std::vector<Layer*>& layers);
+        HYDRA_API void Dispatch(Event& event);
+
+        template<typename T, typename F>
+        void Subscribe(Layer* layer, F&& func)
+        {
+            Subscribe(layer, T::GetStaticType(), [func = std::forward<F>(func)](Event& e) { return func(static_cast<T&>(e)); });
+        }
     };
 
     class LayerStack
@@ -1296,6 +2101,9 @@ namespace HE {
         void PopLayer(Layer* layer);
         void PopOverlay(Layer* overlay);
 
+        void Dispatch(Event& event);
+        EventBus& GetEventBus() { return m_EventBus; }
+
         std::vector<Layer*>::iterator begin() { return m_Layers.begin(); }
         std::vector<Layer*>::iterator end() { return m_Layers.end(); }
         std::vector<Layer*>::reverse_iterator rbegin() { return m_Layers.rbegin(); }
@@ -1308,6 +2116,7 @@ namespace HE {
     private:
         std::vector<Layer*> m_Layers;
         uint32_t m_LayerInsertIndex = 0;
+        EventBus m_EventBus;
     };
 
     //////////////////////////////////////////////////////////////////////////
@@ -1331,12 +2140,46 @@ namespace HE {
         bool createDefaultDevice = true;
         uint32_t workersNumber = std::thread::hardware_concurrency() - 1;
         std::filesystem::path logFile = "HE";
+        LogDesc logDesc;
+        std::filesystem::path inputRecordFile;  // record input from the first frame
+        std::filesystem::path inputReplayFile;  // replay input from the first frame, takes precedence over recording
+        bool exitAfterReplay = false;
+        float fixedTimestep = 0.0f;             // seconds, passed to layers instead of the measured frame time, stats keep measuring, 0 disables
+        bool enableProfiler = false;            // engine profiler from startup, Profiler::SetEnabled toggles it at runtime
+        bool enableGPUProfiler = false;         // per-layer GPU timings from startup, GPUProfiler::SetEnabled toggles it at runtime
+        Metrics::ExporterDesc metricsDesc;      // the exporter runs when a file or socket path is set
+#ifdef HE_DEBUG
+        bool hotReloadPlugins = true;           // reload modules of reloadable plugins when their binaries change, writes shadow copies next to them
+#else
+        bool hotReloadPlugins = false;          // off outside Debug so installed builds never write next to their binaries
+#endif
+        bool lazyModuleBinding = false;         // resolve module functions on first call (RTLD_LAZY), no effect on Windows
+        bool parallelModuleOpen = false;        // open independent modules on workers, every module's static initializers and DllMain must then be thread safe
+        float moduleIdleUnloadTime = 0.0f;      // seconds, modules of lazy plugins not requested for this long are unloaded, 0 keeps them
+        std::filesystem::path loadReportFile;   // module and plugin load times as JSON, written after plugins load
+        float slowModuleWarningTime = 0.0f;     // ms, warn about modules whose open + OnModuleLoaded take longer, 0 disables
+        AsyncIO::ServiceDesc ioDesc;
+    };
+
+    struct LatencyStats
+    {
+        float min = 0.0f, avg = 0.0f, p50 = 0.0f, p95 = 0.0f, p99 = 0.0f, max = 0.0f; // ms
+        uint32_t sampleCount = 0;
     };
 
     struct Stats
     {
         float CPUMainTime;
         uint32_t FPS;
+        LatencyStats inputLatency; // input capture to present of the frame that consumed it
+        float GPUFrameTime = 0.0f; // ms, layer work of the latest resolved frame, 0 unless the GPU profiler is enabled
+    };
+
+    struct FrameTiming
+    {
+        uint64_t frameIndex = 0;
+        float cpuMs = 0.0f;
+        float gpuMs = 0.0f; // filled in once the frame's GPU queries resolve
     };
 
     struct ApplicationContext
@@ -1349,10 +2192,20 @@ namespace HE {
         Modules::ModulesContext modulesContext;
         Plugins::PluginContext pluginContext;
 
-        std::map<uint64_t, KeyBindingDesc> keyBindings;
+        std::vector<KeyBindingDesc> keyBindings;                    // indexed by ActionHandle
+        std::unordered_map<uint64_t, ActionHandle> keyBindingLookup; // HashString(name) -> handle
+        std::vector<uint64_t> triggeredActions;                     // one bit per action, evaluated at the start of each frame
         bool blockingEventsUntilNextFrame = false;
 
         Stats appStats;
+        uint64_t frameIndex = 0;
+        std::vector<FrameTiming> frameHistory = std::vector<FrameTiming>(256); // ring indexed by frameIndex
+        GPUProfiler::Context gpuProfiler;
+
+        struct PendingLatency { uint64_t presentId; uint64_t inputTimestamp; uint64_t cpuPresentTime; };
+        std::vector<PendingLatency> pendingLatency;
+        std::vector<float> latencySamples;  // ms, ring of the most recent samples
+        size_t latencySampleCursor = 0;
         bool running = true;
         float lastFrameTime = 0.0f;
         float averageFrameTime = 0.0;
@@ -1365,6 +2218,9 @@ namespace HE {
         std::queue<std::function<void()>> mainThreadQueue;
         std::mutex mainThreadQueueMutex;
 
+        Metrics::Exporter metricsExporter;
+        AsyncIO::Service ioService;
+
         inline static bool s_ApplicationRunning = true;
         inline static ApplicationContext* s_Instance = nullptr;
 
@@ -1384,12 +2240,21 @@ namespace HE {
         HYDRA_API void PopLayer(Layer* layer);
         HYDRA_API void PopOverlay(Layer* overlay);
         HYDRA_API float GetTime();
+        HYDRA_API uint64_t GetTimestamp(); // monotonic, nanoseconds
         HYDRA_API const Stats& GetStats();
+        HYDRA_API const std::vector<FrameTiming>& GetFrameHistory(); // ring, slot frameIndex % size
         HYDRA_API const ApplicationDesc& GetApplicationDesc();
         HYDRA_API float GetAverageFrameTimeSeconds();
         HYDRA_API float GetLastFrameTimestamp();
         HYDRA_API void SetFrameTimeUpdateInterval(float seconds);
         HYDRA_API Window& GetWindow();
+        HYDRA_API void SubscribeEvent(Layer* layer, EventType type, const EventBus::Handler& handler);
+        HYDRA_API void SubscribeEvent(Layer* layer, EventCategory category, const EventBus::Handler& handler);
+        HYDRA_API void UnsubscribeEvents(Layer* layer);
+
+        // Usage in Layer::OnAttach : Application::SubscribeEvent<KeyPressedEvent>(this, [this](KeyPressedEvent& e) { return OnKeyPressed(e); });
+        template<typename T, typename F>
+        void SubscribeEvent(Layer* layer, F&& func) { GetAppContext().layerStack.GetEventBus().Subscribe<T>(layer, std::forward<F>(func)); }
     }
 
     ApplicationContext* CreateApplication(ApplicationCommandLineArgs args);
@@ -1408,6 +2273,7 @@ namespace HE {
 
         HYDRA_API std::future<void> SubmitTask(const std::function<void()>& function);
         HYDRA_API Future RunTaskflow(Taskflow& taskflow);
+        HYDRA_API void RunTaskflowAndWait(Taskflow& taskflow); // safe on a worker, which runs other tasks while it waits instead of blocking
         HYDRA_API void WaitForAll();
         HYDRA_API void SetMainThreadMaxJobsPerFrame(uint32_t max);
         HYDRA_API void SubmitToMainThread(const std::function<void()>& function);
@@ -1425,6 +2291,77 @@ namespace HE {
             Local
         };
 
+        enum class AccessPattern
+        {
+            Normal,
+            Sequential,  // read ahead aggressively, pages behind the reader can be dropped early
+            Random       // no read ahead
+        };
+
+        // Read-only mapping of a whole file. Nothing is copied, pages are read on first touch.
+        // Entries of mounted archives are inflated into memory instead.
+        class MappedFile
+        {
+        public:
+            MappedFile() = default;
+            ~MappedFile() { Unmap(); }
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            MappedFile(MappedFile&& other) noexcept : data(other.data), size(other.size), readableSize(other.readableSize), mapped(other.mapped), owned(other.owned) { other.data = nullptr; other.size = 0; other.readableSize = 0; other.mapped = false; other.owned = false; }
+            MappedFile& operator=(MappedFile&& other) noexcept
+            {
+                if (this != &other)
+                {
+                    std::swap(data, other.data);
+                    std::swap(size, other.size);
+                    std::swap(readableSize, other.readableSize);
+                    std::swap(mapped, other.mapped);
+                    std::swap(owned, other.owned);
+                }
+                return *this;
+            }
+
+            const uint8_t* Data() const { return data; }
+            uint64_t Size() const { return size; }
+            uint64_t ReadableSize() const { return readableSize; } // size rounded up to whole pages (padded for archive entries), the bytes past Size() read as zero
+            bool IsMapped() const { return mapped; }               // an empty file maps with a null Data()
+
+            Buffer GetBuffer() const { return Buffer(data, size); } // non-owning view, never Release it
+            std::span<const uint8_t> GetSpan() const { return { data, size_t(size) }; }
+            std::string_view GetString() const { return { (const char*)data, size_t(size) }; }
+
+            HYDRA_API bool Map(const std::filesystem::path& filePath, AccessPattern pattern = AccessPattern::Normal);
+            HYDRA_API void Unmap();
+
+        private:
+            bool MapNative(const std::filesystem::path& filePath, AccessPattern pattern);
+            void UnmapNative();
+
+            const uint8_t* data = nullptr;
+            uint64_t size = 0;
+            uint64_t readableSize = 0;
+            bool mapped = false;
+            bool owned = false; // heap copy of an archive entry
+        };
+
+        inline MappedFile MapFile(const std::filesystem::path& filePath, AccessPattern pattern = AccessPattern::Normal)
+        {
+            MappedFile file;
+            file.Map(filePath, pattern);
+            return file;
+        }
+
+        // Virtual file system. Directories and .zip archives are mounted at a prefix such as "assets:/", a path under a
+        // prefix resolves through a hashed index to the highest priority mount holding it. Archive entries are read in
+        // place without extracting. MapFile, the readers below and AsyncIO accept virtual paths.
+        HYDRA_API bool Mount(std::string_view prefix, const std::filesystem::path& source, int priority = 0); // later mounts win ties
+        HYDRA_API bool Unmount(std::string_view prefix, const std::filesystem::path& source);
+        HYDRA_API bool IsVirtualPath(const std::filesystem::path& path);
+        HYDRA_API bool Exists(const std::filesystem::path& path);
+        HYDRA_API std::filesystem::path ResolvePath(const std::filesystem::path& path); // real file, empty for archive entries, files not found land in the highest priority directory mount
+
         HYDRA_API bool Delete(const std::filesystem::path& path);
         HYDRA_API bool Rename(const std::filesystem::path& oldPath, const std::filesystem::path& newPath);
         HYDRA_API bool Copy(const std::filesystem::path& from, const std::filesystem::path& to, std::filesystem::copy_options options = std::filesystem::copy_options::recursive);
@@ -1449,6 +2386,56 @@ namespace HE {
 
         HYDRA_API void SetEnvVar(const char* var, const char* value);
         HYDRA_API void RemoveEnvVar(const char* var);
+
+        // stream Unix domain sockets, handles are -1 on failure or timeout
+        HYDRA_API intptr_t CreateLocalSocket(const std::filesystem::path& path);
+        HYDRA_API intptr_t AcceptLocalSocket(intptr_t socket, uint32_t timeoutMs);
+        HYDRA_API int ReadLocalSocket(intptr_t socket, void* data, size_t size, uint32_t timeoutMs);
+        HYDRA_API bool WriteLocalSocket(intptr_t socket, const void* data, size_t size);
+        HYDRA_API void CloseLocalSocket(intptr_t socket);
+
+        // directory change notifications, handles are -1 on failure
+        HYDRA_API intptr_t CreateFileWatcher();
+        HYDRA_API bool AddFileWatch(intptr_t watcher, const std::filesystem::path& directory);
+        HYDRA_API bool ReadFileWatcher(intptr_t watcher, std::vector<std::filesystem::path>& changedFiles, uint32_t timeoutMs); // appends files written or moved into a watched directory
+        HYDRA_API void CloseFileWatcher(intptr_t watcher);
+
+        // gamepads read straight from evdev (Linux) or XInput (Windows). Unlike GLFW's joystick functions these can be
+        // sampled off the main thread. Slots follow the backend's enumeration, the evdev node order or the XInput user
+        // index, which usually but not always matches GLFW's joystick ids.
+        struct GamepadState
+        {
+            bool connected = false;
+            uint32_t buttons = 0; // one bit per GamepadButton
+            float axes[4] = {};   // left x, left y, right x, right y in -1..1, y pointing down like GLFW
+        };
+
+        HYDRA_API intptr_t OpenGamepads();
+        HYDRA_API void ReadGamepads(intptr_t gamepads, std::span<GamepadState> states); // one state per slot, call from a single thread
+        HYDRA_API void CloseGamepads(intptr_t gamepads);
+
+        // kernel I/O submission ring, -1 where there is none, operations are identified by a slot below queueDepth
+        struct IOOperation
+        {
+            std::filesystem::path path;
+            uint8_t* data = nullptr;
+            uint64_t size = 0;
+            uint64_t offset = 0;
+            bool write = false;
+            bool truncate = false;
+            uint32_t slot = 0;
+        };
+
+        struct IOCompletion
+        {
+            uint32_t slot = 0;
+            int64_t result = 0; // bytes transferred, negative on failure
+        };
+
+        HYDRA_API intptr_t CreateIORing(uint32_t queueDepth);
+        HYDRA_API uint32_t SubmitIORing(intptr_t ring, std::span<const IOOperation> operations); // how many the kernel took, in order, the rest never complete; files that fail to open complete with an error
+        HYDRA_API int32_t WaitIORing(intptr_t ring, std::span<IOCompletion> completions); // blocks until at least one operation completes, short transfers are resubmitted, -1 when the ring failed
+        HYDRA_API void CloseIORing(intptr_t ring);
     }
 
 #ifndef CPP_MODULE
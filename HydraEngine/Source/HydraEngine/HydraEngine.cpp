@@ -34,6 +34,14 @@ module;
 #  define GLFW_EXPOSE_NATIVE_X11
 #  include <unistd.h>
 #endif
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#elif defined(__x86_64__)
+#  include <x86intrin.h>
+#endif
+#if !defined(_MSC_VER)
+#  include <cxxabi.h>
+#endif
 #include "GLFW/glfw3.h"
 #include "GLFW/glfw3native.h"
 
@@ -62,1314 +70,5027 @@ namespace HE {
 
     static std::shared_ptr<spdlog::logger> s_CoreLogger;
     static std::shared_ptr<spdlog::logger> s_ClientLogger;
-    
-    void Log::Init(const std::filesystem::path& client)
-    {
-        std::vector<spdlog::sink_ptr> logSinks;
-        logSinks.emplace_back(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
-        logSinks.emplace_back(std::make_shared<spdlog::sinks::basic_file_sink_mt>(client.string(), true));
-    
-        logSinks[0]->set_pattern("%^[%T] %n: %v%$");
-        logSinks[1]->set_pattern("[%T] [%l] %n: %v");
-    
-        s_CoreLogger = std::make_shared<spdlog::logger>("Core", begin(logSinks), end(logSinks));
-        spdlog::register_logger(s_CoreLogger);
-        s_CoreLogger->set_level(spdlog::level::trace);
-        s_CoreLogger->flush_on(spdlog::level::trace);
-    
-        std::string loggerName = client.stem().string();
-    
-        s_ClientLogger = std::make_shared<spdlog::logger>(loggerName, begin(logSinks), end(logSinks));
-        spdlog::register_logger(s_ClientLogger);
-        s_ClientLogger->set_level(spdlog::level::trace);
-        s_ClientLogger->flush_on(spdlog::level::trace);
-    }
-    
-    void Log::Shutdown()
-    {
-        s_ClientLogger.reset();
-        s_CoreLogger.reset();
-        spdlog::drop_all();
-    }
-    
-    void Log::CoreTrace(const char* s) { s_CoreLogger->trace(s); }
-    void Log::CoreInfo(const char* s) { s_CoreLogger->info(s); }
-    void Log::CoreWarn(const char* s) { s_CoreLogger->warn(s); }
-    void Log::CoreError(const char* s) { s_CoreLogger->error(s); }
-    void Log::CoreCritical(const char* s) { s_CoreLogger->critical(s); }
-    
-    void Log::ClientTrace(const char* s) { s_ClientLogger->trace(s); }
-    void Log::ClientInfo(const char* s) { s_ClientLogger->info(s); }
-    void Log::ClientWarn(const char* s) { s_ClientLogger->warn(s); }
-    void Log::ClientError(const char* s) { s_ClientLogger->error(s); }
-    void Log::ClientCritical(const char* s) { s_ClientLogger->critical(s); }
 
-#endif
+    // read by every logging thread, written by Init and SetRateLimit
+    struct RateLimitState
+    {
+        std::atomic<uint32_t> burst = 0;
+        std::atomic<uint64_t> interval = 0; // ns
+        std::atomic<bool> coalesce = false;
+    };
 
-    //////////////////////////////////////////////////////////////////////////
-    // Layer Stack
-    //////////////////////////////////////////////////////////////////////////
+    static RateLimitState s_RateLimits[2];
 
-    LayerStack::~LayerStack()
+    struct Log::SiteState
     {
-        for (Layer* layer : m_Layers)
-        {
-            layer->OnDetach();
-            delete layer;
-            layer = nullptr;
-        }
-    }
+        std::string location; // file name and line, copied since the site's module can be unloaded first
+        Logger logger = Logger::Core;
+        std::atomic<uint64_t> windowStart = 0;
+        std::atomic<uint32_t> count = 0;
+        std::atomic<uint32_t> suppressed = 0;
+        std::atomic<uint64_t> lastHash = 0;
+        std::atomic<uint64_t> lastWritten = 0; // time of the last message written, repeats within an interval of it collapse
+        std::atomic<LogLevel> lastLevel = LogLevel::Trace;
+        std::atomic<uint32_t> repeats = 0;
+    };
 
-    void LayerStack::PushLayer(Layer* layer)
+    static std::mutex s_SitesMutex;
+    static std::deque<Log::SiteState> s_Sites; // never shrinks, sites keep pointers into it
+
+    static Log::SiteState& GetSiteState(Log::Site& site, Log::Logger logger)
     {
-        HE_CORE_ASSERT(layer);
+        if (Log::SiteState* state = site.state.load(std::memory_order_acquire))
+            return *state;
 
-        m_Layers.emplace(m_Layers.begin() + m_LayerInsertIndex, layer);
-        m_LayerInsertIndex++;
-        layer->OnAttach();
-    }
+        std::scoped_lock lock(s_SitesMutex);
+        if (Log::SiteState* state = site.state.load(std::memory_order_relaxed))
+            return *state;
 
-    void LayerStack::PushOverlay(Layer* overlay)
-    {
-        HE_CORE_ASSERT(overlay);
+        Log::SiteState& state = s_Sites.emplace_back();
+        state.location = std::format("{}:{}", std::filesystem::path(site.file).filename().string(), site.line);
+        state.logger = logger;
+        site.state.store(&state, std::memory_order_release);
 
-        m_Layers.emplace_back(overlay);
-        overlay->OnAttach();
+        return state;
     }
 
-    void LayerStack::PopLayer(Layer* layer)
+    // counts are taken with an exchange, so whichever of the site and the flush sees them first writes them once
+    static void ReportHeldCounts(Log::SiteState& state, uint64_t now, bool all)
     {
-        HE_CORE_ASSERT(layer);
+        uint64_t interval = s_RateLimits[size_t(state.logger)].interval.load(std::memory_order_relaxed);
 
-        auto it = std::find(m_Layers.begin(), m_Layers.begin() + m_LayerInsertIndex, layer);
-        if (it != m_Layers.begin() + m_LayerInsertIndex)
+        if (all || now - state.windowStart.load(std::memory_order_relaxed) >= interval)
         {
-            layer->OnDetach();
-            m_Layers.erase(it);
-            m_LayerInsertIndex--;
+            if (uint32_t suppressed = state.suppressed.exchange(0, std::memory_order_relaxed))
+                Log::Write(state.logger, LogLevel::Warn, std::format("{} messages suppressed from {}", suppressed, state.location));
         }
-    }
-
-    void LayerStack::PopOverlay(Layer* overlay)
-    {
-        HE_CORE_ASSERT(overlay)
 
-            auto it = std::find(m_Layers.begin() + m_LayerInsertIndex, m_Layers.end(), overlay);
-        if (it != m_Layers.end())
+        if (all || now - state.lastWritten.load(std::memory_order_relaxed) >= interval)
         {
-            overlay->OnDetach();
-            m_Layers.erase(it);
+            if (uint32_t repeats = state.repeats.exchange(0, std::memory_order_relaxed))
+                Log::Write(state.logger, state.lastLevel.load(std::memory_order_relaxed), std::format("message from {} repeated {} times", state.location, repeats));
         }
     }
 
-    //////////////////////////////////////////////////////////////////////////
-    // Application
-    //////////////////////////////////////////////////////////////////////////
+    static void ReportHeldCounts(bool all)
+    {
+        uint64_t now = Application::GetTimestamp();
 
-    ApplicationContext& GetAppContext() { return *ApplicationContext::s_Instance; }
+        std::scoped_lock lock(s_SitesMutex);
+        for (Log::SiteState& state : s_Sites)
+            ReportHeldCounts(state, now, all);
+    }
 
-    namespace Application {
+    // .helog layout, little endian:
+    //   header  : magic "HELG", u32 version, u64 unix start time (ns), u16 + client logger name
+    //   records : u8 kind followed by
+    //     Format  : u64 id, u32 size, format string
+    //     Message : u64 time since start (ns), u32 thread, u8 logger, u8 level, u64 format id, u8 arg count, args (Log::BinaryArgType tag + value)
+    //     Text    : u64 time since start (ns), u32 thread, u8 logger, u8 level, u32 size, preformatted text
+    enum class BinaryLogRecord : uint8_t { Format, Message, Text };
+    constexpr uint32_t c_BinaryLogVersion = 1;
 
-        void Restart() { GetAppContext().running = false; }
-        void Shutdown() { GetAppContext().running = false;  GetAppContext().s_ApplicationRunning = false; }
-        bool IsApplicationRunning() { return GetAppContext().s_ApplicationRunning; }
-        void PushLayer(Layer* overlay) { GetAppContext().layerStack.PushLayer(overlay); }
-        void PushOverlay(Layer* layer) { GetAppContext().layerStack.PushOverlay(layer); }
-        void PopLayer(Layer* layer) { GetAppContext().layerStack.PopLayer(layer); }
-        void PopOverlay(Layer* overlay) { GetAppContext().layerStack.PopOverlay(overlay); }
-        const Stats& GetStats() { return GetAppContext().appStats; }
-        const ApplicationDesc& GetApplicationDesc() { return GetAppContext().applicatoinDesc; }
-        float GetAverageFrameTimeSeconds() { return GetAppContext().averageFrameTime; }
-        float GetLastFrameTimestamp() { return GetAppContext().lastFrameTime; }
-        void  SetFrameTimeUpdateInterval(float seconds) { GetAppContext().averageTimeUpdateInterval = seconds; }
-        Window& GetWindow() { return  GetAppContext().mainWindow; }
-    }
+    struct BinaryLogThreadBuffer;
 
-    void OnEvent(Event& e)
+    struct BinaryLog
     {
-        HE_PROFILE_FUNCTION();
-
-        auto& c = GetAppContext();
+        std::mutex mutex;
+        std::ofstream file;
+        std::mutex buffersMutex;                        // taken before a buffer's own mutex, which is taken before mutex
+        std::vector<BinaryLogThreadBuffer*> buffers;    // every live thread buffer, drained by the flusher
+        std::condition_variable flusherCV;
+        std::thread flusher;
+        bool flusherRunning = false;
+        std::unordered_set<uint64_t> formats;   // written to the file
+        std::atomic<bool> enabled = false;
+        std::atomic<uint32_t> generation = 0;   // invalidates the thread local caches on re-init
+        std::atomic<uint32_t> threadCount = 0;
+        uint64_t startTime = 0;
+        uint32_t bufferSize = 0;
+        LogLevel flushLevel = LogLevel::Trace;
+    };
 
-        DispatchEvent<WindowCloseEvent>(e, [](WindowCloseEvent& e) {
+    static BinaryLog s_BinaryLog;
 
-            Application::Shutdown();
-            return true;
-            });
+    static void FlushBinaryLogBuffer(std::vector<uint8_t>& data)
+    {
+        if (data.empty())
+            return;
 
-        for (auto it = c.layerStack.rbegin(); it != c.layerStack.rend(); ++it)
-        {
-            if (e.handled)
-                break;
-            (*it)->OnEvent(e);
-        }
+        std::scoped_lock lock(s_BinaryLog.mutex);
+        if (s_BinaryLog.file.is_open())
+            s_BinaryLog.file.write((const char*)data.data(), data.size());
+        data.clear();
     }
 
-    void ApplicationContext::Run()
+    struct BinaryLogThreadBuffer
     {
-        HE_PROFILE_FUNCTION();
+        std::mutex mutex;                       // held by the owning thread per record and by the flusher
+        std::vector<uint8_t> data;
+        std::unordered_set<uint64_t> formats;   // already known to be in the file
+        uint32_t generation = ~0u;
+        uint32_t thread = s_BinaryLog.threadCount++;
 
-        while (running)
+        BinaryLogThreadBuffer()
         {
-            HE_PROFILE_FRAME();
-            HE_PROFILE_SCOPE("Core Loop");
+            std::scoped_lock lock(s_BinaryLog.buffersMutex);
+            s_BinaryLog.buffers.push_back(this);
+        }
 
-            float time = Application::GetTime();
-            Timestep timestep = time - lastFrameTime;
-            lastFrameTime = time;
+        ~BinaryLogThreadBuffer()
+        {
+            std::scoped_lock lock(s_BinaryLog.buffersMutex, mutex);
+            std::erase(s_BinaryLog.buffers, this);
+            FlushBinaryLogBuffer(data);
+        }
 
-            blockingEventsUntilNextFrame = false;
+        template<typename T>
+        void Put(const T& v) { Put(&v, sizeof(T)); }
+        void Put(const void* p, size_t n) { data.insert(data.end(), (const uint8_t*)p, (const uint8_t*)p + n); }
 
+        void Begin(BinaryLogRecord kind, Log::Logger logger, LogLevel level)
+        {
+            if (generation != s_BinaryLog.generation)
             {
-                HE_PROFILE_SCOPE_NC("ExecuteMainThreadQueue", 0xAA0000);
-
-                std::scoped_lock<std::mutex> lock(mainThreadQueueMutex);
-                size_t count = std::min(mainThreadMaxJobsPerFrame, (uint32_t)mainThreadQueue.size());
-                for (size_t i = 0; i < count; i++)
-                {
-                    mainThreadQueue.front()();
-                    mainThreadQueue.pop();
-                }
+                generation = s_BinaryLog.generation;
+                formats.clear();
+                data.clear();
+                data.reserve(s_BinaryLog.bufferSize);
             }
 
-            bool headlessDevice = applicatoinDesc.deviceDesc.headlessDevice;
+            Put(kind);
+            Put(uint64_t(Application::GetTimestamp() - s_BinaryLog.startTime));
+            Put(thread);
+            Put(logger);
+            Put(level);
+        }
 
-            if (!mainWindow.IsMinimized())
+        void End(LogLevel level)
+        {
+            if (data.size() >= s_BinaryLog.bufferSize || level >= s_BinaryLog.flushLevel)
             {
-                nvrhi::IFramebuffer* framebuffer = nullptr;
-                if (!headlessDevice)
-                {
-                    auto sc = GetAppContext().mainWindow.swapChain;
-
-                    if (sc)
-                    {
-                        sc->UpdateSize();
-                        if (sc->BeginFrame())
-                        {
-                            framebuffer = sc->GetCurrentFramebuffer();
-                        }
-                    }
-                }
-
-                FrameInfo info = { timestep, framebuffer };
-
-                {
-                    HE_PROFILE_SCOPE("LayerStack OnBegin");
-                    for (Layer* layer : layerStack)
-                        layer->OnBegin(info);
-                }
-
+                FlushBinaryLogBuffer(data);
+                if (level >= s_BinaryLog.flushLevel)
                 {
-                    HE_PROFILE_SCOPE("LayerStack OnUpdate");
-                    for (Layer* layer : layerStack)
-                        layer->OnUpdate(info);
+                    std::scoped_lock lock(s_BinaryLog.mutex);
+                    s_BinaryLog.file.flush();
                 }
+            }
+        }
+    };
 
-                {
-                    HE_PROFILE_SCOPE("LayerStack OnEnd");
-                    for (Layer* layer : layerStack)
-                        layer->OnEnd(info);
-                }
+    static thread_local BinaryLogThreadBuffer t_BinaryLogBuffer;
 
-                if (!headlessDevice)
-                {
-                    auto sc = GetAppContext().mainWindow.swapChain;
-                    if (sc)
-                    {
-                        sc->Present();
-                    }
-                }
-            }
-            else
+    // long lived threads rarely fill their buffer, so without this a crash would lose their recent Trace and Info records
+    static void FlushBinaryLogBuffers()
+    {
+        {
+            std::scoped_lock lock(s_BinaryLog.buffersMutex);
+            for (BinaryLogThreadBuffer* b : s_BinaryLog.buffers)
             {
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                std::scoped_lock bufferLock(b->mutex);
+                if (b->generation == s_BinaryLog.generation)
+                    FlushBinaryLogBuffer(b->data);
             }
+        }
 
-            if (!headlessDevice)
-                mainWindow.UpdateEvent();
-
-            // time
-            {
-                frameTimeSum += timestep;
-                numberOfAccumulatedFrames += 1;
+        std::scoped_lock lock(s_BinaryLog.mutex);
+        if (s_BinaryLog.file.is_open())
+            s_BinaryLog.file.flush();
+    }
 
-                if (frameTimeSum > averageTimeUpdateInterval && numberOfAccumulatedFrames > 0)
-                {
-                    averageFrameTime = frameTimeSum / numberOfAccumulatedFrames;
-                    numberOfAccumulatedFrames = 0;
-                    frameTimeSum = 0.0f;
-                }
+    static void BinaryLogFlusherMain(std::chrono::milliseconds interval)
+    {
+        Profiler::SetThreadName("Binary Log Flusher");
 
-                appStats.CPUMainTime = averageFrameTime * 1e3f;
-                appStats.FPS = (averageFrameTime > 0.0f) ? int(1.0f / averageFrameTime) : 0;
-            }
+        std::unique_lock lock(s_BinaryLog.buffersMutex);
+        while (s_BinaryLog.flusherRunning)
+        {
+            s_BinaryLog.flusherCV.wait_for(lock, interval, [] { return !s_BinaryLog.flusherRunning; });
 
-            HE_PROFILE_FRAME();
+            lock.unlock();
+            FlushBinaryLogBuffers();
+            lock.lock();
         }
     }
 
-    ApplicationContext::ApplicationContext(const ApplicationDesc& desc)
-        : applicatoinDesc(desc)
-        , executor(desc.workersNumber)
+    // flushing every message would undo the buffering of the async and binary modes
+    static LogLevel GetFlushLevel(const LogDesc& desc)
     {
-        HE_PROFILE_FUNCTION();
+        return desc.flushLevel.value_or(desc.mode == LogDesc::Mode::Sync ? LogLevel::Trace : LogLevel::Warn);
+    }
 
-#ifdef HE_ENABLE_LOGGING
-        Log::Init(desc.logFile);
-#endif
+    static bool InitBinaryLog(const std::filesystem::path& client, const LogDesc& desc)
+    {
+        std::filesystem::path path = client;
+        path.replace_extension(".helog");
 
-        HE_CORE_INFO("Creat Application [{}]", applicatoinDesc.windowDesc.title);
+        std::scoped_lock lock(s_BinaryLog.mutex);
 
-        s_Instance = this;
+        s_BinaryLog.file.open(path, std::ios::binary | std::ios::trunc);
+        if (!s_BinaryLog.file.is_open())
+            return false;
 
-        auto commandLineArgs = applicatoinDesc.commandLineArgs;
-        if (commandLineArgs.count > 1)
+        std::string name = client.stem().string();
+        uint64_t unixTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        uint16_t nameSize = uint16_t(name.size());
+
+        s_BinaryLog.file.write("HELG", 4);
+        s_BinaryLog.file.write((const char*)&c_BinaryLogVersion, sizeof(c_BinaryLogVersion));
+        s_BinaryLog.file.write((const char*)&unixTime, sizeof(unixTime));
+        s_BinaryLog.file.write((const char*)&nameSize, sizeof(nameSize));
+        s_BinaryLog.file.write(name.data(), nameSize);
+
+        s_BinaryLog.formats.clear();
+        s_BinaryLog.startTime = Application::GetTimestamp();
+        s_BinaryLog.bufferSize = std::max(desc.binaryBufferSize, 256u);
+        s_BinaryLog.flushLevel = GetFlushLevel(desc);
+        s_BinaryLog.generation++;
+        s_BinaryLog.enabled = true;
+
+        // flushInterval also drains the thread buffers, binary mode always does so at least once a second
+        float interval = desc.flushInterval > 0.0f ? std::min(desc.flushInterval, 1.0f) : 1.0f;
         {
-            HE_INFO("CommandLineArgs : ");
-            for (int i = 0; i < commandLineArgs.count; i++)
-            {
-                HE_INFO("- [{}] : {}", i, commandLineArgs[i]);
-            }
+            std::scoped_lock flusherLock(s_BinaryLog.buffersMutex);
+            s_BinaryLog.flusherRunning = true;
         }
+        s_BinaryLog.flusher = std::thread(BinaryLogFlusherMain, std::chrono::milliseconds(int64_t(interval * 1000.0f)));
 
-        if (!applicatoinDesc.workingDirectory.empty())
-            std::filesystem::current_path(applicatoinDesc.workingDirectory);
+        return true;
+    }
+
+    static void ShutdownBinaryLog()
+    {
+        if (!s_BinaryLog.enabled)
+            return;
 
-        if (!applicatoinDesc.deviceDesc.headlessDevice)
         {
-            mainWindow.Init(applicatoinDesc.windowDesc);
-            mainWindow.eventCallback = OnEvent;
+            std::scoped_lock lock(s_BinaryLog.buffersMutex);
+            s_BinaryLog.flusherRunning = false;
         }
+        s_BinaryLog.flusherCV.notify_all();
+        if (s_BinaryLog.flusher.joinable())
+            s_BinaryLog.flusher.join();
 
-        if (applicatoinDesc.createDefaultDevice)
-            RHI::TryCreateDefaultDevice();
+        // every thread's buffer, threads that keep running past shutdown stop reaching the file
+        FlushBinaryLogBuffers();
 
-        if (!applicatoinDesc.deviceDesc.headlessDevice)
-        {
-            mainWindow.swapChain = RHI::GetDeviceManager()->CreateSwapChain(mainWindow.desc.swapChainDesc, mainWindow.handle);
-        }
+        std::scoped_lock lock(s_BinaryLog.mutex);
+        s_BinaryLog.enabled = false;
+        s_BinaryLog.file.close();
     }
 
-    //////////////////////////////////////////////////////////////////////////
-    // Jops
-    //////////////////////////////////////////////////////////////////////////
+    bool Log::IsBinary()
+    {
+        return s_BinaryLog.enabled.load(std::memory_order_relaxed);
+    }
 
-    namespace Jops {
+    void Log::WriteBinary(Logger logger, LogLevel level, std::string_view format, const uint8_t* args, size_t size, uint8_t argCount)
+    {
+        BinaryLogThreadBuffer& b = t_BinaryLogBuffer;
 
-        std::future<void> SubmitTask(const std::function<void()>& function) { return GetAppContext().executor.async(function); }
-        
-        Future RunTaskflow(Taskflow& taskflow) { return GetAppContext().executor.run(taskflow); }
-        
-        void WaitForAll() { GetAppContext().executor.wait_for_all(); }
-       
-        void SetMainThreadMaxJobsPerFrame(uint32_t max) { GetAppContext().mainThreadMaxJobsPerFrame = max; }
+        uint64_t id = HashString(format);
+        if (b.generation != s_BinaryLog.generation || !b.formats.contains(id))
+        {
+            // definitions go straight to the file so they always precede the messages that use them
+            std::scoped_lock lock(s_BinaryLog.mutex);
+            if (s_BinaryLog.formats.insert(id).second)
+            {
+                uint32_t formatSize = uint32_t(format.size());
+                BinaryLogRecord kind = BinaryLogRecord::Format;
+                s_BinaryLog.file.write((const char*)&kind, sizeof(kind));
+                s_BinaryLog.file.write((const char*)&id, sizeof(id));
+                s_BinaryLog.file.write((const char*)&formatSize, sizeof(formatSize));
+                s_BinaryLog.file.write(format.data(), format.size());
+            }
+        }
 
-        void SubmitToMainThread(const std::function<void()>& function)
+        std::scoped_lock lock(b.mutex);
+        b.Begin(BinaryLogRecord::Message, logger, level);
+        b.formats.insert(id);
+        b.Put(id);
+        b.Put(argCount);
+        b.Put(args, size);
+        b.End(level);
+    }
+
+    static spdlog::level::level_enum ToSpdlogLevel(LogLevel level)
+    {
+        switch (level)
         {
-            auto& c = GetAppContext();
-            std::scoped_lock<std::mutex> lock(c.mainThreadQueueMutex);
-            c.mainThreadQueue.push(function);
+        case LogLevel::Trace:    return spdlog::level::trace;
+        case LogLevel::Info:     return spdlog::level::info;
+        case LogLevel::Warn:     return spdlog::level::warn;
+        case LogLevel::Error:    return spdlog::level::err;
+        case LogLevel::Critical: return spdlog::level::critical;
+        case LogLevel::Off:      return spdlog::level::off;
         }
+
+        return spdlog::level::trace;
     }
 
-    //////////////////////////////////////////////////////////////////////////
-    // SwapChain
-    //////////////////////////////////////////////////////////////////////////
+    // Async mode queue, a bounded lock-free MPSC ring with one writer thread that drains it in batches.
+    // Each slot carries a sequence number, a slot is free for position p when it reads p and holds p's message once it reads p + 1,
+    // the writer releases it for the next lap by storing p + capacity. Producers claim positions with a CAS on head,
+    // DropOldest producers may instead take back a full slot from the writer with a CAS on its sequence.
+    class RingLogger;
 
-    void SwapChain::ResetBackBuffers()
+    struct LogSlot
     {
-        HE_PROFILE_FUNCTION();
-
-        swapChainFramebuffers.clear();
-    }
+        std::atomic<uint64_t> sequence = 0;
+        RingLogger* logger = nullptr;
+        spdlog::level::level_enum level = spdlog::level::trace;
+        spdlog::log_clock::time_point time;
+        size_t thread = 0;
+        spdlog::source_loc source;
+        std::string payload;                    // keeps its capacity across laps, only longer messages allocate
+        bool flush = false;                     // a flush request rather than a message
+    };
 
-    void SwapChain::ResizeBackBuffers()
+    struct LogRing
     {
-        HE_PROFILE_FUNCTION();
+        static constexpr uint64_t c_Reading = 1ull << 63;   // set on a slot's sequence while the writer copies it out
+        static constexpr size_t c_BatchSize = 256;          // messages written between flushes at most
+
+        std::unique_ptr<LogSlot[]> slots;
+        uint64_t mask = 0;
+        LogDesc::OverflowPolicy overflowPolicy = LogDesc::OverflowPolicy::Block;
+        spdlog::level::level_enum flushLevel = spdlog::level::warn;
+        RingLogger* core = nullptr;                          // reports dropped messages
+
+        alignas(64) std::atomic<uint64_t> head = 0;  // next position claimed by a producer
+        alignas(64) uint64_t tail = 0;               // next position read by the writer, writer only
+        std::atomic<uint64_t> dropped = 0;
+        std::atomic<bool> sleeping = false;
+        std::atomic<bool> running = false;
+        std::thread writer;
+    };
 
-        uint32_t backBufferCount = GetBackBufferCount();
-        swapChainFramebuffers.resize(backBufferCount);
-        for (uint32_t index = 0; index < backBufferCount; index++)
-        {
-            nvrhi::ITexture* texture = GetBackBuffer(index);
-            nvrhi::FramebufferDesc& desc = nvrhi::FramebufferDesc().addColorAttachment(texture);
-            swapChainFramebuffers[index] = nvrhiDevice->createFramebuffer(desc);
-        }
-    }
+    static LogRing s_LogRing;
 
-    void SwapChain::UpdateSize()
+    class RingLogger final : public spdlog::logger
     {
-        HE_PROFILE_FUNCTION();
-
-        int height, width;
-        glfwGetWindowSize((GLFWwindow*)windowHandle, &width, &height);
-        if (width == 0 || height == 0)
-            return;
+    public:
+        using spdlog::logger::logger;
 
-        if (int(desc.backBufferWidth) != width || int(desc.backBufferHeight) != height || (desc.vsync != isVSync && nvrhiDevice->getGraphicsAPI() == nvrhi::GraphicsAPI::VULKAN))
+        // writer thread only, the sinks are never touched from the producers
+        void Write(const spdlog::details::log_msg& msg)
         {
-            isVSync = desc.vsync;
+            for (auto& sink : sinks_)
+            {
+                if (sink->should_log(msg.level))
+                    sink->log(msg);
+            }
+        }
 
-            ResizeSwapChain(width, height);
+        void Flush()
+        {
+            for (auto& sink : sinks_)
+                sink->flush();
         }
-    }
 
-    nvrhi::IFramebuffer* SwapChain::GetCurrentFramebuffer()
-    {
-        return GetFramebuffer(GetCurrentBackBufferIndex());
-    }
+        // once the writer is gone messages are written on the calling thread like a sync logger
+        void WriteDirect(const spdlog::details::log_msg& msg) { spdlog::logger::sink_it_(msg); }
+        void FlushDirect() { spdlog::logger::flush_(); }
 
-    nvrhi::IFramebuffer* SwapChain::GetFramebuffer(uint32_t index)
-    {
-        if (index < swapChainFramebuffers.size())
-            return swapChainFramebuffers[index];
+    protected:
+        void sink_it_(const spdlog::details::log_msg& msg) override;
+        void flush_() override;
+    };
 
-        return nullptr;
+    static void WakeLogWriter()
+    {
+        // pairs with the fence in LogWriterMain, either the writer sees the published slot or the producer sees it asleep
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (s_LogRing.sleeping.load(std::memory_order_relaxed) && s_LogRing.sleeping.exchange(false, std::memory_order_relaxed))
+            s_LogRing.sleeping.notify_one();
     }
 
-    //////////////////////////////////////////////////////////////////////////
-    // RHI
-    //////////////////////////////////////////////////////////////////////////
-    
-    namespace RHI {
+    // returns nullptr when the message is dropped, dropped flush requests are not counted
+    static LogSlot* ClaimLogSlot(uint64_t& position, bool flush)
+    {
+        LogRing& r = s_LogRing;
+        uint64_t capacity = r.mask + 1;
+        uint64_t pos = r.head.load(std::memory_order_relaxed);
 
-        DeviceContext::~DeviceContext()
+        while (true)
         {
-            HE_PROFILE_FUNCTION();
+            LogSlot& slot = r.slots[pos & r.mask];
+            uint64_t seq = slot.sequence.load(std::memory_order_acquire);
 
-            for (auto dm : GetAppContext().deviceContext.managers)
+            if (seq == pos)
             {
-                if (dm)
+                if (r.head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
                 {
-                    dm->GetDevice()->waitForIdle();
-                    delete dm;
+                    position = pos;
+                    return &slot;
                 }
+                continue;
             }
-        }
-
-        DeviceManager* CreateDeviceManager(const DeviceDesc& desc)
-        {
-            HE_PROFILE_FUNCTION();
 
-            auto& c = GetAppContext();
-            auto& managers = c.deviceContext.managers;
-
-            DeviceManager* dm = nullptr;
-
-            for (size_t i = 0; i < desc.api.size(); i++)
+            // seq == pos - capacity + 1 means the slot still holds the previous lap's message, the ring is full
+            if ((seq & ~LogRing::c_Reading) + capacity - 1 == pos)
             {
-                auto api = desc.api[i];
-
-                if (api == nvrhi::GraphicsAPI(-1))
-                    continue;
-
-                HE_CORE_INFO("Trying to create backend API: {}", nvrhi::utils::GraphicsAPIToString(api));
-
-                switch (api)
+                switch (r.overflowPolicy)
                 {
-#if NVRHI_HAS_D3D11
-                case nvrhi::GraphicsAPI::D3D11:  dm = CreateD3D11(); break;
-#endif
-#if NVRHI_HAS_D3D12
-                case nvrhi::GraphicsAPI::D3D12:  dm = CreateD3D12(); break;
-#endif
-#if NVRHI_HAS_VULKAN
-                case nvrhi::GraphicsAPI::VULKAN: dm = CreateVULKAN(); break;
-#endif
-                }
+                case LogDesc::OverflowPolicy::Block:
+                    WakeLogWriter();
+                    std::this_thread::yield();
+                    break;
 
-                if (dm)
-                {
-                    if (dm->CreateDevice(desc))
+                case LogDesc::OverflowPolicy::Drop:
+                    if (!flush)
+                        r.dropped.fetch_add(1, std::memory_order_relaxed);
+                    return nullptr;
+
+                case LogDesc::OverflowPolicy::DropOldest:
+                    // the writer skips a position whose slot has moved on to the next lap and counts it as dropped
+                    if (!(seq & LogRing::c_Reading) && r.head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
                     {
-                        managers.push_back(dm);
-                        break;
-                    }
+                        uint64_t expected = seq;
+                        while (!slot.sequence.compare_exchange_weak(expected, pos, std::memory_order_acquire))
+                        {
+                            // the writer got there first and frees the slot for this lap once it has copied the message out
+                            if (expected == pos)
+                                break;
+                            expected = seq;
+                            std::this_thread::yield();
+                        }
 
-                    delete dm;
+                        position = pos;
+                        return &slot;
+                    }
+                    std::this_thread::yield();
+                    break;
                 }
 
-                HE_CORE_ERROR("Failed to create backend API: {}", nvrhi::utils::GraphicsAPIToString(api));
+                pos = r.head.load(std::memory_order_relaxed);
+                continue;
             }
 
-            return dm;
+            // another producer claimed pos, or the previous lap's producer has not published yet
+            pos = r.head.load(std::memory_order_relaxed);
         }
+    }
 
-        DeviceManager* GetDeviceManager(uint32_t index)
-        {
-            auto& managers = GetAppContext().deviceContext.managers;
-
-            if (index < managers.size() && managers.size() >= 1)
-                return managers[index];
+    static void PublishLogSlot(LogSlot& slot, uint64_t position)
+    {
+        slot.sequence.store(position + 1, std::memory_order_release);
+        WakeLogWriter();
+    }
 
-            return nullptr;
+    void RingLogger::sink_it_(const spdlog::details::log_msg& msg)
+    {
+        if (!s_LogRing.running.load(std::memory_order_acquire))
+        {
+            WriteDirect(msg);
+            return;
         }
 
-        nvrhi::DeviceHandle GetDevice(uint32_t index)
-        {
-            auto& managers = GetAppContext().deviceContext.managers;
+        uint64_t position;
+        LogSlot* slot = ClaimLogSlot(position, false);
+        if (!slot)
+            return;
 
-            if (index < managers.size() && managers.size() >= 1)
-                return managers[index]->GetDevice();
+        slot->logger = this;
+        slot->level = msg.level;
+        slot->time = msg.time;
+        slot->thread = msg.thread_id;
+        slot->source = msg.source;
+        slot->payload.assign(msg.payload.data(), msg.payload.size());
+        slot->flush = false;
+        PublishLogSlot(*slot, position);
+    }
 
-            return {};
+    void RingLogger::flush_()
+    {
+        if (!s_LogRing.running.load(std::memory_order_acquire))
+        {
+            FlushDirect();
+            return;
         }
 
-        void TryCreateDefaultDevice()
-        {
-            HE_PROFILE_FUNCTION();
+        // queued behind the messages before it, so a flush also covers everything logged ahead of it
+        uint64_t position;
+        LogSlot* slot = ClaimLogSlot(position, true);
+        if (!slot)
+            return;
 
-            auto& c = GetAppContext();
+        slot->logger = this;
+        slot->flush = true;
+        PublishLogSlot(*slot, position);
+    }
 
-            auto deviceDesc = c.applicatoinDesc.deviceDesc;
-            size_t apiCount = deviceDesc.api.size();
+    // copies the message at tail out of its slot, false when the ring is empty
+    static bool ReadLogSlot(LogSlot& out, bool& skipped)
+    {
+        LogRing& r = s_LogRing;
+        LogSlot& slot = r.slots[r.tail & r.mask];
+        uint64_t expected = r.tail + 1;
+        skipped = false;
 
-            if (deviceDesc.api[0] == nvrhi::GraphicsAPI(-1))
+        if (!slot.sequence.compare_exchange_strong(expected, expected | LogRing::c_Reading, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            // a DropOldest producer took the slot for the next lap, its message is read when the writer gets there
+            if (expected >= r.tail + r.mask + 1)
             {
-#ifdef HE_PLATFORM_WINDOWS
-                deviceDesc.api = {
-            #if NVRHI_HAS_D3D11
-                    nvrhi::GraphicsAPI::D3D11,
-            #endif
-            #if NVRHI_HAS_D3D12
-                    nvrhi::GraphicsAPI::D3D12,
-            #endif
-            #if NVRHI_HAS_VULKAN
-                    nvrhi::GraphicsAPI::VULKAN
-            #endif
-                };
-#else
-                deviceDesc.api = { nvrhi::GraphicsAPI::VULKAN };
-#endif
-                apiCount = deviceDesc.api.size();
+                r.tail++;
+                r.dropped.fetch_add(1, std::memory_order_relaxed);
+                skipped = true;
+                return true;
             }
+            return false;
+        }
 
-            DeviceManager* dm = CreateDeviceManager(deviceDesc);
+        out.logger = slot.logger;
+        out.level = slot.level;
+        out.time = slot.time;
+        out.thread = slot.thread;
+        out.source = slot.source;
+        out.flush = slot.flush;
+        out.payload.swap(slot.payload);
 
-            if (!dm)
-            {
-                HE_CORE_CRITICAL("No graphics backend could be initialized!");
-                std::exit(1);
-            }
-        }
+        slot.sequence.store(r.tail + r.mask + 1, std::memory_order_release);
+        r.tail++;
 
-        nvrhi::ShaderHandle CreateStaticShader(nvrhi::IDevice* device, StaticShader staticShader, const std::vector<ShaderMacro>* pDefines, const nvrhi::ShaderDesc& desc)
-        {
-            HE_PROFILE_FUNCTION();
+        return true;
+    }
 
-            nvrhi::ShaderHandle shader;
+    static void ReportDroppedLogMessages()
+    {
+        uint64_t dropped = s_LogRing.dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped == 0)
+            return;
 
-            Buffer buffer;
-            switch (device->getGraphicsAPI())
-            {
-            case nvrhi::GraphicsAPI::D3D11:  buffer = staticShader.dxbc;  break;
-            case nvrhi::GraphicsAPI::D3D12:  buffer = staticShader.dxil;  break;
-            case nvrhi::GraphicsAPI::VULKAN: buffer = staticShader.spirv; break;
-            }
+        std::string text = std::format("{} log messages dropped, the async queue was full", dropped);
+        spdlog::details::log_msg msg(spdlog::source_loc{}, s_LogRing.core->name(), spdlog::level::warn, spdlog::string_view_t(text.data(), text.size()));
+        s_LogRing.core->Write(msg);
+    }
 
-            const void* permutationBytecode = buffer.data;
-            size_t permutationSize = buffer.size;
+    static void LogWriterMain()
+    {
+        Profiler::SetThreadName("Log Writer");
 
-            if (pDefines)
+        LogRing& r = s_LogRing;
+        LogSlot entry;
+        std::vector<RingLogger*> toFlush;
+
+        while (true)
+        {
+            size_t count = 0;
+            bool skipped = false;
+            while (count < LogRing::c_BatchSize && ReadLogSlot(entry, skipped))
             {
-                std::vector<ShaderMake::ShaderConstant> constants;
-                constants.reserve(pDefines->size());
-                for (const ShaderMacro& define : *pDefines)
-                    constants.emplace_back(define.name.data(), define.definition.data());
+                count++;
+                if (skipped)
+                    continue;
 
-                if (!ShaderMake::FindPermutationInBlob(buffer.data, buffer.size, constants.data(), uint32_t(constants.size()), &permutationBytecode, &permutationSize))
+                if (!entry.flush)
                 {
-                    const std::string message = ShaderMake::FormatShaderNotFoundMessage(buffer.data, buffer.size, constants.data(), uint32_t(constants.size()));
-                    HE_CORE_ERROR("CreateStaticShader : {}", message.c_str());
+                    spdlog::details::log_msg msg(entry.time, entry.source, entry.logger->name(), entry.level, spdlog::string_view_t(entry.payload.data(), entry.payload.size()));
+                    msg.thread_id = entry.thread;
+                    entry.logger->Write(msg);
                 }
+
+                // level triggered flushes happen once per batch instead of once per message
+                if ((entry.flush || entry.level >= r.flushLevel) && std::find(toFlush.begin(), toFlush.end(), entry.logger) == toFlush.end())
+                    toFlush.push_back(entry.logger);
             }
 
-            shader = device->createShader(desc, permutationBytecode, permutationSize);
+            ReportDroppedLogMessages();
 
-            return shader;
-        }
+            for (RingLogger* logger : toFlush)
+                logger->Flush();
+            toFlush.clear();
 
-        nvrhi::ShaderLibraryHandle CreateShaderLibrary(nvrhi::IDevice* device, StaticShader staticShader, const std::vector<ShaderMacro>* pDefines)
-        {
-            HE_PROFILE_FUNCTION();
+            if (count > 0)
+                continue;
 
-            nvrhi::ShaderLibraryHandle shader;
+            if (!r.running.load(std::memory_order_acquire))
+                break;
 
-            Buffer buffer;
-            switch (device->getGraphicsAPI())
+            r.sleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (r.slots[r.tail & r.mask].sequence.load(std::memory_order_relaxed) != r.tail || !r.running.load(std::memory_order_relaxed))
             {
-            case nvrhi::GraphicsAPI::D3D11:  buffer = staticShader.dxbc;  break;
-            case nvrhi::GraphicsAPI::D3D12:  buffer = staticShader.dxil;  break;
-            case nvrhi::GraphicsAPI::VULKAN: buffer = staticShader.spirv; break;
+                r.sleeping.store(false, std::memory_order_relaxed);
+                continue;
             }
+            r.sleeping.wait(true, std::memory_order_relaxed);
+        }
+    }
 
-            const void* permutationBytecode = buffer.data;
-            size_t permutationSize = buffer.size;
+    static void StartLogRing(const LogDesc& desc, RingLogger* core)
+    {
+        LogRing& r = s_LogRing;
 
-            if (pDefines)
-            {
-                std::vector<ShaderMake::ShaderConstant> constants;
-                constants.reserve(pDefines->size());
-                for (const ShaderMacro& define : *pDefines)
-                    constants.emplace_back(define.name.data(), define.definition.data());
+        uint64_t capacity = std::bit_ceil(uint64_t(std::max(desc.queueSize, 2u)));
+        r.slots = std::make_unique<LogSlot[]>(capacity);
+        for (uint64_t i = 0; i < capacity; i++)
+        {
+            r.slots[i].sequence.store(i, std::memory_order_relaxed);
+            r.slots[i].payload.reserve(256);
+        }
 
-                if (!ShaderMake::FindPermutationInBlob(buffer.data, buffer.size, constants.data(), uint32_t(constants.size()), &permutationBytecode, &permutationSize))
-                {
-                    const std::string message = ShaderMake::FormatShaderNotFoundMessage(buffer.data, buffer.size, constants.data(), uint32_t(constants.size()));
-                    HE_CORE_ERROR("CreateStaticShader : {}", message.c_str());
-                }
-            }
+        r.mask = capacity - 1;
+        r.overflowPolicy = desc.overflowPolicy;
+        r.flushLevel = ToSpdlogLevel(GetFlushLevel(desc));
+        r.core = core;
+        r.head = 0;
+        r.tail = 0;
+        r.dropped = 0;
+        r.running.store(true, std::memory_order_release);
+        r.writer = std::thread(LogWriterMain);
+    }
 
-            shader = device->createShaderLibrary(permutationBytecode, permutationSize);
+    // drains the ring, messages logged from here on are written on the calling thread
+    static void StopLogRing()
+    {
+        LogRing& r = s_LogRing;
+        if (!r.writer.joinable())
+            return;
 
-            return shader;
-        }
+        r.running.store(false, std::memory_order_release);
+        r.sleeping.store(false, std::memory_order_relaxed);
+        r.sleeping.notify_one();
+        r.writer.join();
+    }
 
-        bool DeviceManager::CreateInstance(const DeviceInstanceDesc& pDesc)
-        {
-            HE_PROFILE_FUNCTION();
+    static std::shared_ptr<spdlog::logger> CreateLogger(const std::string& name, const std::vector<spdlog::sink_ptr>& sinks, const LogDesc& desc)
+    {
+        std::shared_ptr<spdlog::logger> logger;
 
-            if (instanceCreated)
-                return true;
+        if (desc.mode == LogDesc::Mode::Async)
+            logger = std::make_shared<RingLogger>(name, sinks.begin(), sinks.end());
+        else
+            logger = std::make_shared<spdlog::logger>(name, sinks.begin(), sinks.end());
 
-            static_cast<DeviceInstanceDesc&>(desc) = pDesc;
+        spdlog::register_logger(logger);
+        logger->set_level(spdlog::level::trace);
+        logger->flush_on(ToSpdlogLevel(GetFlushLevel(desc)));
 
-            instanceCreated = CreateInstanceInternal();
-            return instanceCreated;
-        }
+        return logger;
+    }
 
-        bool DeviceManager::CreateDevice(const DeviceDesc& pDesc)
+    void Log::Init(const std::filesystem::path& client, const LogDesc& desc)
+    {
+        std::vector<spdlog::sink_ptr> logSinks;
+        logSinks.emplace_back(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
+        logSinks[0]->set_pattern("%^[%T] %n: %v%$");
+
+        // in binary mode the loggers only gate levels, messages go to the .helog file
+        bool binary = desc.mode == LogDesc::Mode::Binary && InitBinaryLog(client, desc);
+        if (!binary)
         {
-            HE_PROFILE_FUNCTION();
+            logSinks.emplace_back(std::make_shared<spdlog::sinks::basic_file_sink_mt>(client.string(), true));
+            logSinks[1]->set_pattern("[%T] [%l] %n: %v");
+        }
 
-            desc = pDesc;
+        SetRateLimit(Logger::Core, desc.coreRateLimit);
+        SetRateLimit(Logger::Client, desc.clientRateLimit);
 
-            if (!CreateInstance(desc))
-                return false;
+        s_CoreLogger = CreateLogger("Core", logSinks, desc);
+        s_ClientLogger = CreateLogger(client.stem().string(), logSinks, desc);
 
-            if (!CreateDevice())
-                return false;
+        // one writer thread shared by both loggers, the sinks are only ever touched from it
+        if (desc.mode == LogDesc::Mode::Async)
+            StartLogRing(desc, static_cast<RingLogger*>(s_CoreLogger.get()));
 
-            HE_CORE_INFO("[Backend API] : {}", nvrhi::utils::GraphicsAPIToString(GetDevice()->getGraphicsAPI()));
+        if (desc.flushInterval > 0.0f)
+            spdlog::flush_every(std::chrono::milliseconds(int64_t(desc.flushInterval * 1000.0f)));
+
+        if (desc.mode == LogDesc::Mode::Binary && !binary)
+            s_CoreLogger->error("Unable to open binary log file, falling back to text logging");
+    }
+    
+    void Log::Shutdown()
+    {
+        ReportHeldCounts(true);
+        ShutdownBinaryLog();
+        StopLogRing();
+
+        s_ClientLogger.reset();
+        s_CoreLogger.reset();
+
+        // stops the periodic flusher thread
+        spdlog::shutdown();
+    }
+    
+    void Log::CoreTrace(const char* s) { s_CoreLogger->trace(s); }
+    void Log::CoreInfo(const char* s) { s_CoreLogger->info(s); }
+    void Log::CoreWarn(const char* s) { s_CoreLogger->warn(s); }
+    void Log::CoreError(const char* s) { s_CoreLogger->error(s); }
+    void Log::CoreCritical(const char* s) { s_CoreLogger->critical(s); }
+    
+    void Log::ClientTrace(const char* s) { s_ClientLogger->trace(s); }
+    void Log::ClientInfo(const char* s) { s_ClientLogger->info(s); }
+    void Log::ClientWarn(const char* s) { s_ClientLogger->warn(s); }
+    void Log::ClientError(const char* s) { s_ClientLogger->error(s); }
+    void Log::ClientCritical(const char* s) { s_ClientLogger->critical(s); }
+
+    bool Log::ShouldLog(Logger logger, LogLevel level)
+    {
+        const auto& l = logger == Logger::Core ? s_CoreLogger : s_ClientLogger;
+        return l && l->should_log(ToSpdlogLevel(level));
+    }
+
+    void Log::SetRateLimit(Logger logger, const LogRateLimit& limit)
+    {
+        RateLimitState& state = s_RateLimits[size_t(logger)];
+        state.burst.store(limit.burst, std::memory_order_relaxed);
+        state.interval.store(uint64_t(limit.interval * 1e9f), std::memory_order_relaxed);
+        state.coalesce.store(limit.coalesce, std::memory_order_relaxed);
+    }
 
+    void Log::FlushSuppressed()
+    {
+        ReportHeldCounts(false);
+    }
+
+    bool Log::Admit(Site& site, Logger logger, LogLevel level)
+    {
+        if (!ShouldLog(logger, level))
+            return false;
+
+        const RateLimitState& limit = s_RateLimits[size_t(logger)];
+        uint32_t burst = limit.burst.load(std::memory_order_relaxed);
+        if (burst == 0)
             return true;
+
+        SiteState& state = GetSiteState(site, logger);
+        uint64_t now = Application::GetTimestamp();
+        uint64_t windowStart = state.windowStart.load(std::memory_order_relaxed);
+
+        // the thread that wins the exchange opens the new window and reports what the last one dropped
+        if (now - windowStart >= limit.interval.load(std::memory_order_relaxed) && state.windowStart.compare_exchange_strong(windowStart, now, std::memory_order_relaxed))
+        {
+            state.count.store(0, std::memory_order_relaxed);
+            if (uint32_t suppressed = state.suppressed.exchange(0, std::memory_order_relaxed))
+                Write(logger, LogLevel::Warn, std::format("{} messages suppressed from {}", suppressed, state.location));
         }
 
-        DefaultMessageCallback& DefaultMessageCallback::GetInstance()
+        if (state.count.fetch_add(1, std::memory_order_relaxed) < burst)
+            return true;
+
+        state.suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    bool Log::Coalesce(Site& site, Logger logger, LogLevel level, std::string_view key, std::string_view extra)
+    {
+        const RateLimitState& limit = s_RateLimits[size_t(logger)];
+        if (!limit.coalesce.load(std::memory_order_relaxed))
+            return true;
+
+        SiteState& state = GetSiteState(site, logger);
+        uint64_t now = Application::GetTimestamp();
+        uint64_t hash = HashString(key) ^ (HashString(extra) * 0x9e3779b97f4a7c15ull);
+
+        // a repeat collapses only within an interval of the last written copy, a steady stream is still written once per interval
+        bool repeat = state.lastHash.exchange(hash, std::memory_order_relaxed) == hash;
+        if (repeat && now - state.lastWritten.load(std::memory_order_relaxed) < limit.interval.load(std::memory_order_relaxed))
         {
-            static DefaultMessageCallback Instance;
-            return Instance;
+            state.repeats.fetch_add(1, std::memory_order_relaxed);
+            return false;
         }
 
-        void DefaultMessageCallback::message(nvrhi::MessageSeverity severity, const char* messageText)
+        if (uint32_t repeats = state.repeats.exchange(0, std::memory_order_relaxed))
+            Write(logger, state.lastLevel.load(std::memory_order_relaxed), std::format("previous message repeated {} times", repeats));
+
+        state.lastWritten.store(now, std::memory_order_relaxed);
+        state.lastLevel.store(level, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    void Log::Write(Logger logger, LogLevel level, std::string_view message)
+    {
+        const auto& l = logger == Logger::Core ? s_CoreLogger : s_ClientLogger;
+
+        if (IsBinary())
         {
-            switch (severity)
             {
-            case nvrhi::MessageSeverity::Info:    HE_CORE_INFO("[DeviceManager] : {}", messageText); break;
-            case nvrhi::MessageSeverity::Warning: HE_CORE_WARN("[DeviceManager] : {}", messageText); break;
-            case nvrhi::MessageSeverity::Error:   HE_CORE_ERROR("[DeviceManager] : {}", messageText); break;
-            case nvrhi::MessageSeverity::Fatal:   HE_CORE_CRITICAL("[DeviceManager] : {}", messageText); break;
+                BinaryLogThreadBuffer& b = t_BinaryLogBuffer;
+                std::scoped_lock lock(b.mutex);
+                b.Begin(BinaryLogRecord::Text, logger, level);
+                b.Put(uint32_t(message.size()));
+                b.Put(message.data(), message.size());
+                b.End(level);
             }
+
+            // in binary mode the loggers carry only the console sink, problems stay visible there
+            if (level < LogLevel::Warn)
+                return;
         }
+
+        l->log(ToSpdlogLevel(level), spdlog::string_view_t(message.data(), message.size()));
     }
 
+#endif
+
     //////////////////////////////////////////////////////////////////////////
-    // Modules
+    // Profiler
     //////////////////////////////////////////////////////////////////////////
 
-    namespace Modules {
+    namespace Profiler {
 
-        ModulesContext::~ModulesContext()
+        constexpr uint32_t c_NodesPerBlock = 256;
+        constexpr uint32_t c_MaxBlocks = 256;
+        constexpr uint32_t c_MaxDepth = 128;
+
+        // one node per distinct call path, written only by the owning thread
+        struct Node
         {
-            HE_PROFILE_FUNCTION();
+            const ZoneDesc* zone = nullptr;
+            uint32_t parent = 0;
+            uint32_t depth = 0;
+            uint32_t firstChild = 0; // 0 is the root, which is never a child
+            uint32_t nextSibling = 0;
+            std::atomic<uint64_t> count = 0;
+            std::atomic<uint64_t> totalTicks = 0;
+            std::atomic<uint64_t> selfTicks = 0;
+        };
 
-            struct ModuleToShutdown
-            {
-                uint32_t LoadOrder;
-                ModuleHandle handle;
-            };
+        struct OpenZone
+        {
+            uint32_t node;
+            uint64_t start;
+            uint64_t childTicks;
+        };
 
-            if (modules.size() <= 0)
-                return;
+        struct ThreadProfile
+        {
+            std::string name;                                        // guarded by s_Mutex
+            std::array<std::unique_ptr<Node[]>, c_MaxBlocks> blocks; // nodes never move, readers only touch [0, nodeCount)
+            std::atomic<uint32_t> nodeCount = 0;
+            std::atomic<uint64_t> generation = 0;
+            OpenZone stack[c_MaxDepth];
+            uint32_t depth = 0;
+
+            Node& GetNode(uint32_t index) { return blocks[index / c_NodesPerBlock][index % c_NodesPerBlock]; }
+        };
 
-            std::vector<ModuleToShutdown> ModulesToShutdone;
-            ModulesToShutdone.reserve(modules.size());
-            for (auto& [handle, moduleData] : modules)
+        static std::mutex s_Mutex;
+        static std::vector<std::unique_ptr<ThreadProfile>> s_Threads; // kept after the thread exits so its stats survive
+        static std::atomic<bool> s_Enabled = false;
+        static std::atomic<uint64_t> s_Generation = 0;
+        static std::atomic<uint64_t> s_FrameCount = 0;
+        static std::atomic<uint64_t> s_CalibrationTicks = 0;
+        static std::atomic<uint64_t> s_CalibrationTime = 0;
+        static thread_local ThreadProfile* t_Profile = nullptr;
+
+        // the TSC is invariant on every x86_64 CPU we target, it is converted to time against the steady clock when read
+        static uint64_t ReadTicks()
+        {
+#if defined(_M_X64) || defined(__x86_64__)
+            return __rdtsc();
+#else
+            return Application::GetTimestamp();
+#endif
+        }
+
+        static double GetMsPerTick()
+        {
+#if defined(_M_X64) || defined(__x86_64__)
+            uint64_t ticks = ReadTicks() - s_CalibrationTicks;
+            uint64_t time = Application::GetTimestamp() - s_CalibrationTime;
+            return ticks ? double(time) / double(ticks) * 1e-6 : 0.0;
+#else
+            return 1e-6;
+#endif
+        }
+
+        static ThreadProfile& GetThreadProfile()
+        {
+            if (!t_Profile)
             {
-                ModulesToShutdone.emplace_back(moduleData->loadOrder, handle);
+                auto profile = std::make_unique<ThreadProfile>();
+                profile->blocks[0] = std::make_unique<Node[]>(c_NodesPerBlock);
+                profile->nodeCount = 1;
+                profile->generation = s_Generation.load();
+
+                std::scoped_lock lock(s_Mutex);
+                profile->name = std::format("Thread {}", s_Threads.size());
+                t_Profile = profile.get();
+                s_Threads.push_back(std::move(profile));
             }
 
-            std::sort(ModulesToShutdone.begin(), ModulesToShutdone.end(), [&](const ModuleToShutdown& a, const ModuleToShutdown& b) { return a.LoadOrder < b.LoadOrder; });
-            std::reverse(ModulesToShutdone.begin(), ModulesToShutdone.end());
+            return *t_Profile;
+        }
 
-            for (auto& ModuleToShutdone : ModulesToShutdone)
+        static uint32_t FindOrAddChild(ThreadProfile& t, uint32_t parent, const ZoneDesc* zone)
+        {
+            Node& p = t.GetNode(parent);
+            for (uint32_t child = p.firstChild; child != 0; child = t.GetNode(child).nextSibling)
             {
-                UnloadModule(ModuleToShutdone.handle);
+                if (t.GetNode(child).zone == zone)
+                    return child;
             }
+
+            uint32_t index = t.nodeCount.load(std::memory_order_relaxed);
+            if (index == c_NodesPerBlock * c_MaxBlocks)
+                return ~0u;
+
+            if (index % c_NodesPerBlock == 0)
+                t.blocks[index / c_NodesPerBlock] = std::make_unique<Node[]>(c_NodesPerBlock);
+
+            Node& n = t.GetNode(index);
+            n.zone = zone;
+            n.parent = parent;
+            n.depth = p.depth + 1;
+            n.nextSibling = p.firstChild;
+            p.firstChild = index;
+
+            t.nodeCount.store(index + 1, std::memory_order_release);
+
+            return index;
         }
 
-        bool LoadModule(const std::filesystem::path& filePath)
+        static void Accumulate(std::atomic<uint64_t>& counter, uint64_t value)
         {
-            HE_PROFILE_FUNCTION();
+            // single writer, a plain load/store pair is enough and avoids a locked instruction
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
 
-            if (!std::filesystem::exists(filePath))
+        bool BeginZone(const ZoneDesc* zone)
+        {
+            if (!s_Enabled.load(std::memory_order_relaxed))
+                return false;
+
+            ThreadProfile& t = GetThreadProfile();
+
+            // a reset is applied by the owning thread on its next zone, open zones stay on the stack and
+            // restart their clock so they only report time after the reset
+            uint64_t generation = s_Generation.load(std::memory_order_relaxed);
+            if (t.generation.load(std::memory_order_relaxed) != generation)
             {
-                HE_CORE_ERROR("LoadModule failed: File {} does not exist.", filePath.string());
+                uint32_t count = t.nodeCount.load(std::memory_order_relaxed);
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    Node& n = t.GetNode(i);
+                    n.count.store(0, std::memory_order_relaxed);
+                    n.totalTicks.store(0, std::memory_order_relaxed);
+                    n.selfTicks.store(0, std::memory_order_relaxed);
+                }
+
+                uint64_t now = ReadTicks();
+                for (uint32_t i = 0; i < t.depth; i++)
+                {
+                    t.stack[i].start = now;
+                    t.stack[i].childTicks = 0;
+                }
+
+                t.generation.store(generation, std::memory_order_relaxed);
+            }
+
+            if (t.depth == c_MaxDepth)
                 return false;
+
+            uint32_t parent = t.depth ? t.stack[t.depth - 1].node : 0;
+            uint32_t node = FindOrAddChild(t, parent, zone);
+            if (node == ~0u)
+                return false;
+
+            OpenZone& z = t.stack[t.depth++];
+            z.node = node;
+            z.childTicks = 0;
+            z.start = ReadTicks();
+
+            return true;
+        }
+
+        void EndZone()
+        {
+            uint64_t end = ReadTicks();
+
+            ThreadProfile& t = *t_Profile;
+            OpenZone& z = t.stack[--t.depth];
+            uint64_t elapsed = end - z.start;
+
+            Node& n = t.GetNode(z.node);
+            Accumulate(n.count, 1);
+            Accumulate(n.totalTicks, elapsed);
+            Accumulate(n.selfTicks, elapsed - std::min(z.childTicks, elapsed));
+
+            if (t.depth)
+                t.stack[t.depth - 1].childTicks += elapsed;
+        }
+
+        void SetEnabled(bool enabled)
+        {
+            if (enabled && s_CalibrationTicks == 0)
+            {
+                s_CalibrationTime = Application::GetTimestamp();
+                s_CalibrationTicks = ReadTicks();
             }
 
-            auto& c = GetAppContext().modulesContext;
+            s_Enabled = enabled;
+        }
 
-            Ref<ModuleData> newModule = CreateRef<ModuleData>(filePath);
-            ModuleHandle handle = Hash(filePath);
-            if (c.modules.contains(handle))
+        bool IsEnabled()
+        {
+            return s_Enabled;
+        }
+
+        void Reset()
+        {
+            s_Generation++;
+            s_FrameCount = 0;
+        }
+
+        void SetThreadName(const char* name)
+        {
+            ThreadProfile& t = GetThreadProfile();
+
+            std::scoped_lock lock(s_Mutex);
+            t.name = name;
+        }
+
+        void NewFrame()
+        {
+            if (s_Enabled.load(std::memory_order_relaxed))
+                s_FrameCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        uint64_t GetFrameCount()
+        {
+            return s_FrameCount;
+        }
+
+        std::vector<ThreadStats> GetStats()
+        {
+            double msPerTick = GetMsPerTick();
+            uint64_t generation = s_Generation;
+
+            std::scoped_lock lock(s_Mutex);
+
+            std::vector<ThreadStats> result;
+            for (auto& t : s_Threads)
             {
-                HE_CORE_WARN("Module {} has already been loaded.", newModule->name);
-                return false;
+                uint32_t count = t->nodeCount.load(std::memory_order_acquire);
+                if (count <= 1 || t->generation.load(std::memory_order_relaxed) != generation)
+                    continue;
+
+                ThreadStats& ts = result.emplace_back();
+                ts.name = t->name;
+                ts.zones.resize(count);
+
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    Node& n = t->GetNode(i);
+                    ZoneStats& z = ts.zones[i];
+                    z.zone = n.zone;
+                    z.parent = n.parent;
+                    z.depth = n.depth;
+                    z.count = n.count.load(std::memory_order_relaxed);
+                    z.totalMs = double(n.totalTicks.load(std::memory_order_relaxed)) * msPerTick;
+                    z.selfMs = double(n.selfTicks.load(std::memory_order_relaxed)) * msPerTick;
+
+                    if (n.depth == 1)
+                        ts.zones[0].totalMs += z.totalMs;
+                }
             }
 
-            if (newModule->lib.IsLoaded())
+            return result;
+        }
+
+        static void WriteJsonString(std::ostringstream& os, const char* str)
+        {
+            os << '"';
+            for (const char* c = str; c && *c; c++)
             {
-                auto func = newModule->lib.GetFunction<void()>("OnModuleLoaded");
-                if (func)
+                switch (*c)
                 {
-                    func();
-                    c.modules[handle] = newModule;
-                    return true;
+                case '"':  os << "\\\""; break;
+                case '\\': os << "\\\\"; break;
+                case '\n': os << "\\n"; break;
+                case '\t': os << "\\t"; break;
+                default:   os << *c; break;
                 }
             }
+            os << '"';
+        }
 
-            HE_CORE_ERROR("LoadModule failed: OnModuleLoaded function not found in module {}.", newModule->name);
-            return false;
+        static void WriteJsonZone(std::ostringstream& os, const ThreadStats& ts, const std::vector<std::vector<uint32_t>>& children, uint32_t index, int indent)
+        {
+            const ZoneStats& z = ts.zones[index];
+            std::string tabs(indent, '\t');
+
+            os << tabs << "{\n";
+            os << tabs << "\t\"name\" : "; WriteJsonString(os, z.zone->name); os << ",\n";
+            os << tabs << "\t\"function\" : "; WriteJsonString(os, z.zone->function); os << ",\n";
+            os << tabs << "\t\"file\" : "; WriteJsonString(os, z.zone->file); os << ",\n";
+            os << tabs << "\t\"line\" : " << z.zone->line << ",\n";
+            os << tabs << "\t\"count\" : " << z.count << ",\n";
+            os << tabs << "\t\"totalMs\" : " << z.totalMs << ",\n";
+            os << tabs << "\t\"selfMs\" : " << z.selfMs << ",\n";
+            os << tabs << "\t\"children\" : [";
+
+            for (size_t i = 0; i < children[index].size(); i++)
+            {
+                os << (i == 0 ? "\n" : ",\n");
+                WriteJsonZone(os, ts, children, children[index][i], indent + 2);
+            }
+
+            os << (children[index].empty() ? "]\n" : "\n" + tabs + "\t]\n");
+            os << tabs << "}";
         }
 
-        bool IsModuleLoaded(ModuleHandle handle)
+        std::string ToJson()
         {
-            HE_PROFILE_FUNCTION();
+            std::vector<ThreadStats> stats = GetStats();
 
-            auto& c = GetAppContext().modulesContext;
+            std::ostringstream os;
+            os << "{\n";
+            os << "\t\"frames\" : " << GetFrameCount() << ",\n";
+            os << "\t\"threads\" : [";
 
-            if (c.modules.contains(handle))
-                return true;
+            for (size_t t = 0; t < stats.size(); t++)
+            {
+                const ThreadStats& ts = stats[t];
 
-            return false;
+                std::vector<std::vector<uint32_t>> children(ts.zones.size());
+                for (uint32_t i = 1; i < ts.zones.size(); i++)
+                {
+                    if (ts.zones[i].count > 0)
+                        children[ts.zones[i].parent].push_back(i);
+                }
+
+                os << (t == 0 ? "\n" : ",\n");
+                os << "\t\t{\n";
+                os << "\t\t\t\"name\" : "; WriteJsonString(os, ts.name.c_str()); os << ",\n";
+                os << "\t\t\t\"totalMs\" : " << ts.zones[0].totalMs << ",\n";
+                os << "\t\t\t\"zones\" : [";
+
+                for (size_t i = 0; i < children[0].size(); i++)
+                {
+                    os << (i == 0 ? "\n" : ",\n");
+                    WriteJsonZone(os, ts, children, children[0][i], 4);
+                }
+
+                os << "\n\t\t\t]\n";
+                os << "\t\t}";
+            }
+
+            os << "\n\t]\n";
+            os << "}\n";
+
+            return os.str();
         }
 
-        bool UnloadModule(ModuleHandle handle)
+        bool DumpJson(const std::filesystem::path& filePath)
         {
-            HE_PROFILE_FUNCTION();
+            std::ofstream file(filePath);
+            if (!file.is_open())
+            {
+                HE_CORE_ERROR("Profiler::DumpJson : Unable to open file for writing, {}", filePath.string());
+                return false;
+            }
 
-            auto& c = GetAppContext().modulesContext;
+            file << ToJson();
+            return true;
+        }
+    }
 
-            auto it = c.modules.find(handle);
-            if (it == c.modules.end())
+    //////////////////////////////////////////////////////////////////////////
+    // Metrics
+    //////////////////////////////////////////////////////////////////////////
+
+    namespace Metrics {
+
+        enum class Type : uint8_t { Counter, Gauge, Histogram };
+
+        struct Entry
+        {
+            std::string name;
+            std::string help;
+            Type type;
+            std::unique_ptr<Counter> counter;
+            std::unique_ptr<Gauge> gauge;
+            std::unique_ptr<Histogram> histogram;
+        };
+
+        static std::mutex s_Mutex;
+        static std::vector<Entry> s_Metrics; // registration order is export order
+
+        static Entry* FindOrAdd(std::string_view name, std::string_view help, Type type)
+        {
+            for (auto& e : s_Metrics)
             {
-                HE_CORE_ERROR("UnloadModule failed: Module with handle {} not found.", handle);
-                return false;
+                if (e.name == name)
+                {
+                    if (e.type == type)
+                        return &e;
+
+                    HE_CORE_ERROR("Metrics : {} is already registered with a different type", name);
+                    return nullptr;
+                }
             }
 
-            Ref<ModuleData> moduleData = it->second;
+            Entry& e = s_Metrics.emplace_back();
+            e.name = name;
+            e.help = help;
+            e.type = type;
 
-            if (auto func = moduleData->lib.GetFunction<void()>("OnModuleShutdown"))
+            return &e;
+        }
+
+        Counter& GetCounter(std::string_view name, std::string_view help)
+        {
+            static Counter s_Invalid;
+
+            std::scoped_lock lock(s_Mutex);
+            Entry* e = FindOrAdd(name, help, Type::Counter);
+            if (!e)
+                return s_Invalid;
+
+            if (!e->counter)
+                e->counter = std::make_unique<Counter>();
+
+            return *e->counter;
+        }
+
+        Gauge& GetGauge(std::string_view name, std::string_view help)
+        {
+            static Gauge s_Invalid;
+
+            std::scoped_lock lock(s_Mutex);
+            Entry* e = FindOrAdd(name, help, Type::Gauge);
+            if (!e)
+                return s_Invalid;
+
+            if (!e->gauge)
+                e->gauge = std::make_unique<Gauge>();
+
+            return *e->gauge;
+        }
+
+        Histogram& GetHistogram(std::string_view name, std::span<const double> bounds, std::string_view help)
+        {
+            static Histogram s_Invalid;
+
+            std::scoped_lock lock(s_Mutex);
+            Entry* e = FindOrAdd(name, help, Type::Histogram);
+            if (!e)
+            {
+                if (!s_Invalid.buckets)
+                    s_Invalid.buckets = std::make_unique<std::atomic<uint64_t>[]>(1);
+                return s_Invalid;
+            }
+
+            if (!e->histogram)
+            {
+                e->histogram = std::make_unique<Histogram>();
+                e->histogram->bounds.assign(bounds.begin(), bounds.end());
+                std::sort(e->histogram->bounds.begin(), e->histogram->bounds.end());
+                e->histogram->buckets = std::make_unique<std::atomic<uint64_t>[]>(bounds.size() + 1);
+            }
+
+            return *e->histogram;
+        }
+
+        std::string Export(ExporterDesc::Format format)
+        {
+            bool openMetrics = format == ExporterDesc::Format::OpenMetrics;
+
+            std::string out;
+            auto it = std::back_inserter(out);
+
+            std::scoped_lock lock(s_Mutex);
+            for (auto& e : s_Metrics)
+            {
+                // OpenMetrics names the counter family without the _total suffix its sample carries
+                std::string_view family = e.name;
+                if (openMetrics && e.type == Type::Counter && family.ends_with("_total"))
+                    family.remove_suffix(6);
+
+                if (!e.help.empty())
+                    std::format_to(it, "# HELP {} {}\n", family, e.help);
+
+                switch (e.type)
+                {
+                case Type::Counter:
+                    std::format_to(it, "# TYPE {} counter\n", family);
+                    std::format_to(it, "{}{} {}\n", family, openMetrics ? "_total" : "", e.counter->value.load(std::memory_order_relaxed));
+                    break;
+
+                case Type::Gauge:
+                    std::format_to(it, "# TYPE {} gauge\n", family);
+                    std::format_to(it, "{} {}\n", family, e.gauge->value.load(std::memory_order_relaxed));
+                    break;
+
+                case Type::Histogram:
+                {
+                    const Histogram& h = *e.histogram;
+                    std::format_to(it, "# TYPE {} histogram\n", family);
+
+                    uint64_t cumulative = 0;
+                    for (size_t i = 0; i < h.bounds.size(); i++)
+                    {
+                        cumulative += h.buckets[i].load(std::memory_order_relaxed);
+                        std::format_to(it, "{}_bucket{{le=\"{}\"}} {}\n", family, h.bounds[i], cumulative);
+                    }
+
+                    cumulative += h.buckets[h.bounds.size()].load(std::memory_order_relaxed);
+                    std::format_to(it, "{}_bucket{{le=\"+Inf\"}} {}\n", family, cumulative);
+                    std::format_to(it, "{}_sum {}\n", family, h.sum.load(std::memory_order_relaxed));
+                    std::format_to(it, "{}_count {}\n", family, cumulative);
+                    break;
+                }
+                }
+            }
+
+            if (openMetrics)
+                out += "# EOF\n";
+
+            return out;
+        }
+
+        static void WriteMetricsFile(const ExporterDesc& desc)
+        {
+            HE_PROFILE_FUNCTION();
+
+            std::error_code ec;
+            auto numbered = [&](uint32_t i) { return i == 0 ? desc.filePath : std::filesystem::path(desc.filePath.string() + "." + std::to_string(i)); };
+
+            for (uint32_t i = desc.fileHistory; i > 0; i--)
+                std::filesystem::rename(numbered(i - 1), numbered(i), ec);
+
+            // written aside and renamed so a scraper never reads a partial file
+            std::filesystem::path tmp = desc.filePath.string() + ".tmp";
+            {
+                std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+                if (!file.is_open())
+                {
+                    HE_CORE_ERROR("Metrics : Unable to open file for writing, {}", tmp.string());
+                    return;
+                }
+
+                file << Export(desc.format);
+            }
+
+            std::filesystem::rename(tmp, desc.filePath, ec);
+            if (ec)
+                HE_CORE_ERROR("Metrics : Unable to write {}, {}", desc.filePath.string(), ec.message());
+        }
+
+        static void ServeMetrics(intptr_t client, ExporterDesc::Format format)
+        {
+            HE_PROFILE_FUNCTION();
+
+            // plain HTTP for scrapers that speak it over the socket, the raw exposition otherwise
+            char request[512];
+            int size = OS::ReadLocalSocket(client, request, sizeof(request), 100);
+            bool http = size >= 4 && std::string_view(request, 4) == "GET ";
+
+            std::string body = Export(format);
+            if (http)
+            {
+                const char* contentType = format == ExporterDesc::Format::OpenMetrics ? "application/openmetrics-text; version=1.0.0; charset=utf-8" : "text/plain; version=0.0.4; charset=utf-8";
+                std::string header = std::format("HTTP/1.0 200 OK\r\nContent-Type: {}\r\nContent-Length: {}\r\nConnection: close\r\n\r\n", contentType, body.size());
+                OS::WriteLocalSocket(client, header.data(), header.size());
+            }
+
+            OS::WriteLocalSocket(client, body.data(), body.size());
+            OS::CloseLocalSocket(client);
+        }
+
+        static void ExporterMain(Exporter* e)
+        {
+            Profiler::SetThreadName("Metrics Exporter");
+
+            const ExporterDesc& desc = e->desc;
+            auto interval = std::chrono::milliseconds(int64_t(std::max(desc.interval, 0.1f) * 1000.0f));
+
+            intptr_t listener = -1;
+            if (!desc.socketPath.empty())
+            {
+                listener = OS::CreateLocalSocket(desc.socketPath);
+                if (listener == -1)
+                    HE_CORE_ERROR("Metrics : Unable to listen on {}", desc.socketPath.string());
+            }
+
+            if (listener == -1 && desc.filePath.empty())
+                return;
+
+            auto nextExport = std::chrono::steady_clock::now();
+
+            std::unique_lock lock(e->mutex);
+            while (e->running)
+            {
+                if (!desc.filePath.empty() && std::chrono::steady_clock::now() >= nextExport)
+                {
+                    lock.unlock();
+                    WriteMetricsFile(desc);
+                    lock.lock();
+                    nextExport += interval;
+                }
+
+                if (listener != -1)
+                {
+                    // short accept timeout keeps Stop responsive without waking a second thread
+                    lock.unlock();
+                    intptr_t client = OS::AcceptLocalSocket(listener, 100);
+                    if (client != -1)
+                        ServeMetrics(client, desc.format);
+                    lock.lock();
+                }
+                else
+                {
+                    e->cv.wait_until(lock, nextExport, [e] { return !e->running; });
+                }
+            }
+
+            if (listener != -1)
+            {
+                OS::CloseLocalSocket(listener);
+                std::error_code ec;
+                std::filesystem::remove(desc.socketPath, ec);
+            }
+        }
+
+        void Start(Exporter& exporter, const ExporterDesc& desc)
+        {
+            Stop(exporter);
+
+            if (desc.filePath.empty() && desc.socketPath.empty())
+                return;
+
+            exporter.desc = desc;
+            exporter.running = true;
+            exporter.thread = std::thread(ExporterMain, &exporter);
+        }
+
+        void Stop(Exporter& exporter)
+        {
+            {
+                std::scoped_lock lock(exporter.mutex);
+                exporter.running = false;
+            }
+
+            exporter.cv.notify_all();
+            if (exporter.thread.joinable())
+                exporter.thread.join();
+        }
+
+        Exporter::~Exporter()
+        {
+            Stop(*this);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // AsyncIO
+    //////////////////////////////////////////////////////////////////////////
+
+    namespace FileSystem {
+
+        static bool LocateArchiveFile(const std::filesystem::path& filePath, uint64_t& size);
+        static bool ReadArchiveFile(const std::filesystem::path& filePath, uint64_t offset, void* data, uint64_t size);
+    }
+
+    namespace AsyncIO {
+
+        static uint32_t SizeClass(uint64_t size)
+        {
+            return (uint32_t)std::bit_width(std::max<uint64_t>(size, 4096) - 1);
+        }
+
+        static Buffer AcquireBuffer(Service& service, uint64_t size)
+        {
+            if (size == 0)
+                return {};
+
+            uint32_t sizeClass = SizeClass(size);
+
+            {
+                std::scoped_lock lock(service.poolMutex);
+
+                auto& blocks = service.pool[sizeClass];
+                if (!blocks.empty())
+                {
+                    uint8_t* data = blocks.back();
+                    blocks.pop_back();
+                    service.pooledBytes -= 1ull << sizeClass;
+                    return Buffer(data, size);
+                }
+            }
+
+            uint8_t* data = (uint8_t*)malloc(1ull << sizeClass);
+
+            std::scoped_lock lock(service.poolMutex);
+            service.poolBlocks.emplace(data, sizeClass);
+            return Buffer(data, size);
+        }
+
+        static void ReleaseBuffer(Service& service, Buffer buffer)
+        {
+            if (!buffer.data)
+                return;
+
+            std::scoped_lock lock(service.poolMutex);
+
+            // the size class comes from the allocation, a caller buffer of a similar size must never be recycled
+            auto block = service.poolBlocks.find(buffer.data);
+            if (block == service.poolBlocks.end())
+                return;
+
+            uint32_t sizeClass = block->second;
+            if (service.pooledBytes + (1ull << sizeClass) <= service.desc.bufferPoolSize)
+            {
+                service.pool[sizeClass].push_back(buffer.data);
+                service.pooledBytes += 1ull << sizeClass;
+                return;
+            }
+
+            service.poolBlocks.erase(block);
+            free(buffer.data);
+        }
+
+        static bool HasQueued(const Service& service)
+        {
+            for (const auto& queue : service.queues)
+            {
+                if (!queue.empty())
+                    return true;
+            }
+
+            return false;
+        }
+
+        static Service::Pending PopQueued(Service& service)
+        {
+            for (auto& queue : service.queues)
+            {
+                if (!queue.empty())
+                {
+                    Service::Pending pending = std::move(queue.front());
+                    queue.pop_front();
+                    return pending;
+                }
+            }
+
+            return {};
+        }
+
+        // resolves virtual paths, the transfer size and destination, false fails the request before it is issued
+        static bool Prepare(Service& service, Service::Pending& pending)
+        {
+            Request& request = pending.request;
+
+            uint64_t archiveSize = 0;
+            bool archive = FileSystem::IsVirtualPath(request.path) && FileSystem::LocateArchiveFile(request.path, archiveSize);
+            if (archive && pending.write)
+            {
+                HE_CORE_ERROR("AsyncIO : {} is inside a mounted archive, archives are read-only", request.path.string());
+                return false;
+            }
+
+            if (!archive && FileSystem::IsVirtualPath(request.path))
+                request.path = FileSystem::ResolvePath(request.path);
+
+            if (pending.write)
+            {
+                if (request.size == 0)
+                    request.size = request.buffer.size;
+
+                if (request.buffer.size < request.size)
+                {
+                    HE_CORE_ERROR("AsyncIO : Write of {} bytes to {} from a {} byte buffer", request.size, request.path.string(), request.buffer.size);
+                    return false;
+                }
+
+                return true;
+            }
+
+            if (request.size == 0)
+            {
+                std::error_code ec;
+                uint64_t fileSize = archive ? archiveSize : std::filesystem::file_size(request.path, ec);
+                if (ec || fileSize < request.offset)
+                {
+                    HE_CORE_ERROR("AsyncIO : Unable to read {}", request.path.string());
+                    return false;
+                }
+
+                request.size = fileSize - request.offset;
+            }
+
+            if (!request.buffer.data)
+            {
+                request.buffer = AcquireBuffer(service, request.size);
+                pending.pooled = true;
+            }
+            else if (request.buffer.size < request.size)
+            {
+                HE_CORE_ERROR("AsyncIO : Read of {} bytes from {} into a {} byte buffer", request.size, request.path.string(), request.buffer.size);
+                return false;
+            }
+
+            // archive entries are inflated here, there is nothing to hand to a worker or the ring
+            if (archive)
+            {
+                if (!FileSystem::ReadArchiveFile(request.path, request.offset, request.buffer.data, request.size))
+                {
+                    HE_CORE_ERROR("AsyncIO : Unable to inflate {}", request.path.string());
+                    return false;
+                }
+
+                pending.done = true;
+            }
+
+            return true;
+        }
+
+        static void Complete(Service& service, Service::Pending& pending, int64_t bytes)
+        {
+            Result result;
+            result.buffer = pending.request.buffer;
+            result.bytes = bytes > 0 ? uint64_t(bytes) : 0;
+            result.success = bytes >= 0 && uint64_t(bytes) == pending.request.size;
+
+            if (!result.success)
+            {
+                if (bytes < 0)
+                    HE_CORE_ERROR("AsyncIO : Unable to {} {}", pending.write ? "write" : "read", pending.request.path.string());
+
+                if (pending.pooled)
+                {
+                    ReleaseBuffer(service, result.buffer);
+                    result.buffer = {};
+                }
+            }
+
+            pending.promise.set_value(result);
+        }
+
+        static int64_t Execute(const Service::Pending& pending)
+        {
+            const Request& request = pending.request;
+
+            if (pending.write)
+            {
+                // in | out updates in place but never creates, appending creates the file without touching what is there
+                if (!request.truncate && !std::filesystem::exists(request.path))
+                    std::ofstream(request.path, std::ios::binary | std::ios::app);
+
+                std::fstream file(request.path, std::ios::binary | std::ios::out | (request.truncate ? std::ios::trunc : std::ios::in));
+                if (!file)
+                    return -1;
+
+                file.seekp(request.offset);
+                file.write((const char*)request.buffer.data, request.size);
+                return file ? int64_t(request.size) : -1;
+            }
+
+            std::ifstream file(request.path, std::ios::binary);
+            if (!file)
+                return -1;
+
+            file.seekg(request.offset);
+            file.read((char*)request.buffer.data, request.size);
+            return int64_t(file.gcount());
+        }
+
+        static void WorkerMain(Service* service)
+        {
+            Profiler::SetThreadName("AsyncIO Worker");
+
+            std::unique_lock lock(service->mutex);
+            while (true)
+            {
+                service->cv.wait(lock, [service] { return !service->running || HasQueued(*service); });
+                if (!HasQueued(*service))
+                    break;
+
+                Service::Pending pending = PopQueued(*service);
+                lock.unlock();
+
+                int64_t bytes = !Prepare(*service, pending) ? -1 : pending.done ? int64_t(pending.request.size) : Execute(pending);
+                Complete(*service, pending, bytes);
+
+                lock.lock();
+            }
+        }
+
+        // takes queued requests by priority while ring slots are free, so at most queueDepth are in flight
+        static void SubmitterMain(Service* service)
+        {
+            Profiler::SetThreadName("AsyncIO Submitter");
+
+            std::vector<uint32_t> batch;
+            std::vector<OS::IOOperation> operations;
+
+            std::unique_lock lock(service->mutex);
+            while (true)
+            {
+                service->cv.wait(lock, [service] {
+                    bool queued = HasQueued(*service);
+                    return (queued && !service->freeSlots.empty()) || (!queued && !service->running);
+                });
+
+                if (!HasQueued(*service))
+                    break;
+
+                batch.clear();
+                while (HasQueued(*service) && !service->freeSlots.empty())
+                {
+                    uint32_t slot = service->freeSlots.back();
+                    service->freeSlots.pop_back();
+                    service->slots[slot] = PopQueued(*service);
+                    batch.push_back(slot);
+                }
+
+                bool ringFailed = service->ringFailed;
+                lock.unlock();
+
+                operations.clear();
+                for (uint32_t slot : batch)
+                {
+                    Service::Pending& pending = *service->slots[slot];
+
+                    bool prepared = Prepare(*service, pending);
+                    bool issue = prepared && !pending.done && (pending.request.size > 0 || (pending.write && pending.request.truncate));
+                    if (issue && !ringFailed)
+                    {
+                        operations.push_back({
+                            .path = pending.request.path,
+                            .data = pending.request.buffer.data,
+                            .size = pending.request.size,
+                            .offset = pending.request.offset,
+                            .write = pending.write,
+                            .truncate = pending.write && pending.request.truncate,
+                            .slot = slot
+                        });
+                        continue;
+                    }
+
+                    // failed, empty or already read, nothing to issue, once the ring is gone the request runs here
+                    Complete(*service, pending, !prepared ? -1 : issue ? Execute(pending) : int64_t(pending.request.size));
+
+                    std::scoped_lock slotLock(service->mutex);
+                    service->slots[slot].reset();
+                    service->freeSlots.push_back(slot);
+                }
+
+                if (!operations.empty())
+                {
+                    // counted once the kernel has them, so the reaper never waits on an operation that was not submitted
+                    uint32_t submitted = OS::SubmitIORing(service->ring, operations);
+
+                    std::scoped_lock countLock(service->mutex);
+                    for (size_t i = 0; i < operations.size(); i++)
+                    {
+                        auto& pending = service->slots[operations[i].slot];
+                        if (!pending)
+                            continue; // already reaped
+
+                        if (i < submitted && !service->ringFailed)
+                        {
+                            pending->issued = true;
+                            continue;
+                        }
+
+                        Complete(*service, *pending, -1);
+                        pending.reset();
+                        service->freeSlots.push_back(operations[i].slot);
+                    }
+
+                    if (!service->ringFailed)
+                        service->inFlight += (int32_t)submitted;
+
+                    service->completionCV.notify_one();
+                }
+
+                lock.lock();
+            }
+
+            service->submitting = false;
+            lock.unlock();
+            service->completionCV.notify_one();
+        }
+
+        static void ReaperMain(Service* service)
+        {
+            Profiler::SetThreadName("AsyncIO Reaper");
+
+            std::array<OS::IOCompletion, 64> completions;
+
+            std::unique_lock lock(service->mutex);
+            while (true)
+            {
+                service->completionCV.wait(lock, [service] { return service->inFlight > 0 || !service->submitting; });
+                if (service->inFlight <= 0)
+                    break;
+
+                lock.unlock();
+
+                int32_t count = OS::WaitIORing(service->ring, completions);
+                for (int32_t i = 0; i < count; i++)
+                    Complete(*service, *service->slots[completions[i].slot], completions[i].result);
+
+                lock.lock();
+
+                if (count < 0)
+                {
+                    // nothing taken by the ring will complete, fail it and leave the queue to the submitter
+                    for (uint32_t slot = 0; slot < (uint32_t)service->slots.size(); slot++)
+                    {
+                        auto& pending = service->slots[slot];
+                        if (!pending || !pending->issued)
+                            continue;
+
+                        Complete(*service, *pending, -1);
+                        pending.reset();
+                        service->freeSlots.push_back(slot);
+                    }
+
+                    service->ringFailed = true;
+                    service->inFlight = 0;
+                    service->cv.notify_all();
+                    break;
+                }
+
+                for (int32_t i = 0; i < count; i++)
+                {
+                    service->slots[completions[i].slot].reset();
+                    service->freeSlots.push_back(completions[i].slot);
+                }
+
+                service->inFlight -= count;
+                service->cv.notify_all();
+            }
+        }
+
+        void Start(Service& service, const ServiceDesc& desc)
+        {
+            Stop(service);
+
+            service.desc = desc;
+            service.desc.queueDepth = std::max(desc.queueDepth, 1u);
+            service.running = true;
+
+            service.ring = OS::CreateIORing(service.desc.queueDepth);
+            if (service.ring != -1)
+            {
+                service.slots.resize(service.desc.queueDepth);
+                for (uint32_t slot = service.desc.queueDepth; slot > 0; slot--)
+                    service.freeSlots.push_back(slot - 1);
+
+                service.submitting = true;
+                service.threads.emplace_back(SubmitterMain, &service);
+                service.threads.emplace_back(ReaperMain, &service);
+            }
+            else
+            {
+                uint32_t threadCount = std::clamp(desc.threads, 1u, service.desc.queueDepth);
+                for (uint32_t i = 0; i < threadCount; i++)
+                    service.threads.emplace_back(WorkerMain, &service);
+            }
+        }
+
+        void Stop(Service& service)
+        {
+            {
+                std::scoped_lock lock(service.mutex);
+                service.running = false;
+            }
+
+            // the submitter is joined before the reaper, which drains the ring once submitting ends
+            service.cv.notify_all();
+            for (std::thread& thread : service.threads)
+            {
+                if (thread.joinable())
+                    thread.join();
+            }
+            service.threads.clear();
+
+            if (service.ring != -1)
+            {
+                OS::CloseIORing(service.ring);
+                service.ring = -1;
+            }
+
+            service.slots.clear();
+            service.freeSlots.clear();
+            service.inFlight = 0;
+            service.ringFailed = false;
+
+            // blocks still handed out stay registered, releasing them later frees or pools them as usual
+            std::scoped_lock lock(service.poolMutex);
+            for (auto& blocks : service.pool)
+            {
+                for (uint8_t* data : blocks)
+                {
+                    service.poolBlocks.erase(data);
+                    free(data);
+                }
+                blocks.clear();
+            }
+            service.pooledBytes = 0;
+        }
+
+        Service::~Service()
+        {
+            Stop(*this);
+        }
+
+        static std::vector<std::future<Result>> Enqueue(std::span<const Request> requests, bool write)
+        {
+            HE_PROFILE_FUNCTION();
+
+            Service& service = GetAppContext().ioService;
+
+            std::vector<std::future<Result>> futures;
+            futures.reserve(requests.size());
+
+            {
+                std::scoped_lock lock(service.mutex);
+
+                for (const Request& request : requests)
+                {
+                    Service::Pending pending;
+                    pending.request = request;
+                    pending.write = write;
+                    futures.push_back(pending.promise.get_future());
+
+                    if (!service.running)
+                    {
+                        HE_CORE_ERROR("AsyncIO : Service is not running, {} of {} failed", write ? "write" : "read", request.path.string());
+                        pending.promise.set_value({});
+                        continue;
+                    }
+
+                    size_t priority = std::min((size_t)request.priority, (size_t)Priority::Low);
+                    service.queues[priority].push_back(std::move(pending));
+                }
+            }
+
+            service.cv.notify_all();
+
+            return futures;
+        }
+
+        std::future<Result> Read(const Request& request) { return std::move(Enqueue({ &request, 1 }, false).front()); }
+        std::future<Result> Write(const Request& request) { return std::move(Enqueue({ &request, 1 }, true).front()); }
+        std::vector<std::future<Result>> Read(std::span<const Request> requests) { return Enqueue(requests, false); }
+        std::vector<std::future<Result>> Write(std::span<const Request> requests) { return Enqueue(requests, true); }
+        Buffer AcquireBuffer(uint64_t size) { return AcquireBuffer(GetAppContext().ioService, size); }
+        void ReleaseBuffer(Buffer buffer) { ReleaseBuffer(GetAppContext().ioService, buffer); }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Layer Stack
+    //////////////////////////////////////////////////////////////////////////
+
+    // typeid names are mangled on GCC and Clang and carry a "class " prefix on MSVC, each type is cleaned up once.
+    // Keyed by a copy of the raw name, a type_info may live in a plugin module that is unloaded or reloaded.
+    const char* Layer::GetName() const
+    {
+        static std::mutex s_Mutex;
+        static std::unordered_map<std::string, std::string> s_Names;
+
+        const char* name = typeid(*this).name();
+
+        std::scoped_lock lock(s_Mutex);
+
+        auto [it, inserted] = s_Names.try_emplace(name);
+        if (inserted)
+        {
+#if !defined(_MSC_VER)
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+            it->second = status == 0 && demangled ? demangled : name;
+            free(demangled);
+#else
+            std::string_view view = name;
+            for (std::string_view prefix : { "class ", "struct " })
+            {
+                if (view.starts_with(prefix))
+                    view.remove_prefix(prefix.size());
+            }
+            it->second = view;
+#endif
+        }
+
+        return it->second.c_str();
+    }
+
+    LayerStack::~LayerStack()
+    {
+        for (Layer* layer : m_Layers)
+        {
+            layer->OnDetach();
+            delete layer;
+            layer = nullptr;
+        }
+    }
+
+    void LayerStack::PushLayer(Layer* layer)
+    {
+        HE_CORE_ASSERT(layer);
+
+        m_Layers.emplace(m_Layers.begin() + m_LayerInsertIndex, layer);
+        m_LayerInsertIndex++;
+        m_EventBus.SubscribeCatchAll(layer);
+        layer->OnAttach();
+    }
+
+    void LayerStack::PushOverlay(Layer* overlay)
+    {
+        HE_CORE_ASSERT(overlay);
+
+        m_Layers.emplace_back(overlay);
+        m_EventBus.SubscribeCatchAll(overlay);
+        overlay->OnAttach();
+    }
+
+    void LayerStack::PopLayer(Layer* layer)
+    {
+        HE_CORE_ASSERT(layer);
+
+        auto it = std::find(m_Layers.begin(), m_Layers.begin() + m_LayerInsertIndex, layer);
+        if (it != m_Layers.begin() + m_LayerInsertIndex)
+        {
+            layer->OnDetach();
+            m_EventBus.Unsubscribe(layer);
+            m_Layers.erase(it);
+            m_LayerInsertIndex--;
+        }
+    }
+
+    void LayerStack::PopOverlay(Layer* overlay)
+    {
+        HE_CORE_ASSERT(overlay)
+
+            auto it = std::find(m_Layers.begin() + m_LayerInsertIndex, m_Layers.end(), overlay);
+        if (it != m_Layers.end())
+        {
+            overlay->OnDetach();
+            m_EventBus.Unsubscribe(overlay);
+            m_Layers.erase(it);
+        }
+    }
+
+    void LayerStack::Dispatch(Event& event)
+    {
+        HE_PROFILE_FUNCTION();
+
+        if (m_EventBus.dirty && m_EventBus.dispatchDepth == 0)
+            m_EventBus.Sort(m_Layers);
+
+        m_EventBus.Dispatch(event);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Event Bus
+    //////////////////////////////////////////////////////////////////////////
+
+    void EventBus::Subscribe(Layer* layer, EventType type, const Handler& handler)
+    {
+        HE_CORE_ASSERT(layer && type != EventType::None);
+
+        // an explicit subscription replaces the Layer::OnEvent catch-all entry
+        for (auto& list : handlers)
+            for (auto& sub : list)
+                if (sub.layer == layer && sub.catchAll)
+                    sub.layer = nullptr;
+
+        std::erase_if(pending, [layer](const auto& p) { return p.second.layer == layer && p.second.catchAll; });
+
+        pending.push_back({ type, { layer, handler, false } });
+        dirty = true;
+    }
+
+    void EventBus::Subscribe(Layer* layer, EventCategory category, const Handler& handler)
+    {
+        for (size_t i = 0; i < size_t(EventType::None); i++)
+            if (GetEventCategory(EventType(i)) == category)
+                Subscribe(layer, EventType(i), handler);
+    }
+
+    void EventBus::SubscribeCatchAll(Layer* layer)
+    {
+        HE_CORE_ASSERT(layer);
+
+        Handler handler = [layer](Event& e) { layer->OnEvent(e); return e.handled; };
+        for (size_t i = 0; i < size_t(EventType::None); i++)
+            pending.push_back({ EventType(i), { layer, handler, true } });
+
+        dirty = true;
+    }
+
+    void EventBus::Unsubscribe(Layer* layer)
+    {
+        // entries are only marked here and removed by Sort, a handler may pop its own layer while being dispatched
+        for (auto& list : handlers)
+            for (auto& sub : list)
+                if (sub.layer == layer)
+                    sub.layer = nullptr;
+
+        std::erase_if(pending, [layer](const auto& p) { return p.second.layer == layer; });
+        dirty = true;
+    }
+
+    void EventBus::Sort(const std::vector<Layer*>& layers)
+    {
+        HE_PROFILE_FUNCTION();
+
+        // overlays (back of the stack) receive events first
+        std::unordered_map<Layer*, size_t> order;
+        for (size_t i = 0; i < layers.size(); i++)
+            order[layers[i]] = layers.size() - 1 - i;
+
+        // a layer may subscribe before it is pushed, its entries wait here until it is on the stack
+        std::vector<std::pair<EventType, Subscription>> waiting;
+        for (auto& [type, sub] : pending)
+        {
+            if (order.contains(sub.layer))
+                handlers[size_t(type)].push_back(std::move(sub));
+            else
+                waiting.push_back({ type, std::move(sub) });
+        }
+        pending = std::move(waiting);
+
+        auto rank = [&order](Layer* layer) {
+            auto it = order.find(layer);
+            return it != order.end() ? it->second : order.size();
+        };
+
+        for (auto& list : handlers)
+        {
+            // layers that left the stack without unsubscribing are dropped rather than dispatched to
+            std::erase_if(list, [&order](const Subscription& sub) { return sub.layer == nullptr || !order.contains(sub.layer); });
+            std::stable_sort(list.begin(), list.end(), [&rank](const Subscription& a, const Subscription& b) {
+                return rank(a.layer) < rank(b.layer);
+            });
+        }
+
+        dirty = false;
+    }
+
+    void EventBus::Dispatch(Event& event)
+    {
+        EventType type = event.GetEventType();
+        if (type == EventType::None)
+            return;
+
+        dispatchDepth++;
+
+        auto& list = handlers[size_t(type)];
+        for (size_t i = 0; i < list.size() && !event.handled; i++)
+        {
+            if (list[i].layer)
+                event.handled |= list[i].handler(event);
+        }
+
+        dispatchDepth--;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Application
+    //////////////////////////////////////////////////////////////////////////
+
+    ApplicationContext& GetAppContext() { return *ApplicationContext::s_Instance; }
+
+    namespace Application {
+
+        void Restart() { GetAppContext().running = false; }
+        void Shutdown() { GetAppContext().running = false;  GetAppContext().s_ApplicationRunning = false; }
+        bool IsApplicationRunning() { return GetAppContext().s_ApplicationRunning; }
+        void PushLayer(Layer* overlay) { GetAppContext().layerStack.PushLayer(overlay); }
+        void PushOverlay(Layer* layer) { GetAppContext().layerStack.PushOverlay(layer); }
+        void PopLayer(Layer* layer) { GetAppContext().layerStack.PopLayer(layer); }
+        void PopOverlay(Layer* overlay) { GetAppContext().layerStack.PopOverlay(overlay); }
+        const Stats& GetStats() { return GetAppContext().appStats; }
+        const std::vector<FrameTiming>& GetFrameHistory() { return GetAppContext().frameHistory; }
+        const ApplicationDesc& GetApplicationDesc() { return GetAppContext().applicatoinDesc; }
+        float GetAverageFrameTimeSeconds() { return GetAppContext().averageFrameTime; }
+        float GetLastFrameTimestamp() { return GetAppContext().lastFrameTime; }
+        void  SetFrameTimeUpdateInterval(float seconds) { GetAppContext().averageTimeUpdateInterval = seconds; }
+        Window& GetWindow() { return  GetAppContext().mainWindow; }
+        void SubscribeEvent(Layer* layer, EventType type, const EventBus::Handler& handler) { GetAppContext().layerStack.GetEventBus().Subscribe(layer, type, handler); }
+        void SubscribeEvent(Layer* layer, EventCategory category, const EventBus::Handler& handler) { GetAppContext().layerStack.GetEventBus().Subscribe(layer, category, handler); }
+        void UnsubscribeEvents(Layer* layer) { GetAppContext().layerStack.GetEventBus().Unsubscribe(layer); }
+    }
+
+    void OnEvent(Event& e)
+    {
+        HE_PROFILE_FUNCTION();
+
+        auto& c = GetAppContext();
+
+        DispatchEvent<WindowCloseEvent>(e, [](WindowCloseEvent& e) {
+
+            Application::Shutdown();
+            return true;
+            });
+
+        c.layerStack.Dispatch(e);
+    }
+
+    static void EvaluateKeyBindings(ApplicationContext& c);
+    namespace Plugins { static void ReloadChangedModules(PluginContext& ctx); static void UnloadIdleModules(PluginContext& ctx); }
+
+    static constexpr size_t c_MaxLatencySamples = 256;
+    static constexpr uint64_t c_MaxPendingPresents = 16;
+
+    static void AddLatencySample(ApplicationContext& c, uint64_t inputTimestamp, uint64_t presentTime)
+    {
+        float ms = presentTime > inputTimestamp ? float(presentTime - inputTimestamp) * 1e-6f : 0.0f;
+
+        if (c.latencySamples.size() < c_MaxLatencySamples)
+            c.latencySamples.push_back(ms);
+        else
+            c.latencySamples[c.latencySampleCursor] = ms;
+
+        c.latencySampleCursor = (c.latencySampleCursor + 1) % c_MaxLatencySamples;
+    }
+
+    static void ResolveInputLatency(ApplicationContext& c, SwapChain* sc)
+    {
+        HE_PROFILE_FUNCTION();
+
+        if (c.pendingLatency.empty())
+            return;
+
+        std::vector<PresentTiming> timings;
+        bool hasDisplayTiming = sc->GetPastPresentTimings(timings);
+
+        for (const auto& timing : timings)
+        {
+            // Vulkan present ids are 32 bit
+            std::erase_if(c.pendingLatency, [&](const ApplicationContext::PendingLatency& p) {
+                if (uint32_t(p.presentId) != uint32_t(timing.presentId))
+                    return false;
+
+                AddLatencySample(c, p.inputTimestamp, timing.presentTime);
+                return true;
+            });
+        }
+
+        // without display timing, or when the driver never reports a present, use the time Present returned
+        std::erase_if(c.pendingLatency, [&](const ApplicationContext::PendingLatency& p) {
+            if (hasDisplayTiming && sc->presentCount - p.presentId < c_MaxPendingPresents)
+                return false;
+
+            AddLatencySample(c, p.inputTimestamp, p.cpuPresentTime);
+            return true;
+        });
+    }
+
+    static LatencyStats ComputeLatencyStats(const std::vector<float>& samples)
+    {
+        LatencyStats stats;
+        if (samples.empty())
+            return stats;
+
+        std::vector<float> sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+
+        auto percentile = [&sorted](float p) { return sorted[std::min(size_t(p * (sorted.size() - 1) + 0.5f), sorted.size() - 1)]; };
+
+        float sum = 0.0f;
+        for (float v : sorted)
+            sum += v;
+
+        stats.min = sorted.front();
+        stats.max = sorted.back();
+        stats.avg = sum / sorted.size();
+        stats.p50 = percentile(0.50f);
+        stats.p95 = percentile(0.95f);
+        stats.p99 = percentile(0.99f);
+        stats.sampleCount = uint32_t(sorted.size());
+
+        return stats;
+    }
+
+    void ApplicationContext::Run()
+    {
+        // no scope around the loop itself, a zone only reports once it closes
+        static constexpr double c_FrameTimeBounds[] = { 1.0, 2.0, 4.0, 8.0, 16.7, 33.3, 50.0, 100.0, 250.0 };
+        Metrics::Histogram& frameTimeMetric = Metrics::GetHistogram("he_frame_time_ms", c_FrameTimeBounds, "Main loop frame time in milliseconds");
+        Metrics::Counter& framesMetric = Metrics::GetCounter("he_frames_total", "Frames run by the main loop");
+        Metrics::Gauge& mainThreadQueueMetric = Metrics::GetGauge("he_main_thread_queue_depth", "Jobs waiting in the main thread queue");
+        Metrics::Gauge& layersMetric = Metrics::GetGauge("he_layers", "Layers and overlays in the layer stack");
+        Metrics::Gauge& modulesMetric = Metrics::GetGauge("he_modules_loaded", "Loaded modules");
+        Metrics::Gauge& pluginsMetric = Metrics::GetGauge("he_plugins", "Known plugins");
+        Metrics::Gauge& inputLatencyMetric = Metrics::GetGauge("he_input_latency_p95_ms", "95th percentile input to present latency in milliseconds");
+
+        while (running)
+        {
+            HE_PROFILE_FRAME();
+            Profiler::NewFrame();
+            HE_PROFILE_SCOPE("Core Loop");
+
+            frameIndex++;
+
+            float time = Application::GetTime();
+            Timestep frameTime = time - lastFrameTime; // measured, feeds the stats even when layers step at a fixed rate
+            Timestep timestep = applicatoinDesc.fixedTimestep > 0.0f ? Timestep(applicatoinDesc.fixedTimestep) : frameTime;
+            lastFrameTime = time;
+
+            blockingEventsUntilNextFrame = false;
+            EvaluateKeyBindings(*this);
+
+            {
+                HE_PROFILE_SCOPE_NC("ExecuteMainThreadQueue", 0xAA0000);
+
+                std::scoped_lock<std::mutex> lock(mainThreadQueueMutex);
+                size_t count = std::min(mainThreadMaxJobsPerFrame, (uint32_t)mainThreadQueue.size());
+                for (size_t i = 0; i < count; i++)
+                {
+                    mainThreadQueue.front()();
+                    mainThreadQueue.pop();
+                }
+
+                mainThreadQueueMetric.Set(double(mainThreadQueue.size()));
+            }
+
+            if (pluginContext.reloadPending)
+                Plugins::ReloadChangedModules(pluginContext);
+
+            Plugins::UnloadIdleModules(pluginContext);
+
+            bool headlessDevice = applicatoinDesc.deviceDesc.headlessDevice;
+
+            if (!mainWindow.IsMinimized())
+            {
+                nvrhi::IFramebuffer* framebuffer = nullptr;
+                if (!headlessDevice)
+                {
+                    auto sc = GetAppContext().mainWindow.swapChain;
+
+                    if (sc)
+                    {
+                        sc->UpdateSize();
+                        if (sc->BeginFrame())
+                        {
+                            framebuffer = sc->GetCurrentFramebuffer();
+                        }
+                    }
+                }
+
+                InputSnapshotHandle input = Input::GetSnapshot();
+                FrameInfo info = { timestep, framebuffer, input->latestInputTimestamp, std::move(input) };
+
+                GPUProfiler::BeginFrame(*this);
+
+                {
+                    HE_PROFILE_SCOPE("LayerStack OnBegin");
+                    for (Layer* layer : layerStack)
+                        layer->OnBegin(info);
+                }
+
+                {
+                    HE_PROFILE_SCOPE("LayerStack OnUpdate");
+                    for (Layer* layer : layerStack)
+                    {
+                        GPUProfiler::LayerBracket(*this, layer);
+                        layer->OnUpdate(info);
+                    }
+                    GPUProfiler::LayerBracket(*this, nullptr);
+                }
+
+                {
+                    HE_PROFILE_SCOPE("LayerStack OnEnd");
+                    for (Layer* layer : layerStack)
+                        layer->OnEnd(info);
+                }
+
+                GPUProfiler::EndFrame(*this);
+
+                if (!headlessDevice)
+                {
+                    auto sc = GetAppContext().mainWindow.swapChain;
+                    if (sc)
+                    {
+                        sc->presentCount++;
+                        sc->Present();
+
+                        if (info.inputTimestamp)
+                            pendingLatency.push_back({ sc->presentCount, info.inputTimestamp, Application::GetTimestamp() });
+
+                        ResolveInputLatency(*this, sc);
+                    }
+                }
+            }
+            else
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+
+            mainWindow.UpdateEvent();
+
+            // time
+            {
+                frameTimeSum += frameTime;
+                numberOfAccumulatedFrames += 1;
+
+                frameTimeMetric.Observe(frameTime.Milliseconds());
+                frameHistory[frameIndex % frameHistory.size()] = { frameIndex, frameTime.Milliseconds(), 0.0f };
+                framesMetric.Increment();
+
+                if (frameTimeSum > averageTimeUpdateInterval && numberOfAccumulatedFrames > 0)
+                {
+                    averageFrameTime = frameTimeSum / numberOfAccumulatedFrames;
+                    numberOfAccumulatedFrames = 0;
+                    frameTimeSum = 0.0f;
+
+                    appStats.inputLatency = ComputeLatencyStats(latencySamples);
+
+                    layersMetric.Set(double(std::distance(layerStack.begin(), layerStack.end())));
+                    modulesMetric.Set(double(modulesContext.modules.size()));
+                    pluginsMetric.Set(double(pluginContext.plugins.size()));
+                    inputLatencyMetric.Set(appStats.inputLatency.p95);
+
+#ifdef HE_ENABLE_LOGGING
+                    Log::FlushSuppressed();
+#endif
+                }
+
+                appStats.CPUMainTime = averageFrameTime * 1e3f;
+                appStats.FPS = (averageFrameTime > 0.0f) ? int(1.0f / averageFrameTime) : 0;
+            }
+
+            HE_PROFILE_FRAME();
+        }
+    }
+
+    ApplicationContext::ApplicationContext(const ApplicationDesc& desc)
+        : applicatoinDesc(desc)
+        , executor(desc.workersNumber)
+    {
+        HE_PROFILE_FUNCTION();
+
+#ifdef HE_ENABLE_LOGGING
+        Log::Init(desc.logFile, desc.logDesc);
+#endif
+
+        Profiler::SetThreadName("Main");
+        Profiler::SetEnabled(desc.enableProfiler);
+        gpuProfiler.enabled = desc.enableGPUProfiler;
+        pluginContext.hotReload = desc.hotReloadPlugins;
+        pluginContext.idleUnloadTime = desc.moduleIdleUnloadTime;
+        modulesContext.lazyBinding = desc.lazyModuleBinding;
+        modulesContext.slowLoadWarningTime = desc.slowModuleWarningTime;
+        pluginContext.loadReportFile = desc.loadReportFile;
+        pluginContext.parallelOpen = desc.parallelModuleOpen;
+        Metrics::Start(metricsExporter, desc.metricsDesc);
+        AsyncIO::Start(ioService, desc.ioDesc);
+
+        HE_CORE_INFO("Creat Application [{}]", applicatoinDesc.windowDesc.title);
+
+        s_Instance = this;
+
+        auto commandLineArgs = applicatoinDesc.commandLineArgs;
+        if (commandLineArgs.count > 1)
+        {
+            HE_INFO("CommandLineArgs : ");
+            for (int i = 0; i < commandLineArgs.count; i++)
+            {
+                HE_INFO("- [{}] : {}", i, commandLineArgs[i]);
+            }
+        }
+
+        if (!applicatoinDesc.workingDirectory.empty())
+            std::filesystem::current_path(applicatoinDesc.workingDirectory);
+
+        if (!applicatoinDesc.deviceDesc.headlessDevice)
+            mainWindow.Init(applicatoinDesc.windowDesc);
+
+        mainWindow.eventCallback = OnEvent;
+
+        if (!applicatoinDesc.inputReplayFile.empty())
+            Input::StartReplay(applicatoinDesc.inputReplayFile);
+        else if (!applicatoinDesc.inputRecordFile.empty())
+            Input::StartRecording(applicatoinDesc.inputRecordFile);
+
+        if (applicatoinDesc.createDefaultDevice)
+            RHI::TryCreateDefaultDevice();
+
+        if (!applicatoinDesc.deviceDesc.headlessDevice)
+        {
+            mainWindow.swapChain = RHI::GetDeviceManager()->CreateSwapChain(mainWindow.desc.swapChainDesc, mainWindow.handle);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Jops
+    //////////////////////////////////////////////////////////////////////////
+
+    namespace Jops {
+
+        std::future<void> SubmitTask(const std::function<void()>& function) { return GetAppContext().executor.async(function); }
+        
+        Future RunTaskflow(Taskflow& taskflow) { return GetAppContext().executor.run(taskflow); }
+
+        // a worker blocked on a future holds its thread, with every worker waiting like that the taskflow never runs
+        void RunTaskflowAndWait(Taskflow& taskflow)
+        {
+            Executor& executor = GetAppContext().executor;
+            if (executor.this_worker_id() >= 0)
+                executor.corun(taskflow);
+            else
+                executor.run(taskflow).wait();
+        }
+        
+        void WaitForAll() { GetAppContext().executor.wait_for_all(); }
+       
+        void SetMainThreadMaxJobsPerFrame(uint32_t max) { GetAppContext().mainThreadMaxJobsPerFrame = max; }
+
+        void SubmitToMainThread(const std::function<void()>& function)
+        {
+            auto& c = GetAppContext();
+            std::scoped_lock<std::mutex> lock(c.mainThreadQueueMutex);
+            c.mainThreadQueue.push(function);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // SwapChain
+    //////////////////////////////////////////////////////////////////////////
+
+    void SwapChain::ResetBackBuffers()
+    {
+        HE_PROFILE_FUNCTION();
+
+        swapChainFramebuffers.clear();
+    }
+
+    void SwapChain::ResizeBackBuffers()
+    {
+        HE_PROFILE_FUNCTION();
+
+        uint32_t backBufferCount = GetBackBufferCount();
+        swapChainFramebuffers.resize(backBufferCount);
+        for (uint32_t index = 0; index < backBufferCount; index++)
+        {
+            nvrhi::ITexture* texture = GetBackBuffer(index);
+            nvrhi::FramebufferDesc& desc = nvrhi::FramebufferDesc().addColorAttachment(texture);
+            swapChainFramebuffers[index] = nvrhiDevice->createFramebuffer(desc);
+        }
+    }
+
+    void SwapChain::UpdateSize()
+    {
+        HE_PROFILE_FUNCTION();
+
+        int height, width;
+        glfwGetWindowSize((GLFWwindow*)windowHandle, &width, &height);
+        if (width == 0 || height == 0)
+            return;
+
+        if (int(desc.backBufferWidth) != width || int(desc.backBufferHeight) != height || (desc.vsync != isVSync && nvrhiDevice->getGraphicsAPI() == nvrhi::GraphicsAPI::VULKAN))
+        {
+            isVSync = desc.vsync;
+
+            ResizeSwapChain(width, height);
+        }
+    }
+
+    nvrhi::IFramebuffer* SwapChain::GetCurrentFramebuffer()
+    {
+        return GetFramebuffer(GetCurrentBackBufferIndex());
+    }
+
+    nvrhi::IFramebuffer* SwapChain::GetFramebuffer(uint32_t index)
+    {
+        if (index < swapChainFramebuffers.size())
+            return swapChainFramebuffers[index];
+
+        return nullptr;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // RHI
+    //////////////////////////////////////////////////////////////////////////
+    
+    namespace RHI {
+
+        DeviceContext::~DeviceContext()
+        {
+            HE_PROFILE_FUNCTION();
+
+            for (auto dm : GetAppContext().deviceContext.managers)
+            {
+                if (dm)
+                {
+                    dm->GetDevice()->waitForIdle();
+                    delete dm;
+                }
+            }
+        }
+
+        DeviceManager* CreateDeviceManager(const DeviceDesc& desc)
+        {
+            HE_PROFILE_FUNCTION();
+
+            auto& c = GetAppContext();
+            auto& managers = c.deviceContext.managers;
+
+            DeviceManager* dm = nullptr;
+
+            for (size_t i = 0; i < desc.api.size(); i++)
+            {
+                auto api = desc.api[i];
+
+                if (api == nvrhi::GraphicsAPI(-1))
+                    continue;
+
+                HE_CORE_INFO("Trying to create backend API: {}", nvrhi::utils::GraphicsAPIToString(api));
+
+                switch (api)
+                {
+#if NVRHI_HAS_D3D11
+                case nvrhi::GraphicsAPI::D3D11:  dm = CreateD3D11(); break;
+#endif
+#if NVRHI_HAS_D3D12
+                case nvrhi::GraphicsAPI::D3D12:  dm = CreateD3D12(); break;
+#endif
+#if NVRHI_HAS_VULKAN
+                case nvrhi::GraphicsAPI::VULKAN: dm = CreateVULKAN(); break;
+#endif
+                }
+
+                if (dm)
+                {
+                    if (dm->CreateDevice(desc))
+                    {
+                        managers.push_back(dm);
+                        break;
+                    }
+
+                    delete dm;
+                }
+
+                HE_CORE_ERROR("Failed to create backend API: {}", nvrhi::utils::GraphicsAPIToString(api));
+            }
+
+            return dm;
+        }
+
+        DeviceManager* GetDeviceManager(uint32_t index)
+        {
+            auto& managers = GetAppContext().deviceContext.managers;
+
+            if (index < managers.size() && managers.size() >= 1)
+                return managers[index];
+
+            return nullptr;
+        }
+
+        nvrhi::DeviceHandle GetDevice(uint32_t index)
+        {
+            auto& managers = GetAppContext().deviceContext.managers;
+
+            if (index < managers.size() && managers.size() >= 1)
+                return managers[index]->GetDevice();
+
+            return {};
+        }
+
+        void TryCreateDefaultDevice()
+        {
+            HE_PROFILE_FUNCTION();
+
+            auto& c = GetAppContext();
+
+            auto deviceDesc = c.applicatoinDesc.deviceDesc;
+            size_t apiCount = deviceDesc.api.size();
+
+            if (deviceDesc.api[0] == nvrhi::GraphicsAPI(-1))
+            {
+#ifdef HE_PLATFORM_WINDOWS
+                deviceDesc.api = {
+            #if NVRHI_HAS_D3D11
+                    nvrhi::GraphicsAPI::D3D11,
+            #endif
+            #if NVRHI_HAS_D3D12
+                    nvrhi::GraphicsAPI::D3D12,
+            #endif
+            #if NVRHI_HAS_VULKAN
+                    nvrhi::GraphicsAPI::VULKAN
+            #endif
+                };
+#else
+                deviceDesc.api = { nvrhi::GraphicsAPI::VULKAN };
+#endif
+                apiCount = deviceDesc.api.size();
+            }
+
+            DeviceManager* dm = CreateDeviceManager(deviceDesc);
+
+            if (!dm)
+            {
+                HE_CORE_CRITICAL("No graphics backend could be initialized!");
+                std::exit(1);
+            }
+        }
+
+        nvrhi::ShaderHandle CreateStaticShader(nvrhi::IDevice* device, StaticShader staticShader, const std::vector<ShaderMacro>* pDefines, const nvrhi::ShaderDesc& desc)
+        {
+            HE_PROFILE_FUNCTION();
+
+            nvrhi::ShaderHandle shader;
+
+            Buffer buffer;
+            switch (device->getGraphicsAPI())
+            {
+            case nvrhi::GraphicsAPI::D3D11:  buffer = staticShader.dxbc;  break;
+            case nvrhi::GraphicsAPI::D3D12:  buffer = staticShader.dxil;  break;
+            case nvrhi::GraphicsAPI::VULKAN: buffer = staticShader.spirv; break;
+            }
+
+            const void* permutationBytecode = buffer.data;
+            size_t permutationSize = buffer.size;
+
+            if (pDefines)
+            {
+                std::vector<ShaderMake::ShaderConstant> constants;
+                constants.reserve(pDefines->size());
+                for (const ShaderMacro& define : *pDefines)
+                    constants.emplace_back(define.name.data(), define.definition.data());
+
+                if (!ShaderMake::FindPermutationInBlob(buffer.data, buffer.size, constants.data(), uint32_t(constants.size()), &permutationBytecode, &permutationSize))
+                {
+                    const std::string message = ShaderMake::FormatShaderNotFoundMessage(buffer.data, buffer.size, constants.data(), uint32_t(constants.size()));
+                    HE_CORE_ERROR("CreateStaticShader : {}", message.c_str());
+                }
+            }
+
+            shader = device->createShader(desc, permutationBytecode, permutationSize);
+
+            return shader;
+        }
+
+        nvrhi::ShaderLibraryHandle CreateShaderLibrary(nvrhi::IDevice* device, StaticShader staticShader, const std::vector<ShaderMacro>* pDefines)
+        {
+            HE_PROFILE_FUNCTION();
+
+            nvrhi::ShaderLibraryHandle shader;
+
+            Buffer buffer;
+            switch (device->getGraphicsAPI())
+            {
+            case nvrhi::GraphicsAPI::D3D11:  buffer = staticShader.dxbc;  break;
+            case nvrhi::GraphicsAPI::D3D12:  buffer = staticShader.dxil;  break;
+            case nvrhi::GraphicsAPI::VULKAN: buffer = staticShader.spirv; break;
+            }
+
+            const void* permutationBytecode = buffer.data;
+            size_t permutationSize = buffer.size;
+
+            if (pDefines)
+            {
+                std::vector<ShaderMake::ShaderConstant> constants;
+                constants.reserve(pDefines->size());
+                for (const ShaderMacro& define : *pDefines)
+                    constants.emplace_back(define.name.data(), define.definition.data());
+
+                if (!ShaderMake::FindPermutationInBlob(buffer.data, buffer.size, constants.data(), uint32_t(constants.size()), &permutationBytecode, &permutationSize))
+                {
+                    const std::string message = ShaderMake::FormatShaderNotFoundMessage(buffer.data, buffer.size, constants.data(), uint32_t(constants.size()));
+                    HE_CORE_ERROR("CreateStaticShader : {}", message.c_str());
+                }
+            }
+
+            shader = device->createShaderLibrary(permutationBytecode, permutationSize);
+
+            return shader;
+        }
+
+        bool DeviceManager::CreateInstance(const DeviceInstanceDesc& pDesc)
+        {
+            HE_PROFILE_FUNCTION();
+
+            if (instanceCreated)
+                return true;
+
+            static_cast<DeviceInstanceDesc&>(desc) = pDesc;
+
+            instanceCreated = CreateInstanceInternal();
+            return instanceCreated;
+        }
+
+        bool DeviceManager::CreateDevice(const DeviceDesc& pDesc)
+        {
+            HE_PROFILE_FUNCTION();
+
+            desc = pDesc;
+
+            if (!CreateInstance(desc))
+                return false;
+
+            if (!CreateDevice())
+                return false;
+
+            HE_CORE_INFO("[Backend API] : {}", nvrhi::utils::GraphicsAPIToString(GetDevice()->getGraphicsAPI()));
+
+            return true;
+        }
+
+        DefaultMessageCallback& DefaultMessageCallback::GetInstance()
+        {
+            static DefaultMessageCallback Instance;
+            return Instance;
+        }
+
+        void DefaultMessageCallback::message(nvrhi::MessageSeverity severity, const char* messageText)
+        {
+            switch (severity)
+            {
+            case nvrhi::MessageSeverity::Info:    HE_CORE_INFO("[DeviceManager] : {}", messageText); break;
+            case nvrhi::MessageSeverity::Warning: HE_CORE_WARN("[DeviceManager] : {}", messageText); break;
+            case nvrhi::MessageSeverity::Error:   HE_CORE_ERROR("[DeviceManager] : {}", messageText); break;
+            case nvrhi::MessageSeverity::Fatal:   HE_CORE_CRITICAL("[DeviceManager] : {}", messageText); break;
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // GPU Profiler
+    //////////////////////////////////////////////////////////////////////////
+
+    namespace GPUProfiler {
+
+        // timer query handles and command lists are only touched under c.mutex
+        static const char* Intern(Context& c, const char* name)
+        {
+            return c.names.emplace(name ? name : "").first->c_str();
+        }
+
+        static uint32_t BeginScopeLocked(Context& c, nvrhi::ICommandList* commandList, const char* name)
+        {
+            if (!c.current)
+                return ~0u;
+
+            Context::Frame& f = *c.current;
+            if (f.used == f.queries.size())
+                f.queries.push_back({ commandList->getDevice()->createTimerQuery() });
+
+            Context::Query& q = f.queries[f.used];
+            q.name = Intern(c, name);
+            q.ended = false;
+
+            commandList->beginMarker(q.name);
+            commandList->beginTimerQuery(q.handle);
+
+            return f.used++;
+        }
+
+        static void EndScopeLocked(Context& c, nvrhi::ICommandList* commandList, uint32_t scope)
+        {
+            if (!c.current || scope >= c.current->used)
+                return;
+
+            Context::Query& q = c.current->queries[scope];
+            commandList->endTimerQuery(q.handle);
+            commandList->endMarker();
+            q.ended = true;
+        }
+
+        void SetEnabled(bool enabled) { GetAppContext().gpuProfiler.enabled = enabled; }
+        bool IsEnabled() { return GetAppContext().gpuProfiler.enabled; }
+
+        uint32_t BeginScope(nvrhi::ICommandList* commandList, const char* name)
+        {
+            Context& c = GetAppContext().gpuProfiler;
+            if (!c.enabled || !commandList)
+                return ~0u;
+
+            std::scoped_lock lock(c.mutex);
+            return BeginScopeLocked(c, commandList, name);
+        }
+
+        void EndScope(nvrhi::ICommandList* commandList, uint32_t scope)
+        {
+            if (scope == ~0u || !commandList)
+                return;
+
+            Context& c = GetAppContext().gpuProfiler;
+            std::scoped_lock lock(c.mutex);
+            EndScopeLocked(c, commandList, scope);
+        }
+
+        const std::vector<ScopeResult>& GetResults() { return GetAppContext().gpuProfiler.results; }
+        uint64_t GetResultsFrameIndex() { return GetAppContext().gpuProfiler.resultsFrameIndex; }
+
+        // reads the slot back if every query in it has landed, a slot that is still in flight is skipped this frame
+        static bool ResolveFrame(ApplicationContext& app, nvrhi::IDevice* device, Context::Frame& f)
+        {
+            Context& c = app.gpuProfiler;
+
+            for (uint32_t i = 0; i < f.used; i++)
+            {
+                if (f.queries[i].ended && !device->pollTimerQuery(f.queries[i].handle))
+                    return false;
+            }
+
+            c.results.clear();
+            float frameMs = 0.0f;
+
+            for (uint32_t i = 0; i < f.used; i++)
+            {
+                Context::Query& q = f.queries[i];
+                if (q.ended)
+                {
+                    float ms = device->getTimerQueryTime(q.handle) * 1e3f;
+
+                    auto it = std::find_if(c.results.begin(), c.results.end(), [&](const ScopeResult& r) { return r.name == q.name; });
+                    if (it == c.results.end())
+                        it = c.results.insert(c.results.end(), { q.name });
+
+                    it->ms += ms;
+                    it->count++;
+
+                    if (i == 0)
+                        frameMs = ms;
+                }
+
+                device->resetTimerQuery(q.handle);
+            }
+
+            for (const ScopeResult& r : c.results)
+                HE_PROFILE_VALUE(r.name, r.ms);
+
+            c.resultsFrameIndex = f.frameIndex;
+            app.appStats.GPUFrameTime = frameMs;
+
+            FrameTiming& timing = app.frameHistory[f.frameIndex % app.frameHistory.size()];
+            if (timing.frameIndex == f.frameIndex)
+                timing.gpuMs = frameMs;
+
+            f.used = 0;
+            return true;
+        }
+
+        // one tiny command list per boundary, ends the open scope and begins the next one, layers+3 submits a frame
+        static void Bracket(Context& c, nvrhi::IDevice* device, uint32_t& scope, const char* nextName)
+        {
+            if (c.bracketCursor == c.bracketLists.size())
+                c.bracketLists.push_back(device->createCommandList());
+
+            nvrhi::ICommandList* cl = c.bracketLists[c.bracketCursor++];
+            cl->open();
+            EndScopeLocked(c, cl, scope);
+            scope = nextName ? BeginScopeLocked(c, cl, nextName) : ~0u;
+            cl->close();
+            device->executeCommandList(cl);
+        }
+
+        static void BeginFrame(ApplicationContext& app)
+        {
+            HE_PROFILE_FUNCTION();
+
+            Context& c = app.gpuProfiler;
+            std::scoped_lock lock(c.mutex);
+
+            c.current = nullptr;
+            c.bracketCursor = 0;
+
+            nvrhi::IDevice* device = RHI::GetDevice();
+            if (!c.enabled || !device)
+                return;
+
+            if (c.frames.empty())
+            {
+                SwapChain* sc = app.mainWindow.swapChain;
+                c.frames.resize((sc ? sc->desc.maxFramesInFlight : 2) + 1);
+            }
+
+            Context::Frame& f = c.frames[app.frameIndex % c.frames.size()];
+            if (f.used && !ResolveFrame(app, device, f))
+                return;
+
+            f.frameIndex = app.frameIndex;
+            c.current = &f;
+
+            // the frame scope is always query 0 of its slot
+            Bracket(c, device, c.frameScope, "Frame");
+        }
+
+        static void LayerBracket(ApplicationContext& app, Layer* next)
+        {
+            Context& c = app.gpuProfiler;
+            if (!c.current)
+                return;
+
+            std::scoped_lock lock(c.mutex);
+            if (next || c.layerScope != ~0u)
+                Bracket(c, RHI::GetDevice(), c.layerScope, next ? next->GetName() : nullptr);
+        }
+
+        static void EndFrame(ApplicationContext& app)
+        {
+            HE_PROFILE_FUNCTION();
+
+            Context& c = app.gpuProfiler;
+            if (!c.current)
+                return;
+
+            std::scoped_lock lock(c.mutex);
+            Bracket(c, RHI::GetDevice(), c.frameScope, nullptr);
+            c.current = nullptr;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Modules
+    //////////////////////////////////////////////////////////////////////////
+
+    namespace Modules {
+
+        ModulesContext::~ModulesContext()
+        {
+            HE_PROFILE_FUNCTION();
+
+            struct ModuleToShutdown
+            {
+                uint32_t LoadOrder;
+                ModuleHandle handle;
+            };
+
+            if (modules.size() <= 0)
+                return;
+
+            std::vector<ModuleToShutdown> ModulesToShutdone;
+            ModulesToShutdone.reserve(modules.size());
+            for (auto& [handle, moduleData] : modules)
+            {
+                ModulesToShutdone.emplace_back(moduleData->loadOrder, handle);
+            }
+
+            std::sort(ModulesToShutdone.begin(), ModulesToShutdone.end(), [&](const ModuleToShutdown& a, const ModuleToShutdown& b) { return a.LoadOrder < b.LoadOrder; });
+            std::reverse(ModulesToShutdone.begin(), ModulesToShutdone.end());
+
+            for (auto& ModuleToShutdone : ModulesToShutdone)
+            {
+                UnloadModule(ModuleToShutdone.handle);
+            }
+        }
+
+        static const uint64_t s_ShadowSession = Application::GetTimestamp();
+
+        // shadow copies left behind by sessions that crashed or were killed, copies still loaded by another
+        // instance are unlinked on Linux and stay locked (the error is ignored) on Windows
+        static void RemoveStaleShadowCopies(const std::filesystem::path& directory)
+        {
+            HE_PROFILE_FUNCTION();
+
+            std::string session = std::format(".shadow-{:x}-", s_ShadowSession);
+
+            std::error_code ec;
+            for (const auto& entry : std::filesystem::directory_iterator(directory, ec))
+            {
+                std::string name = entry.path().filename().string();
+                if (name.find(".shadow-") == std::string::npos || name.find(session) != std::string::npos)
+                    continue;
+
+                std::error_code removeError;
+                if (std::filesystem::remove(entry.path(), removeError))
+                    HE_CORE_INFO("Modules : removed stale shadow copy {}", entry.path().string());
+            }
+        }
+
+        // opens the library only and touches no engine state, so several modules can be opened concurrently as long as
+        // their static initializers (and DllMain on Windows) are safe to run off the main thread and alongside each other
+        static Ref<ModuleData> OpenModule(const std::filesystem::path& filePath, bool shadowCopy)
+        {
+            HE_PROFILE_FUNCTION();
+
+            if (!std::filesystem::exists(filePath))
+            {
+                HE_CORE_ERROR("LoadModule failed: File {} does not exist.", filePath.string());
+                return nullptr;
+            }
+
+            std::error_code ec;
+            std::filesystem::path shadowPath;
+
+            if (shadowCopy)
+            {
+                // next to the original so the module's own dependencies still resolve from its directory,
+                // and under a unique name so the loader never hands back the instance being replaced
+                static std::atomic<uint32_t> s_ShadowCount = 0;
+
+                shadowPath = filePath.parent_path() / std::format("{}.shadow-{:x}-{}{}", filePath.stem().string(), s_ShadowSession, s_ShadowCount++, filePath.extension().string());
+
+                std::filesystem::copy_file(filePath, shadowPath, std::filesystem::copy_options::overwrite_existing, ec);
+                if (ec)
+                {
+                    HE_CORE_ERROR("LoadModule failed: Unable to create shadow copy {} : {}", shadowPath.string(), ec.message());
+                    return nullptr;
+                }
+            }
+
+            uint64_t start = Application::GetTimestamp();
+            Ref<ModuleData> moduleData = CreateRef<ModuleData>(filePath, shadowPath, GetAppContext().modulesContext.lazyBinding);
+
+            ModuleLoadStats& stats = moduleData->loadStats;
+            stats.openTime = float(Application::GetTimestamp() - start) * 1e-6f;
+            stats.name = moduleData->name;
+            stats.fileSize = std::filesystem::file_size(filePath, ec);
+
+            return moduleData;
+        }
+
+        // closes a shadow copied module right away so its copy can be deleted, in place modules close with their last reference
+        static void CloseModule(ModuleData& moduleData)
+        {
+            if (moduleData.shadowPath.empty())
+                return;
+
+            moduleData.lib.Unload();
+
+            std::error_code ec;
+            std::filesystem::remove(moduleData.shadowPath, ec);
+        }
+
+        // main thread, runs OnModuleLoaded and publishes the module
+        static bool RegisterModule(const std::filesystem::path& filePath, const Ref<ModuleData>& newModule)
+        {
+            HE_PROFILE_FUNCTION();
+
+            if (!newModule)
+                return false;
+
+            auto& c = GetAppContext().modulesContext;
+
+            ModuleHandle handle = Hash(filePath);
+            if (c.modules.contains(handle))
+            {
+                HE_CORE_WARN("Module {} has already been loaded.", newModule->name);
+                return false;
+            }
+
+            if (newModule->lib.IsLoaded())
+            {
+                auto func = newModule->lib.GetFunction<void()>("OnModuleLoaded");
+                if (func)
+                {
+                    newModule->loadOrder = ModuleData::currentLoadOrder++;
+
+                    uint64_t start = Application::GetTimestamp();
+                    func();
+
+                    if (newModule->lib.HasSymbol("GetModuleInterface"))
+                        newModule->moduleInterface = newModule->lib.GetFunction<const ModuleInterface*()>("GetModuleInterface")();
+
+                    ModuleLoadStats& stats = newModule->loadStats;
+                    stats.initTime = float(Application::GetTimestamp() - start) * 1e-6f;
+                    c.loadStats[handle] = stats;
+
+                    if (c.slowLoadWarningTime > 0.0f && stats.openTime + stats.initTime > c.slowLoadWarningTime)
+                        HE_CORE_WARN("Module {} took {:.2f} ms to load (open {:.2f} ms, OnModuleLoaded {:.2f} ms)", newModule->name, stats.openTime + stats.initTime, stats.openTime, stats.initTime);
+
+                    c.modules[handle] = newModule;
+                    return true;
+                }
+            }
+
+            HE_CORE_ERROR("LoadModule failed: OnModuleLoaded function not found in module {}.", newModule->name);
+            return false;
+        }
+
+        bool LoadModule(const std::filesystem::path& filePath, bool shadowCopy)
+        {
+            HE_PROFILE_FUNCTION();
+
+            Ref<ModuleData> newModule = OpenModule(filePath, shadowCopy);
+            if (RegisterModule(filePath, newModule))
+                return true;
+
+            if (newModule)
+                CloseModule(*newModule);
+
+            return false;
+        }
+
+        bool IsModuleLoaded(ModuleHandle handle)
+        {
+            HE_PROFILE_FUNCTION();
+
+            auto& c = GetAppContext().modulesContext;
+
+            if (c.modules.contains(handle))
+                return true;
+
+            return false;
+        }
+
+        // runs OnModuleShutdown and unpublishes the module, closing the library is left to the caller
+        static Ref<ModuleData> DetachModule(ModuleHandle handle)
+        {
+            auto& c = GetAppContext().modulesContext;
+
+            auto it = c.modules.find(handle);
+            if (it == c.modules.end())
+            {
+                HE_CORE_ERROR("UnloadModule failed: Module with handle {} not found.", handle);
+                return nullptr;
+            }
+
+            Ref<ModuleData> moduleData = it->second;
+
+            if (auto func = moduleData->lib.GetFunction<void()>("OnModuleShutdown"))
+            {
+                func();
+            }
+            else
+            {
+                HE_CORE_WARN("UnloadModule failed: Module {} does not define an OnModuleShutdown function.", moduleData->name);
+            }
+
+            c.modules.erase(it);
+            return moduleData;
+        }
+
+        bool UnloadModule(ModuleHandle handle)
+        {
+            HE_PROFILE_FUNCTION();
+
+            Ref<ModuleData> moduleData = DetachModule(handle);
+            if (!moduleData)
+                return false;
+
+            CloseModule(*moduleData);
+            return true;
+        }
+
+        bool ReloadModule(ModuleHandle handle)
+        {
+            HE_PROFILE_FUNCTION();
+
+            auto& c = GetAppContext().modulesContext;
+
+            auto it = c.modules.find(handle);
+            if (it == c.modules.end())
+            {
+                HE_CORE_ERROR("ReloadModule failed: Module with handle {} not found.", handle);
+                return false;
+            }
+
+            Ref<ModuleData> oldModule = it->second;
+
+            std::vector<uint8_t> state;
+            Ref<ModuleData> newModule;
+
+            if (oldModule->shadowPath.empty())
+            {
+                // the loader hands back an image that is still open, so a module opened in place is closed first
+                // and a broken build leaves it unloaded
+                if (oldModule->lib.HasSymbol("OnModuleSerialize"))
+                    oldModule->lib.GetFunction<void(std::vector<uint8_t>&)>("OnModuleSerialize")(state);
+
+                UnloadModule(handle);
+                oldModule->lib.Unload();
+
+                newModule = OpenModule(oldModule->filePath, false);
+                if (!newModule || !newModule->lib.IsLoaded() || !newModule->lib.HasSymbol("OnModuleLoaded"))
+                {
+                    HE_CORE_ERROR("ReloadModule failed: {} could not be loaded again and stays unloaded.", oldModule->name);
+                    return false;
+                }
+            }
+            else
+            {
+                // the new instance is opened from a fresh copy before the running one goes away, a broken build leaves it untouched
+                newModule = OpenModule(oldModule->filePath, true);
+                if (!newModule || !newModule->lib.IsLoaded() || !newModule->lib.HasSymbol("OnModuleLoaded"))
+                {
+                    HE_CORE_ERROR("ReloadModule failed: {} could not be loaded, keeping the running instance.", oldModule->name);
+                    if (newModule)
+                        CloseModule(*newModule);
+
+                    return false;
+                }
+
+                if (oldModule->lib.HasSymbol("OnModuleSerialize"))
+                    oldModule->lib.GetFunction<void(std::vector<uint8_t>&)>("OnModuleSerialize")(state);
+
+                UnloadModule(handle);
+            }
+
+            newModule->lastUsed = oldModule->lastUsed; // a reload is not a request, idle unloading keeps its clock
+
+            if (!RegisterModule(oldModule->filePath, newModule))
+            {
+                CloseModule(*newModule);
+                return false;
+            }
+
+            if (newModule->lib.HasSymbol("OnModuleDeserialize"))
+                newModule->lib.GetFunction<void(const std::vector<uint8_t>&)>("OnModuleDeserialize")(state);
+
+            HE_CORE_INFO("Modules::ReloadModule {}", newModule->name);
+            return true;
+        }
+
+        Ref<ModuleData> GetModuleData(ModuleHandle handle)
+        {
+            HE_PROFILE_FUNCTION();
+
+            auto& c = GetAppContext().modulesContext;
+
+            auto it = c.modules.find(handle);
+            if (it != c.modules.end())
+                return it->second;
+
+            HE_CORE_ERROR("Module with handle {} not found.", handle);
+            return nullptr;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Plugins
+    //////////////////////////////////////////////////////////////////////////
+
+    namespace Plugins {
+
+        PluginContext::~PluginContext()
+        {
+            HE_PROFILE_FUNCTION();
+
+            if (watcherThread.joinable())
+            {
+                watching = false;
+                watcherThread.join();
+            }
+
+            if (watcher != -1)
+                OS::CloseFileWatcher(watcher);
+
+            // reverse topological order, a plugin is unloaded once no enabled plugin depends on it
+            std::unordered_map<PluginHandle, uint32_t> dependents;
+            for (auto& [handle, plugin] : plugins)
+            {
+                if (!plugin->enabled)
+                    continue;
+
+                dependents.try_emplace(handle, 0);
+                for (const auto& dependencyPluginName : plugin->desc.plugins)
+                {
+                    auto it = plugins.find(Hash(dependencyPluginName));
+                    if (it != plugins.end() && it->second->enabled)
+                        dependents[it->first]++;
+                }
+            }
+
+            std::vector<PluginHandle> ready;
+            for (auto& [handle, count] : dependents)
+            {
+                if (count == 0)
+                    ready.push_back(handle);
+            }
+
+            while (!ready.empty())
+            {
+                PluginHandle handle = ready.back();
+                ready.pop_back();
+
+                Ref<Plugin> plugin = plugins.at(handle);
+                UnloadPlugin(handle);
+
+                for (const auto& dependencyPluginName : plugin->desc.plugins)
+                {
+                    auto it = dependents.find(Hash(dependencyPluginName));
+                    if (it != dependents.end() && --it->second == 0)
+                        ready.push_back(it->first);
+                }
+            }
+        }
+
+        bool DeserializePluginDesc(const std::filesystem::path& filePath, PluginDesc& desc)
+        {
+            HE_PROFILE_FUNCTION();
+
+            // one parser per thread so discovery can parse descriptors concurrently
+            thread_local simdjson::dom::parser parser;
+
+            FileSystem::MappedFile file = FileSystem::MapFile(filePath, FileSystem::AccessPattern::Sequential);
+            if (!file.IsMapped())
+                return false;
+
+            // parsed in place when the zeroed tail of the last page covers simdjson's padding, copied otherwise
+            bool needsCopy = file.ReadableSize() - file.Size() < simdjson::SIMDJSON_PADDING;
+
+            simdjson::dom::element pluginDescriptor;
+            auto error = parser.parse(file.Data(), file.Size(), needsCopy).get(pluginDescriptor);
+            if (error)
+            {
+                HE_CORE_ERROR("Failed to load .hplugin file {}\n    {}", filePath.string(), simdjson::error_message(error));
+                return false;
+            }
+
+            std::string_view name;
+            desc.name = (pluginDescriptor["name"].get(name) != simdjson::SUCCESS) ? "" : name;
+
+            std::string_view description;
+            desc.description = (pluginDescriptor["description"].get(description) != simdjson::SUCCESS) ? "" : description;
+
+            std::string_view URL;
+            desc.URL = (pluginDescriptor["URL"].get(URL) != simdjson::SUCCESS) ? "" : URL;
+
+            pluginDescriptor["reloadable"].get(desc.reloadable);
+            pluginDescriptor["enabledByDefault"].get(desc.enabledByDefault);
+
+            simdjson::dom::array modulesArray;
+            pluginDescriptor["modules"].get(modulesArray);
+            desc.modules.reserve(modulesArray.size());
+            for (simdjson::dom::element module : modulesArray)
+            {
+                std::string_view moduleName;
+                module.get(moduleName);
+                desc.modules.emplace_back(moduleName);
+            }
+
+            simdjson::dom::array pluginsArray;
+            pluginDescriptor["plugins"].get(pluginsArray);
+            desc.plugins.reserve(pluginsArray.size());
+            for (simdjson::dom::element plugin : pluginsArray)
+            {
+                std::string_view pluginName;
+                plugin.get(pluginName);
+                desc.plugins.emplace_back(pluginName);
+            }
+
+            pluginDescriptor["lazy"].get(desc.lazy);
+
+            simdjson::dom::object servicesObject;
+            pluginDescriptor["services"].get(servicesObject);
+            desc.services.reserve(servicesObject.size());
+            for (auto [serviceName, module] : servicesObject)
+            {
+                std::string_view moduleName;
+                module.get(moduleName);
+                desc.services.emplace_back(std::string(serviceName), std::string(moduleName));
+            }
+
+            return true;
+        }
+
+        // shadow copies are only needed to replace a loaded module, so read-only installs load in place without hot reload
+        static bool ShadowCopyModules(const PluginContext& ctx, const Plugin& plugin)
+        {
+            return ctx.hotReload && plugin.desc.reloadable;
+        }
+
+        static std::filesystem::path ModulesDirectory(const Plugin& plugin)
+        {
+            return plugin.BinariesDirectory() / std::format("{}-{}", c_System, c_Architecture) / c_BuildConfig;
+        }
+
+        static std::filesystem::path ModulePath(const Plugin& plugin, const std::string& moduleName)
+        {
+            return ModulesDirectory(plugin) / (moduleName + c_SharedLibExtension);
+        }
+
+        static void WatcherMain(PluginContext* ctx)
+        {
+            Profiler::SetThreadName("Plugin Watcher");
+
+            std::vector<std::filesystem::path> changed;
+            auto lastChange = std::chrono::steady_clock::now();
+
+            while (ctx->watching)
+            {
+                size_t count = changed.size();
+                if (!OS::ReadFileWatcher(ctx->watcher, changed, 100))
+                {
+                    HE_CORE_ERROR("Plugins : file watcher failed, hot reload is disabled");
+                    break;
+                }
+
+                // a build writes a binary in several steps, wait until it has been quiet for a while
+                auto now = std::chrono::steady_clock::now();
+                if (changed.size() != count)
+                {
+                    lastChange = now;
+                    continue;
+                }
+
+                if (changed.empty() || now - lastChange < std::chrono::milliseconds(ctx->reloadDebounceMs))
+                    continue;
+
+                std::scoped_lock lock(ctx->changedMutex);
+                ctx->changedBinaries.insert(ctx->changedBinaries.end(), changed.begin(), changed.end());
+                ctx->reloadPending = true;
+                changed.clear();
+            }
+        }
+
+        static void WatchPlugin(PluginContext& ctx, const Plugin& plugin)
+        {
+            if (!ctx.hotReload || !plugin.desc.reloadable)
+                return;
+
+            if (ctx.watcher == -1)
+            {
+                ctx.watcher = OS::CreateFileWatcher();
+                if (ctx.watcher == -1)
+                {
+                    HE_CORE_WARN("Plugins : unable to create a file watcher, hot reload is disabled");
+                    ctx.hotReload = false;
+                    return;
+                }
+
+                ctx.watching = true;
+                ctx.watcherThread = std::thread(WatcherMain, &ctx);
+            }
+
+            auto directory = ModulesDirectory(plugin);
+            if (ctx.watchedDirectories.insert(Hash(directory)).second && !OS::AddFileWatch(ctx.watcher, directory))
+                HE_CORE_WARN("Plugins : unable to watch {}", directory.string());
+        }
+
+        static void ReloadChangedModules(PluginContext& ctx)
+        {
+            HE_PROFILE_FUNCTION();
+
+            std::vector<std::filesystem::path> changed;
+            {
+                std::scoped_lock lock(ctx.changedMutex);
+                changed.swap(ctx.changedBinaries);
+                ctx.reloadPending = false;
+            }
+
+            std::unordered_set<Modules::ModuleHandle> reloaded;
+            for (const auto& filePath : changed)
+            {
+                // only modules opened from a shadow copy, the events of the copies themselves match no module
+                Modules::ModuleHandle handle = Hash(filePath);
+                auto moduleData = GetAppContext().modulesContext.modules.find(handle);
+                if (moduleData == GetAppContext().modulesContext.modules.end() || moduleData->second->shadowPath.empty())
+                    continue;
+
+                if (reloaded.insert(handle).second)
+                    Modules::ReloadModule(handle);
+            }
+        }
+
+        static Ref<Plugin> AddPluginObject(const std::filesystem::path& descFilePath, PluginDesc&& desc)
+        {
+            auto& ctx = GetAppContext().pluginContext;
+
+            PluginHandle handle = Hash(desc.name);
+            ctx.descFiles[Hash(descFilePath)] = handle;
+
+            if (ctx.plugins.contains(handle))
+                return ctx.plugins.at(handle);
+
+            Ref<Plugin> plugin = CreateRef<Plugin>(std::move(desc));
+            plugin->descFilePath = descFilePath;
+            ctx.plugins[handle] = plugin;
+
+            return plugin;
+        }
+
+        Ref<Plugin> GetOrCreatePluginObject(const std::filesystem::path& descFilePath)
+        {
+            HE_PROFILE_FUNCTION();
+
+            auto& ctx = GetAppContext().pluginContext;
+
+            auto it = ctx.descFiles.find(Hash(descFilePath));
+            if (it != ctx.descFiles.end() && ctx.plugins.contains(it->second))
+                return ctx.plugins.at(it->second);
+
+            uint64_t start = Application::GetTimestamp();
+
+            PluginDesc desc;
+            if (!DeserializePluginDesc(descFilePath, desc))
+                return nullptr;
+
+            float parseTime = float(Application::GetTimestamp() - start) * 1e-6f;
+
+            Ref<Plugin> plugin = AddPluginObject(descFilePath, std::move(desc));
+            plugin->loadStats.parseTime = parseTime;
+            return plugin;
+        }
+
+        void LoadPlugin(const std::filesystem::path& descriptor)
+        {
+            HE_PROFILE_FUNCTION();
+
+            auto lexicallyNormal = descriptor.lexically_normal();
+            if (!std::filesystem::exists(lexicallyNormal))
+            {
+                HE_CORE_ERROR("LoadPlugin failed: file {} does not exist.", lexicallyNormal.string());
+                return;
+            }
+
+            Ref<Plugin> plugin = GetOrCreatePluginObject(lexicallyNormal);
+            if (!plugin)
+                return;
+
+            LoadPlugin(Hash(plugin->desc.name));
+        }
+
+        struct LoadGraph
+        {
+            enum class State : uint8_t { Visiting, Done, Failed };
+
+            std::unordered_map<PluginHandle, State> state;
+            std::unordered_map<PluginHandle, uint32_t> level; // longest dependency chain to an already loaded plugin
+            std::vector<PluginHandle> path;                   // current depth first path, reported when a cycle is found
+            std::vector<std::vector<Ref<Plugin>>> levels;     // plugins within a level do not depend on each other
+        };
+
+        static bool Visit(LoadGraph& g, PluginHandle handle)
+        {
+            auto& ctx = GetAppContext().pluginContext;
+
+            Ref<Plugin> plugin = ctx.plugins.at(handle);
+            if (plugin->enabled)
+                return true;
+
+            auto it = g.state.find(handle);
+            if (it != g.state.end())
+            {
+                if (it->second == LoadGraph::State::Visiting)
+                {
+                    std::string cycle;
+                    for (auto p = std::find(g.path.begin(), g.path.end(), handle); p != g.path.end(); p++)
+                        cycle += ctx.plugins.at(*p)->desc.name + " -> ";
+
+                    HE_CORE_ERROR("LoadPlugin failed: dependency cycle {}{}", cycle, plugin->desc.name);
+                }
+
+                return it->second == LoadGraph::State::Done;
+            }
+
+            g.state[handle] = LoadGraph::State::Visiting;
+            g.path.push_back(handle);
+
+            auto pluginsDir = plugin->descFilePath.parent_path().parent_path();
+            uint32_t level = 0;
+            bool resolved = true;
+
+            for (const auto& dependencyPluginName : plugin->desc.plugins)
+            {
+                auto pluginsDescFilePath = pluginsDir / dependencyPluginName / (dependencyPluginName + c_PluginDescriptorExtension);
+                if (std::filesystem::exists(pluginsDescFilePath))
+                    GetOrCreatePluginObject(pluginsDescFilePath);
+
+                PluginHandle dependencyPluginHandle = Hash(dependencyPluginName);
+                if (!ctx.plugins.contains(dependencyPluginHandle))
+                {
+                    HE_CORE_WARN("Plugin {} depends on {}, which was not found.", plugin->desc.name, dependencyPluginName);
+                    continue;
+                }
+
+                if (!Visit(g, dependencyPluginHandle))
+                {
+                    resolved = false;
+                    continue;
+                }
+
+                if (!ctx.plugins.at(dependencyPluginHandle)->enabled)
+                    level = std::max(level, g.level.at(dependencyPluginHandle) + 1);
+            }
+
+            g.path.pop_back();
+
+            if (!resolved)
+            {
+                g.state[handle] = LoadGraph::State::Failed;
+                HE_CORE_ERROR("LoadPlugin failed: dependencies of {} could not be resolved.", plugin->desc.name);
+                return false;
+            }
+
+            g.state[handle] = LoadGraph::State::Done;
+            g.level[handle] = level;
+
+            if (g.levels.size() <= level)
+                g.levels.resize(level + 1);
+            g.levels[level].push_back(plugin);
+
+            return true;
+        }
+
+        // loads the plugins and their dependencies one graph level at a time, opening all modules of a level (on workers
+        // when parallelOpen is set) and then running their OnModuleLoaded callbacks on this thread in a fixed order
+        static void LoadPlugins(std::span<const PluginHandle> handles)
+        {
+            HE_PROFILE_FUNCTION();
+
+            auto& ctx = GetAppContext().pluginContext;
+            auto& modulesContext = GetAppContext().modulesContext;
+
+            LoadGraph g;
+            for (PluginHandle handle : handles)
+            {
+                if (ctx.plugins.contains(handle))
+                    Visit(g, handle);
+            }
+
+            struct PendingModule
+            {
+                const Plugin* plugin;
+                std::filesystem::path filePath;
+                Ref<ModuleData> data;
+            };
+
+            std::vector<PendingModule> pending;
+            uint64_t loadStart = Application::GetTimestamp();
+
+            for (uint32_t levelIndex = 0; levelIndex < g.levels.size(); levelIndex++)
+            {
+                auto& level = g.levels[levelIndex];
+                float waitTime = float(Application::GetTimestamp() - loadStart) * 1e-6f;
+
+                // discovery order depends on the file system, sort so callbacks run in the same order every launch
+                std::sort(level.begin(), level.end(), [](const Ref<Plugin>& a, const Ref<Plugin>& b) { return a->desc.name < b->desc.name; });
+
+                pending.clear();
+                for (const Ref<Plugin>& plugin : level)
+                {
+                    if (plugin->desc.reloadable && ctx.cleanedModuleDirectories.insert(Hash(ModulesDirectory(*plugin))).second)
+                        Modules::RemoveStaleShadowCopies(ModulesDirectory(*plugin));
+
+                    if (plugin->desc.lazy)
+                        continue;
+
+                    for (const auto& moduleName : plugin->desc.modules)
+                    {
+                        auto modulePath = ModulePath(*plugin, moduleName);
+                        if (!modulesContext.modules.contains(Hash(modulePath)))
+                            pending.emplace_back(plugin.get(), modulePath);
+                    }
+                }
+
+                {
+                    HE_PROFILE_SCOPE("Open Modules");
+
+                    auto open = [&pending, &ctx](size_t i) {
+                        pending[i].data = Modules::OpenModule(pending[i].filePath, ShadowCopyModules(ctx, *pending[i].plugin));
+                    };
+
+                    // opt-in, module static initializers run on the workers and concurrently with each other
+                    if (ctx.parallelOpen && pending.size() > 1)
+                    {
+                        Jops::Taskflow taskflow;
+                        taskflow.for_each_index(size_t(0), pending.size(), size_t(1), open);
+                        Jops::RunTaskflowAndWait(taskflow);
+                    }
+                    else
+                    {
+                        for (size_t i = 0; i < pending.size(); i++)
+                            open(i);
+                    }
+                }
+
+                size_t next = 0;
+                for (const Ref<Plugin>& plugin : level)
+                {
+                    plugin->enabled = true;
+
+                    PluginLoadStats& stats = plugin->loadStats;
+                    stats.name = plugin->desc.name;
+                    stats.level = levelIndex;
+                    stats.loadTime = 0.0f;
+
+                    for (const ServiceDesc& service : plugin->desc.services)
+                    {
+                        auto [it, inserted] = ctx.services.try_emplace(HashString(service.name), Hash(plugin->desc.name), service.module);
+                        if (!inserted)
+                            HE_CORE_WARN("Plugins : service {} of {} is already provided by {}", service.name, plugin->desc.name, ctx.plugins.at(it->second.first)->desc.name);
+                    }
+
+                    HE_CORE_INFO("Plugins::LoadPlugin {}{}", plugin->desc.name, plugin->desc.lazy ? " (lazy)" : "");
+
+                    for (; next < pending.size() && pending[next].plugin == plugin.get(); next++)
+                    {
+                        Ref<ModuleData>& data = pending[next].data;
+                        if (data)
+                        {
+                            data->loadStats.plugin = plugin->desc.name;
+                            data->loadStats.waitTime = waitTime;
+                        }
+
+                        if (Modules::RegisterModule(pending[next].filePath, data))
+                            stats.loadTime += data->loadStats.openTime + data->loadStats.initTime;
+                        else if (data)
+                            Modules::CloseModule(*data);
+                    }
+
+                    ctx.loadStats[Hash(plugin->desc.name)] = stats;
+                    WatchPlugin(ctx, *plugin);
+                }
+            }
+
+            if (!g.levels.empty() && !ctx.loadReportFile.empty())
+                DumpLoadReport(ctx.loadReportFile);
+        }
+
+        void LoadPlugin(PluginHandle handle)
+        {
+            HE_PROFILE_FUNCTION();
+
+            LoadPlugins({ &handle, 1 });
+        }
+
+        bool UnloadPlugin(PluginHandle handle)
+        {
+            HE_PROFILE_FUNCTION();
+
+            auto& ctx = GetAppContext().pluginContext;
+
+            if (ctx.plugins.contains(handle))
+            {
+                const Ref<Plugin>& plugin = ctx.plugins.at(handle);
+                if (plugin->enabled)
+                {
+                    const auto& modulesNames = plugin->desc.modules;
+
+                    // Unload Modules, in reverse so a module outlives the ones loaded after it
+                    bool res = true;
+                    for (auto it = modulesNames.rbegin(); it != modulesNames.rend(); it++)
+                    {
+                        // modules of lazy plugins may never have been requested
+                        auto moduleHandle = Hash(ModulePath(*plugin, *it));
+                        if (plugin->desc.lazy && !Modules::IsModuleLoaded(moduleHandle))
+                            continue;
+
+                        res = Modules::UnloadModule(moduleHandle);
+                        if (!res) break;
+                    }
+                    if (res)
+                    {
+                        plugin->enabled = false;
+                        std::erase_if(ctx.services, [handle](const auto& service) { return service.second.first == handle; });
+                    }
+                    return true;
+                }
+                else
+                {
+                    return true;
+                }
+            }
+
+            HE_CORE_ERROR("UnloadPlugin : failed to Unload Plugin {}", handle);
+
+            return false;
+        }
+
+        void ReloadPlugin(PluginHandle handle)
+        {
+            HE_PROFILE_FUNCTION();
+
+            auto& ctx = GetAppContext().pluginContext;
+
+            std::filesystem::path pluginDescFilePath;
+
+            if (ctx.plugins.contains(handle))
+                pluginDescFilePath = ctx.plugins.at(handle)->descFilePath;
+
+            UnloadPlugin(handle);
+            ctx.plugins.erase(handle);
+            ctx.descFiles.erase(Hash(pluginDescFilePath)); // the descriptor may have changed, parse it again
+            LoadPlugin(pluginDescFilePath);
+        }
+
+        const Ref<Plugin> GetPlugin(PluginHandle handle)
+        {
+            auto& ctx = GetAppContext().pluginContext;
+            if (ctx.plugins.contains(handle))
+                return ctx.plugins.at(handle);
+
+            return nullptr;
+        }
+
+        Ref<Modules::ModuleData> RequestService(std::string_view service)
+        {
+            HE_PROFILE_FUNCTION();
+
+            auto& ctx = GetAppContext().pluginContext;
+            auto& modules = GetAppContext().modulesContext.modules;
+
+            auto it = ctx.services.find(HashString(service));
+            if (it == ctx.services.end())
+            {
+                HE_CORE_ERROR("RequestService failed: no enabled plugin provides {}", service);
+                return nullptr;
+            }
+
+            const auto& [pluginHandle, moduleName] = it->second;
+            const Ref<Plugin>& plugin = ctx.plugins.at(pluginHandle);
+
+            auto modulePath = ModulePath(*plugin, moduleName);
+            Modules::ModuleHandle moduleHandle = Hash(modulePath);
+
+            auto moduleData = modules.find(moduleHandle);
+            if (moduleData == modules.end())
+            {
+                if (!Modules::LoadModule(modulePath, ShadowCopyModules(ctx, *plugin)))
+                    return nullptr;
+
+                HE_CORE_INFO("Plugins : opened {} on first request of {}", moduleName, service);
+                moduleData = modules.find(moduleHandle);
+            }
+
+            moduleData->second->lastUsed = Application::GetTimestamp();
+            return moduleData->second;
+        }
+
+        static void UnloadIdleModules(PluginContext& ctx)
+        {
+            uint64_t now = Application::GetTimestamp();
+            if (ctx.idleUnloadTime <= 0.0f || now - ctx.lastIdleCheck < 1'000'000'000)
+                return;
+
+            HE_PROFILE_FUNCTION();
+
+            ctx.lastIdleCheck = now;
+            uint64_t idleTime = uint64_t(double(ctx.idleUnloadTime) * 1e9);
+            auto& modules = GetAppContext().modulesContext.modules;
+
+            for (const auto& [serviceKey, provider] : ctx.services)
+            {
+                const Ref<Plugin>& plugin = ctx.plugins.at(provider.first);
+                if (!plugin->desc.lazy)
+                    continue;
+
+                auto it = modules.find(Hash(ModulePath(*plugin, provider.second)));
+                if (it == modules.end() || now - it->second->lastUsed < idleTime)
+                    continue;
+
+                // a Ref held outside the module table pins the module, its functions and interfaces stay valid
+                if (it->second.use_count() > 1)
+                    continue;
+
+                Ref<Modules::ModuleData> moduleData = Modules::DetachModule(it->first);
+                HE_CORE_INFO("Plugins : unloaded idle module {}", moduleData->name);
+
+                // OnModuleShutdown ran here, closing the library and unmapping it is left to a worker
+                Jops::SubmitTask([moduleData = std::move(moduleData)]() mutable {
+                    Modules::CloseModule(*moduleData);
+                    moduleData.reset();
+                });
+            }
+        }
+
+        // Binary registry of parsed descriptors, a descriptor is parsed again only when its size or mtime changed.
+        //   header : magic "HEPR", u32 version, u32 entry count
+        //   entry  : path, u64 size, i64 mtime, name, description, URL, u8 reloadable, u8 enabledByDefault, u8 lazy,
+        //            u32 count + modules, u32 count + plugins, u32 count + service name and module pairs
+        //   strings are u32 length + bytes
+        struct RegistryEntry
+        {
+            uint64_t size = 0;
+            int64_t mtime = 0;
+            PluginDesc desc;
+        };
+
+        constexpr uint32_t c_PluginRegistryVersion = 2;
+
+        static std::filesystem::path PluginRegistryPath(const std::filesystem::path& directory)
+        {
+            auto dir = directory.lexically_normal();
+            if (!dir.has_filename())
+                dir = dir.parent_path();
+
+            return dir.parent_path() / (dir.filename().string() + ".hregistry");
+        }
+
+        static std::unordered_map<std::string, RegistryEntry> ReadPluginRegistry(const std::filesystem::path& filePath)
+        {
+            HE_PROFILE_FUNCTION();
+
+            std::unordered_map<std::string, RegistryEntry> entries;
+
+            std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+            if (!file.is_open())
+                return entries;
+
+            std::vector<char> data(size_t(file.tellg()));
+            file.seekg(0);
+            file.read(data.data(), data.size());
+
+            const char* p = data.data();
+            const char* end = p + data.size();
+            bool ok = bool(file);
+
+            auto read = [&](void* dst, size_t size) {
+                if (!ok || size_t(end - p) < size) { ok = false; return; }
+                std::memcpy(dst, p, size);
+                p += size;
+            };
+
+            auto readString = [&](std::string& str) {
+                uint32_t size = 0;
+                read(&size, sizeof(size));
+                if (!ok || size_t(end - p) < size) { ok = false; return; }
+                str.assign(p, size);
+                p += size;
+            };
+
+            auto readStrings = [&](std::vector<std::string>& strs) {
+                uint32_t count = 0;
+                read(&count, sizeof(count));
+                for (uint32_t i = 0; ok && i < count; i++)
+                    readString(strs.emplace_back());
+            };
+
+            char magic[4] = {};
+            uint32_t version = 0, count = 0;
+            read(magic, sizeof(magic));
+            read(&version, sizeof(version));
+            read(&count, sizeof(count));
+
+            if (!ok || std::memcmp(magic, "HEPR", 4) != 0 || version != c_PluginRegistryVersion)
+            {
+                HE_CORE_WARN("Plugins : {} is not a valid plugin registry, rebuilding it", filePath.string());
+                return entries;
+            }
+
+            for (uint32_t i = 0; ok && i < count; i++)
+            {
+                std::string path;
+                RegistryEntry entry;
+                uint8_t reloadable = 0, enabledByDefault = 0, lazy = 0;
+                uint32_t serviceCount = 0;
+
+                readString(path);
+                read(&entry.size, sizeof(entry.size));
+                read(&entry.mtime, sizeof(entry.mtime));
+                readString(entry.desc.name);
+                readString(entry.desc.description);
+                readString(entry.desc.URL);
+                read(&reloadable, sizeof(reloadable));
+                read(&enabledByDefault, sizeof(enabledByDefault));
+                read(&lazy, sizeof(lazy));
+                readStrings(entry.desc.modules);
+                readStrings(entry.desc.plugins);
+
+                read(&serviceCount, sizeof(serviceCount));
+                for (uint32_t j = 0; ok && j < serviceCount; j++)
+                {
+                    ServiceDesc& service = entry.desc.services.emplace_back();
+                    readString(service.name);
+                    readString(service.module);
+                }
+
+                entry.desc.reloadable = reloadable;
+                entry.desc.enabledByDefault = enabledByDefault;
+                entry.desc.lazy = lazy;
+
+                if (ok)
+                    entries.emplace(std::move(path), std::move(entry));
+            }
+
+            if (!ok)
+            {
+                HE_CORE_WARN("Plugins : plugin registry {} is truncated, rebuilding it", filePath.string());
+                entries.clear();
+            }
+
+            return entries;
+        }
+
+        static void WritePluginRegistry(const std::filesystem::path& filePath, const std::vector<std::pair<std::string, const RegistryEntry*>>& entries)
+        {
+            HE_PROFILE_FUNCTION();
+
+            std::string data;
+
+            auto write = [&](const void* src, size_t size) { data.append((const char*)src, size); };
+
+            auto writeString = [&](std::string_view str) {
+                uint32_t size = uint32_t(str.size());
+                write(&size, sizeof(size));
+                write(str.data(), size);
+            };
+
+            auto writeStrings = [&](const std::vector<std::string>& strs) {
+                uint32_t count = uint32_t(strs.size());
+                write(&count, sizeof(count));
+                for (const auto& str : strs)
+                    writeString(str);
+            };
+
+            uint32_t version = c_PluginRegistryVersion, count = uint32_t(entries.size());
+            write("HEPR", 4);
+            write(&version, sizeof(version));
+            write(&count, sizeof(count));
+
+            for (const auto& [path, entry] : entries)
+            {
+                uint8_t reloadable = entry->desc.reloadable, enabledByDefault = entry->desc.enabledByDefault, lazy = entry->desc.lazy;
+                uint32_t serviceCount = uint32_t(entry->desc.services.size());
+
+                writeString(path);
+                write(&entry->size, sizeof(entry->size));
+                write(&entry->mtime, sizeof(entry->mtime));
+                writeString(entry->desc.name);
+                writeString(entry->desc.description);
+                writeString(entry->desc.URL);
+                write(&reloadable, sizeof(reloadable));
+                write(&enabledByDefault, sizeof(enabledByDefault));
+                write(&lazy, sizeof(lazy));
+                writeStrings(entry->desc.modules);
+                writeStrings(entry->desc.plugins);
+
+                write(&serviceCount, sizeof(serviceCount));
+                for (const ServiceDesc& service : entry->desc.services)
+                {
+                    writeString(service.name);
+                    writeString(service.module);
+                }
+            }
+
+            // written aside under a name no other launch picks and renamed, so a concurrent launch never reads or writes a partial registry
+            uint64_t suffix = (uint64_t(std::random_device()()) << 32) ^ Application::GetTimestamp();
+            std::filesystem::path tmp = std::format("{}.{:x}.tmp", filePath.string(), suffix);
+            {
+                std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+                if (!file.is_open())
+                {
+                    HE_CORE_WARN("Plugins : Unable to write plugin registry {}", tmp.string());
+                    return;
+                }
+
+                file.write(data.data(), data.size());
+            }
+
+            std::error_code ec;
+            std::filesystem::rename(tmp, filePath, ec);
+            if (ec)
+            {
+                HE_CORE_WARN("Plugins : Unable to write plugin registry {}, {}", filePath.string(), ec.message());
+                std::filesystem::remove(tmp, ec);
+            }
+        }
+
+        LoadReport GetLoadReport()
+        {
+            auto& app = GetAppContext();
+
+            LoadReport report;
+            for (const auto& [handle, stats] : app.modulesContext.loadStats)
+                report.modules.push_back(stats);
+            for (const auto& [handle, stats] : app.pluginContext.loadStats)
+                report.plugins.push_back(stats);
+
+            std::sort(report.modules.begin(), report.modules.end(), [](const Modules::ModuleLoadStats& a, const Modules::ModuleLoadStats& b) { return a.openTime + a.initTime > b.openTime + b.initTime; });
+            std::sort(report.plugins.begin(), report.plugins.end(), [](const PluginLoadStats& a, const PluginLoadStats& b) { return a.parseTime + a.loadTime > b.parseTime + b.loadTime; });
+
+            return report;
+        }
+
+        std::string LoadReportToJson()
+        {
+            LoadReport report = GetLoadReport();
+
+            std::ostringstream os;
+            os << "{\n";
+            os << "\t\"plugins\" : [";
+
+            for (size_t i = 0; i < report.plugins.size(); i++)
+            {
+                const PluginLoadStats& p = report.plugins[i];
+
+                os << (i == 0 ? "\n" : ",\n");
+                os << "\t\t{ \"name\" : "; Profiler::WriteJsonString(os, p.name.c_str());
+                os << ", \"level\" : " << p.level;
+                os << ", \"fromRegistry\" : " << (p.fromRegistry ? "true" : "false");
+                os << ", \"parseMs\" : " << p.parseTime;
+                os << ", \"loadMs\" : " << p.loadTime << " }";
+            }
+
+            os << "\n\t],\n";
+            os << "\t\"modules\" : [";
+
+            for (size_t i = 0; i < report.modules.size(); i++)
+            {
+                const Modules::ModuleLoadStats& m = report.modules[i];
+
+                os << (i == 0 ? "\n" : ",\n");
+                os << "\t\t{ \"name\" : "; Profiler::WriteJsonString(os, m.name.c_str());
+                os << ", \"plugin\" : "; Profiler::WriteJsonString(os, m.plugin.c_str());
+                os << ", \"fileSize\" : " << m.fileSize;
+                os << ", \"waitMs\" : " << m.waitTime;
+                os << ", \"openMs\" : " << m.openTime;
+                os << ", \"initMs\" : " << m.initTime << " }";
+            }
+
+            os << "\n\t]\n";
+            os << "}\n";
+
+            return os.str();
+        }
+
+        bool DumpLoadReport(const std::filesystem::path& filePath)
+        {
+            std::ofstream file(filePath);
+            if (!file.is_open())
+            {
+                HE_CORE_ERROR("Plugins::DumpLoadReport : Unable to open file for writing, {}", filePath.string());
+                return false;
+            }
+
+            file << LoadReportToJson();
+            return true;
+        }
+
+        void LoadPluginsInDirectory(const std::filesystem::path& directory)
+        {
+            HE_PROFILE_FUNCTION();
+
+            auto& ctx = GetAppContext().pluginContext;
+
+            if (!std::filesystem::exists(directory))
+            {
+                HE_CORE_ERROR("LoadPluginsInDirectory failed: directory {} does not exist.", directory.string());
+                return;
+            }
+
+            struct Candidate
+            {
+                std::filesystem::path descFilePath;
+                std::string key;            // registry key, generic form of descFilePath
+                RegistryEntry entry;
+                float parseTime = 0.0f;
+                bool loaded = false;        // the plugin object already exists
+                bool fromRegistry = false;  // registry entry was still valid
+                bool valid = false;
+            };
+
+            auto registryPath = PluginRegistryPath(directory);
+            const auto registry = ReadPluginRegistry(registryPath);
+
+            std::vector<Candidate> candidates;
+            std::vector<PluginHandle> discoveredPlugins;
+
+            {
+                HE_PROFILE_SCOPE("Find Plugins");
+
+                std::error_code ec;
+                for (const auto& entry : std::filesystem::directory_iterator(directory, ec))
+                {
+                    if (!entry.is_directory(ec))
+                        continue;
+
+                    Candidate& candidate = candidates.emplace_back();
+                    candidate.descFilePath = entry.path() / (entry.path().stem().string() + c_PluginDescriptorExtension);
+                    candidate.key = candidate.descFilePath.generic_string();
+
+                    auto it = ctx.descFiles.find(Hash(candidate.descFilePath));
+                    candidate.loaded = it != ctx.descFiles.end() && ctx.plugins.contains(it->second);
+                    if (candidate.loaded)
+                        candidate.entry.desc = ctx.plugins.at(it->second)->desc;
+                }
+            }
+
+            {
+                HE_PROFILE_SCOPE("Parse Plugin Descriptors");
+
+                // stat and parse in parallel, each worker owns its parser and writes only its own candidate,
+                // descriptors whose size and mtime match the registry are not opened at all
+                Jops::Taskflow taskflow;
+                taskflow.for_each_index(size_t(0), candidates.size(), size_t(1), [&candidates, &registry](size_t i) {
+                    Candidate& candidate = candidates[i];
+
+                    std::error_code ec;
+                    auto status = std::filesystem::status(candidate.descFilePath, ec);
+                    if (ec || !std::filesystem::is_regular_file(status))
+                        return;
+
+                    candidate.entry.size = std::filesystem::file_size(candidate.descFilePath, ec);
+                    candidate.entry.mtime = int64_t(std::filesystem::last_write_time(candidate.descFilePath, ec).time_since_epoch().count());
+                    if (ec)
+                        return;
+
+                    auto it = registry.find(candidate.key);
+                    if (it != registry.end() && it->second.size == candidate.entry.size && it->second.mtime == candidate.entry.mtime)
+                    {
+                        candidate.fromRegistry = true;
+                        if (!candidate.loaded)
+                            candidate.entry.desc = it->second.desc;
+                    }
+
+                    if (candidate.loaded || candidate.fromRegistry)
+                    {
+                        candidate.valid = true;
+                        return;
+                    }
+
+                    uint64_t start = Application::GetTimestamp();
+                    candidate.valid = DeserializePluginDesc(candidate.descFilePath, candidate.entry.desc);
+                    candidate.parseTime = float(Application::GetTimestamp() - start) * 1e-6f;
+                });
+                Jops::RunTaskflowAndWait(taskflow);
+            }
+
+            {
+                HE_PROFILE_SCOPE("Update Plugin Registry");
+
+                std::vector<std::pair<std::string, const RegistryEntry*>> entries;
+                size_t unchanged = 0;
+                for (const Candidate& candidate : candidates)
+                {
+                    // a loaded plugin keeps its old desc until reloaded, so a changed descriptor is left for the next launch to parse
+                    if (!candidate.valid || (candidate.loaded && !candidate.fromRegistry))
+                        continue;
+
+                    entries.emplace_back(candidate.key, &candidate.entry);
+                    unchanged += candidate.fromRegistry;
+                }
+
+                // rewritten only when a descriptor was added, changed or removed
+                if (unchanged != entries.size() || unchanged != registry.size())
+                    WritePluginRegistry(registryPath, entries);
+            }
+
+            discoveredPlugins.reserve(candidates.size());
+            for (Candidate& candidate : candidates)
+            {
+                if (candidate.loaded)
+                    discoveredPlugins.push_back(ctx.descFiles.at(Hash(candidate.descFilePath)));
+                else if (candidate.valid)
+                {
+                    Ref<Plugin> plugin = AddPluginObject(candidate.descFilePath, std::move(candidate.entry.desc));
+                    plugin->loadStats.parseTime = candidate.parseTime;
+                    plugin->loadStats.fromRegistry = candidate.fromRegistry;
+                    discoveredPlugins.push_back(Hash(plugin->desc.name));
+                }
+            }
+
+            {
+                HE_PROFILE_SCOPE("Load Plugins");
+
+                std::erase_if(discoveredPlugins, [&ctx](PluginHandle handle) { return !ctx.plugins.at(handle)->desc.enabledByDefault; });
+                LoadPlugins(discoveredPlugins);
+            }
+        }
+    }
+       
+    //////////////////////////////////////////////////////////////////////////
+    // Window
+    //////////////////////////////////////////////////////////////////////////
+
+    // one table for both directions, the dense lookup arrays below are built from it at compile time
+    constexpr std::pair<KeyCode, int> c_KeyToGLFWKey[] = {
+        { Key::Space,         32 },  { Key::Apostrophe,    39 },  { Key::Comma,         44 },  { Key::Minus,         45 },
+        { Key::Period,        46 },  { Key::Slash,         47 },  { Key::D0,            48 },  { Key::D1,            49 },
+        { Key::D2,            50 },  { Key::D3,            51 },  { Key::D4,            52 },  { Key::D5,            53 },
+        { Key::D6,            54 },  { Key::D7,            55 },  { Key::D8,            56 },  { Key::D9,            57 },
+        { Key::Semicolon,     59 },  { Key::Equal,         61 },  { Key::A,             65 },  { Key::B,             66 },
+        { Key::C,             67 },  { Key::D,             68 },  { Key::E,             69 },  { Key::F,             70 },
+        { Key::G,             71 },  { Key::H,             72 },  { Key::I,             73 },  { Key::J,             74 },
+        { Key::K,             75 },  { Key::L,             76 },  { Key::M,             77 },  { Key::N,             78 },
+        { Key::O,             79 },  { Key::P,             80 },  { Key::Q,             81 },  { Key::R,             82 },
+        { Key::S,             83 },  { Key::T,             84 },  { Key::U,             85 },  { Key::V,             86 },
+        { Key::W,             87 },  { Key::X,             88 },  { Key::Y,             89 },  { Key::Z,             90 },
+        { Key::LeftBracket,   91 },  { Key::Backslash,     92 },  { Key::RightBracket,  93 },  { Key::GraveAccent,   96 },
+        { Key::World1,        161 }, { Key::World2,        162 }, { Key::Escape,        256 }, { Key::Enter,         257 },
+        { Key::Tab,           258 }, { Key::Backspace,     259 }, { Key::Insert,        260 }, { Key::Delete,        261 },
+        { Key::Right,         262 }, { Key::Left,          263 }, { Key::Down,          264 }, { Key::Up,            265 },
+        { Key::PageUp,        266 }, { Key::PageDown,      267 }, { Key::Home,          268 }, { Key::End,           269 },
+        { Key::CapsLock,      280 }, { Key::ScrollLock,    281 }, { Key::NumLock,       282 }, { Key::PrintScreen,   283 },
+        { Key::Pause,         284 }, { Key::F1,            290 }, { Key::F2,            291 }, { Key::F3,            292 },
+        { Key::F4,            293 }, { Key::F5,            294 }, { Key::F6,            295 }, { Key::F7,            296 },
+        { Key::F8,            297 }, { Key::F9,            298 }, { Key::F10,           299 }, { Key::F11,           300 },
+        { Key::F12,           301 }, { Key::F13,           302 }, { Key::F14,           303 }, { Key::F15,           304 },
+        { Key::F16,           305 }, { Key::F17,           306 }, { Key::F18,           307 }, { Key::F19,           308 },
+        { Key::F20,           309 }, { Key::F21,           310 }, { Key::F22,           311 }, { Key::F23,           312 },
+        { Key::F24,           313 }, { Key::F25,           314 }, { Key::KP0,           320 }, { Key::KP1,           321 },
+        { Key::KP2,           322 }, { Key::KP3,           323 }, { Key::KP4,           324 }, { Key::KP5,           325 },
+        { Key::KP6,           326 }, { Key::KP7,           327 }, { Key::KP8,           328 }, { Key::KP9,           329 },
+        { Key::KPDecimal,     330 }, { Key::KPDivide,      331 }, { Key::KPMultiply,    332 }, { Key::KPSubtract,    333 },
+        { Key::KPAdd,         334 }, { Key::KPEnter,       335 }, { Key::KPEqual,       336 }, { Key::LeftShift,     340 },
+        { Key::LeftControl,   341 }, { Key::LeftAlt,       342 }, { Key::LeftSuper,     343 }, { Key::RightShift,    344 },
+        { Key::RightControl,  345 }, { Key::RightAlt,      346 }, { Key::RightSuper,    347 }, { Key::Menu,          348 },
+    };
+
+    constexpr auto c_HEToGLFWKey = [] {
+        std::array<int16_t, Key::Count> table = {};
+        table.fill(-1);
+        for (auto [key, glfwKey] : c_KeyToGLFWKey)
+            table[key] = int16_t(glfwKey);
+        return table;
+    }();
+
+    constexpr auto c_GLFWToHEKey = [] {
+        std::array<KeyCode, GLFW_KEY_LAST + 1> table = {};
+        table.fill(KeyCode(-1));
+        for (auto [key, glfwKey] : c_KeyToGLFWKey)
+            table[glfwKey] = key;
+        return table;
+    }();
+
+    static_assert(std::size(c_KeyToGLFWKey) == Key::Count);
+
+    static int ToGLFWKeyCode(KeyCode keyCode)
+    {
+        return keyCode < Key::Count ? c_HEToGLFWKey[keyCode] : -1;
+    }
+
+    static KeyCode ToHEKeyCode(int keyCode)
+    {
+        return keyCode >= 0 && keyCode <= GLFW_KEY_LAST ? c_GLFWToHEKey[keyCode] : KeyCode(-1);
+    }
+
+    static int ToGLFWCursorMode(Cursor::Mode mode)
+    {
+        switch (mode)
+        {
+        case Cursor::Mode::Normal:   return GLFW_CURSOR_NORMAL;
+        case Cursor::Mode::Hidden:   return GLFW_CURSOR_HIDDEN;
+        case Cursor::Mode::Disabled: return GLFW_CURSOR_DISABLED;
+        }
+
+        return GLFW_CURSOR_NORMAL;
+    }
+
+    float Application::GetTime() { return static_cast<float>(glfwGetTime()); }
+
+    uint64_t Application::GetTimestamp() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+    static uint8_t s_GLFWWindowCount = 0;
+
+    static const struct
+    {
+        nvrhi::Format format;
+        uint32_t redBits;
+        uint32_t greenBits;
+        uint32_t blueBits;
+        uint32_t alphaBits;
+        uint32_t depthBits;
+        uint32_t stencilBits;
+    } formatInfo[] = {
+        { nvrhi::Format::UNKNOWN,            0,  0,  0,  0,  0,  0, },
+        { nvrhi::Format::R8_UINT,            8,  0,  0,  0,  0,  0, },
+        { nvrhi::Format::RG8_UINT,           8,  8,  0,  0,  0,  0, },
+        { nvrhi::Format::RG8_UNORM,          8,  8,  0,  0,  0,  0, },
+        { nvrhi::Format::R16_UINT,          16,  0,  0,  0,  0,  0, },
+        { nvrhi::Format::R16_UNORM,         16,  0,  0,  0,  0,  0, },
+        { nvrhi::Format::R16_FLOAT,         16,  0,  0,  0,  0,  0, },
+        { nvrhi::Format::RGBA8_UNORM,        8,  8,  8,  8,  0,  0, },
+        { nvrhi::Format::RGBA8_SNORM,        8,  8,  8,  8,  0,  0, },
+        { nvrhi::Format::BGRA8_UNORM,        8,  8,  8,  8,  0,  0, },
+        { nvrhi::Format::SRGBA8_UNORM,       8,  8,  8,  8,  0,  0, },
+        { nvrhi::Format::SBGRA8_UNORM,       8,  8,  8,  8,  0,  0, },
+        { nvrhi::Format::R10G10B10A2_UNORM, 10, 10, 10,  2,  0,  0, },
+        { nvrhi::Format::R11G11B10_FLOAT,   11, 11, 10,  0,  0,  0, },
+        { nvrhi::Format::RG16_UINT,         16, 16,  0,  0,  0,  0, },
+        { nvrhi::Format::RG16_FLOAT,        16, 16,  0,  0,  0,  0, },
+        { nvrhi::Format::R32_UINT,          32,  0,  0,  0,  0,  0, },
+        { nvrhi::Format::R32_FLOAT,         32,  0,  0,  0,  0,  0, },
+        { nvrhi::Format::RGBA16_FLOAT,      16, 16, 16, 16,  0,  0, },
+        { nvrhi::Format::RGBA16_UNORM,      16, 16, 16, 16,  0,  0, },
+        { nvrhi::Format::RGBA16_SNORM,      16, 16, 16, 16,  0,  0, },
+        { nvrhi::Format::RG32_UINT,         32, 32,  0,  0,  0,  0, },
+        { nvrhi::Format::RG32_FLOAT,        32, 32,  0,  0,  0,  0, },
+        { nvrhi::Format::RGB32_UINT,        32, 32, 32,  0,  0,  0, },
+        { nvrhi::Format::RGB32_FLOAT,       32, 32, 32,  0,  0,  0, },
+        { nvrhi::Format::RGBA32_UINT,       32, 32, 32, 32,  0,  0, },
+        { nvrhi::Format::RGBA32_FLOAT,      32, 32, 32, 32,  0,  0, },
+    };
+
+    static void GLFWErrorCallback(int error, const char* description)
+    {
+        HE_CORE_ERROR("[GLFW] : ({}): {}", error, description);
+    }
+
+    static void UpdateInputState(InputState& state, Event& e)
+    {
+        InputSnapshot& live = state.live;
+
+        if (e.GetCategory() != EventCategory::Window)
+            live.latestInputTimestamp = std::max(live.latestInputTimestamp, e.timestamp);
+
+        switch (e.GetEventType())
+        {
+        case EventType::KeyPressed:
+        {
+            auto& k = static_cast<KeyPressedEvent&>(e);
+            if (k.keyCode < Key::Count && !k.isRepeat)
+            {
+                live.keyDown.set(k.keyCode);
+                live.keyPressed.set(k.keyCode);
+            }
+            break;
+        }
+        case EventType::KeyReleased:
+        {
+            auto& k = static_cast<KeyReleasedEvent&>(e);
+            if (k.keyCode < Key::Count)
+            {
+                live.keyDown.reset(k.keyCode);
+                live.keyReleased.set(k.keyCode);
+            }
+            break;
+        }
+        case EventType::MouseButtonPressed:
+        {
+            auto& m = static_cast<MouseButtonPressedEvent&>(e);
+            if (m.button < MouseKey::Count)
+            {
+                live.mouseButtonDown.set(m.button);
+                live.mouseButtonPressed.set(m.button);
+            }
+            break;
+        }
+        case EventType::MouseButtonReleased:
+        {
+            auto& m = static_cast<MouseButtonReleasedEvent&>(e);
+            if (m.button < MouseKey::Count)
             {
-                func();
+                live.mouseButtonDown.reset(m.button);
+                live.mouseButtonReleased.set(m.button);
             }
-            else
+            break;
+        }
+        case EventType::MouseMoved:
+        {
+            auto& m = static_cast<MouseMovedEvent&>(e);
+            live.mouseX = m.x;
+            live.mouseY = m.y;
+            break;
+        }
+        case EventType::MouseScrolled:
+        {
+            auto& m = static_cast<MouseScrolledEvent&>(e);
+            live.scrollX += m.xOffset;
+            live.scrollY += m.yOffset;
+            break;
+        }
+        case EventType::GamepadButtonPressed:
+        {
+            auto& g = static_cast<GamepadButtonPressedEvent&>(e);
+            live.gamepadButtonDown[g.joystickCode].set(g.button);
+            live.gamepadButtonPressed[g.joystickCode].set(g.button);
+            break;
+        }
+        case EventType::GamepadButtonReleased:
+        {
+            auto& g = static_cast<GamepadButtonReleasedEvent&>(e);
+            live.gamepadButtonDown[g.joystickCode].reset(g.button);
+            live.gamepadButtonReleased[g.joystickCode].set(g.button);
+            break;
+        }
+        case EventType::GamepadAxisMoved:
+        {
+            auto& g = static_cast<GamepadAxisMovedEvent&>(e);
+            live.gamepadAxes[g.joystickId][g.axisCode] = { g.x, g.y };
+            break;
+        }
+        case EventType::GamepadConnected:
+        {
+            auto& g = static_cast<GamepadConnectedEvent&>(e);
+            live.gamepadConnected.set(g.joystickCode, g.connected);
+            if (!g.connected)
             {
-                HE_CORE_WARN("UnloadModule failed: Module {} does not define an OnModuleShutdown function.", moduleData->name);
+                live.gamepadButtonDown[g.joystickCode].reset();
+                live.gamepadAxes[g.joystickCode][GamepadAxis::Left] = {};
+                live.gamepadAxes[g.joystickCode][GamepadAxis::Right] = {};
             }
+            break;
+        }
+        default: break;
+        }
+    }
 
-            c.modules.erase(it);
+    struct InputRecordFileHeader
+    {
+        char magic[4] = { 'H', 'E', 'I', 'R' };
+        uint32_t version = 1;
+        uint32_t recordSize = sizeof(InputRecord);
+    };
 
-            return true;
-        }
+    static bool ToInputRecord(const Event& e, InputRecord& r)
+    {
+        r = {};
+        r.type = uint8_t(e.GetEventType());
 
-        Ref<ModuleData> GetModuleData(ModuleHandle handle)
+        switch (e.GetEventType())
         {
-            HE_PROFILE_FUNCTION();
+        case EventType::KeyPressed:            { auto& k = static_cast<const KeyPressedEvent&>(e);            r.code = k.keyCode; r.flags = k.isRepeat; return true; }
+        case EventType::KeyReleased:           { auto& k = static_cast<const KeyReleasedEvent&>(e);           r.code = k.keyCode; return true; }
+        case EventType::KeyTyped:              { auto& k = static_cast<const KeyTypedEvent&>(e);              r.value = k.codePoint; return true; }
+        case EventType::MouseButtonPressed:    { auto& m = static_cast<const MouseButtonPressedEvent&>(e);    r.code = m.button; return true; }
+        case EventType::MouseButtonReleased:   { auto& m = static_cast<const MouseButtonReleasedEvent&>(e);   r.code = m.button; return true; }
+        case EventType::MouseMoved:            { auto& m = static_cast<const MouseMovedEvent&>(e);            r.x = m.x; r.y = m.y; return true; }
+        case EventType::MouseScrolled:         { auto& m = static_cast<const MouseScrolledEvent&>(e);         r.x = m.xOffset; r.y = m.yOffset; return true; }
+        case EventType::MouseEnter:            { auto& m = static_cast<const MouseEnterEvent&>(e);            r.flags = m.entered; return true; }
+        case EventType::GamepadButtonPressed:  { auto& g = static_cast<const GamepadButtonPressedEvent&>(e);  r.code = g.joystickCode; r.value = g.button; return true; }
+        case EventType::GamepadButtonReleased: { auto& g = static_cast<const GamepadButtonReleasedEvent&>(e); r.code = g.joystickCode; r.value = g.button; return true; }
+        case EventType::GamepadAxisMoved:      { auto& g = static_cast<const GamepadAxisMovedEvent&>(e);      r.code = g.joystickId; r.value = g.axisCode; r.x = g.x; r.y = g.y; return true; }
+        case EventType::GamepadConnected:      { auto& g = static_cast<const GamepadConnectedEvent&>(e);      r.code = g.joystickCode; r.flags = g.connected; return true; }
+        default: return false; // window events are not part of the input stream
+        }
+    }
 
-            auto& c = GetAppContext().modulesContext;
+    static void FlushInputRecords(InputState& state)
+    {
+        HE_PROFILE_FUNCTION();
 
-            auto it = c.modules.find(handle);
-            if (it != c.modules.end())
-                return it->second;
+        if (state.records.empty())
+            return;
 
-            HE_CORE_ERROR("Module with handle {} not found.", handle);
-            return nullptr;
+        std::ofstream file(state.recordFilePath, std::ios::binary | std::ios::app);
+        if (!file.is_open())
+        {
+            HE_CORE_ERROR("Input : Unable to open input record file {}", state.recordFilePath.string());
+            state.records.clear();
+            return;
         }
+
+        file.write((const char*)state.records.data(), state.records.size() * sizeof(InputRecord));
+        state.records.clear();
     }
 
-    //////////////////////////////////////////////////////////////////////////
-    // Plugins
-    //////////////////////////////////////////////////////////////////////////
+    // every window event goes through here so the live input state stays in sync with what layers see
+    static void EmitEvent(Window& w, Event& e, bool replayed = false)
+    {
+        InputState& state = w.inputData;
 
-    namespace Plugins {
+        if (state.replaying && !replayed && e.GetCategory() != EventCategory::Window)
+            return;
 
-        bool DeserializePluginDesc(const std::filesystem::path& filePath, PluginDesc& desc)
-        {
-            HE_PROFILE_FUNCTION();
+        if (e.timestamp == 0)
+            e.timestamp = Application::GetTimestamp();
 
-            static simdjson::dom::parser parser;
+        UpdateInputState(state, e);
 
-            simdjson::dom::element pluginDescriptor;
-            auto error = parser.load(filePath.string()).get(pluginDescriptor);
-            if (error)
+        if (state.recording)
+        {
+            InputRecord record;
+            if (ToInputRecord(e, record))
             {
-                HE_CORE_ERROR("Failed to load .hplugin file {}\n    {}", filePath.string(), simdjson::error_message(error));
-                return false;
+                record.frameIndex = GetAppContext().frameIndex - state.recordStartFrame;
+                state.records.push_back(record);
+
+                if (state.records.size() >= 4096)
+                    FlushInputRecords(state);
             }
+        }
 
-            std::string_view name;
-            desc.name = (pluginDescriptor["name"].get(name) != simdjson::SUCCESS) ? "" : name;
+        if (w.eventCallback)
+            w.eventCallback(e);
+    }
 
-            std::string_view description;
-            desc.description = (pluginDescriptor["description"].get(description) != simdjson::SUCCESS) ? "" : description;
+    static void EmitInputRecord(Window& w, const InputRecord& r)
+    {
+        switch (EventType(r.type))
+        {
+        case EventType::KeyPressed:            { KeyPressedEvent e(r.code, r.flags);                                  EmitEvent(w, e, true); break; }
+        case EventType::KeyReleased:           { KeyReleasedEvent e(r.code);                                          EmitEvent(w, e, true); break; }
+        case EventType::KeyTyped:              { KeyTypedEvent e(r.value);                                            EmitEvent(w, e, true); break; }
+        case EventType::MouseButtonPressed:    { MouseButtonPressedEvent e(r.code);                                   EmitEvent(w, e, true); break; }
+        case EventType::MouseButtonReleased:   { MouseButtonReleasedEvent e(r.code);                                  EmitEvent(w, e, true); break; }
+        case EventType::MouseMoved:            { MouseMovedEvent e(r.x, r.y);                                         EmitEvent(w, e, true); break; }
+        case EventType::MouseScrolled:         { MouseScrolledEvent e(r.x, r.y);                                      EmitEvent(w, e, true); break; }
+        case EventType::MouseEnter:            { MouseEnterEvent e(r.flags);                                          EmitEvent(w, e, true); break; }
+        case EventType::GamepadButtonPressed:  { GamepadButtonPressedEvent e(r.code, GamepadCode(r.value));          EmitEvent(w, e, true); break; }
+        case EventType::GamepadButtonReleased: { GamepadButtonReleasedEvent e(r.code, GamepadCode(r.value));         EmitEvent(w, e, true); break; }
+        case EventType::GamepadAxisMoved:      { GamepadAxisMovedEvent e(r.code, GamepadAxisCode(r.value), r.x, r.y); EmitEvent(w, e, true); break; }
+        case EventType::GamepadConnected:      { GamepadConnectedEvent e(r.code, r.flags);                            EmitEvent(w, e, true); break; }
+        default: HE_CORE_WARN("Input : Skipping unknown input record type {}", r.type); break;
+        }
+    }
 
-            std::string_view URL;
-            desc.URL = (pluginDescriptor["URL"].get(URL) != simdjson::SUCCESS) ? "" : URL;
+    // radial dead zone over n sticks stored as separate x/y arrays, written so the compiler can vectorize it
+    static void ApplyDeadZone(float* x, float* y, int n, float deadZone)
+    {
+        const float invRange = 1.0f / (1.0f - deadZone);
 
-            pluginDescriptor["reloadable"].get(desc.reloadable);
-            pluginDescriptor["enabledByDefault"].get(desc.enabledByDefault);
+        for (int i = 0; i < n; i++)
+        {
+            float length = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+            float scale = std::max(length - deadZone, 0.0f) * invRange;
+            x[i] = std::clamp(x[i] * scale, -1.0f, 1.0f);
+            y[i] = std::clamp(y[i] * scale, -1.0f, 1.0f);
+        }
+    }
 
-            simdjson::dom::array modulesArray;
-            pluginDescriptor["modules"].get(modulesArray);
-            desc.modules.reserve(modulesArray.size());
-            for (simdjson::dom::element module : modulesArray)
-            {
-                std::string_view moduleName;
-                module.get(moduleName);
-                desc.modules.emplace_back(moduleName);
-            }
+    static void PollGamepads(Window& w)
+    {
+        HE_PROFILE_FUNCTION();
 
-            simdjson::dom::array pluginsArray;
-            pluginDescriptor["plugins"].get(pluginsArray);
-            desc.plugins.reserve(pluginsArray.size());
-            for (simdjson::dom::element plugin : pluginsArray)
-            {
-                std::string_view pluginName;
-                plugin.get(pluginName);
-                desc.plugins.emplace_back(pluginName);
-            }
+        InputState& state = w.inputData;
 
-            return true;
-        }
+        uint32_t active = state.activeGamepads.load(std::memory_order_relaxed);
+        if (active == 0)
+            return;
 
-        Ref<Plugin> GetOrCreatePluginObject(const std::filesystem::path& descFilePath)
+        constexpr int c_MaxSticks = Joystick::Count * GamepadAxis::Count;
+        float axisX[c_MaxSticks], axisY[c_MaxSticks];
+        JoystickCode stickPad[c_MaxSticks];
+        int stickCount = 0;
+
+        for (uint32_t mask = active; mask; mask &= mask - 1)
         {
-            HE_PROFILE_FUNCTION();
+            JoystickCode jid = JoystickCode(std::countr_zero(mask));
 
-            auto& ctx = GetAppContext().pluginContext;
+            GLFWgamepadstate gamepad;
+            if (!glfwGetGamepadState(jid, &gamepad))
+                continue;
 
-            PluginDesc desc;
-            DeserializePluginDesc(descFilePath, desc);
-            PluginHandle handle = Hash(desc.name);
+            std::bitset<GamepadButton::Count> down;
+            for (int button = 0; button < GamepadButton::Count; button++)
+                down.set(button, gamepad.buttons[button] == GLFW_PRESS);
 
-            if (ctx.plugins.contains(handle))
-                return ctx.plugins.at(handle);
+            auto changed = down ^ state.gamepadButtonPrevFrame[jid];
+            state.gamepadButtonPrevFrame[jid] = down;
 
-            Ref<Plugin> plugin = CreateRef<Plugin>(desc);
-            plugin->descFilePath = descFilePath;
-            ctx.plugins[handle] = plugin;
+            for (GamepadCode button = 0; changed.any() && button < GamepadButton::Count; button++)
+            {
+                if (!changed.test(button))
+                    continue;
 
-            return plugin;
+                if (down.test(button))
+                {
+                    GamepadButtonPressedEvent e(jid, button);
+                    EmitEvent(w, e);
+                }
+                else
+                {
+                    GamepadButtonReleasedEvent e(jid, button);
+                    EmitEvent(w, e);
+                }
+            }
+
+            stickPad[stickCount] = jid;
+            axisX[stickCount] = gamepad.axes[GLFW_GAMEPAD_AXIS_LEFT_X];
+            axisY[stickCount] = gamepad.axes[GLFW_GAMEPAD_AXIS_LEFT_Y];
+            stickCount++;
+
+            stickPad[stickCount] = jid;
+            axisX[stickCount] = gamepad.axes[GLFW_GAMEPAD_AXIS_RIGHT_X];
+            axisY[stickCount] = gamepad.axes[GLFW_GAMEPAD_AXIS_RIGHT_Y];
+            stickCount++;
         }
 
-        void LoadPlugin(const std::filesystem::path& descriptor)
+        ApplyDeadZone(axisX, axisY, stickCount, state.deadZoon);
+
+        for (int i = 0; i < stickCount; i++)
         {
-            HE_PROFILE_FUNCTION();
+            GamepadAxisCode axis = GamepadAxisCode(i % GamepadAxis::Count);
+            state.live.gamepadAxes[stickPad[i]][axis] = { axisX[i], axisY[i] };
 
-            auto lexicallyNormal = descriptor.lexically_normal();
-            if (!std::filesystem::exists(lexicallyNormal))
+            if (axisX[i] != 0.0f || axisY[i] != 0.0f)
             {
-                HE_CORE_ERROR("LoadPlugin failed: file {} does not exist.", lexicallyNormal.string());
-                return;
+                GamepadAxisMovedEvent e(stickPad[i], axis, axisX[i], axisY[i]);
+                EmitEvent(w, e);
             }
-
-            Ref<Plugin> plugin = GetOrCreatePluginObject(lexicallyNormal);
-            auto handle = Hash(plugin->desc.name);
-            LoadPlugin(handle);
         }
+    }
 
-        void LoadPlugin(PluginHandle handle)
-        {
-            HE_PROFILE_FUNCTION();
+    // GLFW's joystick functions are main thread only and glfwPollEvents updates the same state, so this thread
+    // reads the pads through OS::ReadGamepads and never calls into GLFW
+    static void InputThreadMain(Window* w)
+    {
+        Profiler::SetThreadName("Input");
 
-            auto& ctx = GetAppContext().pluginContext;
+        InputState& state = w->inputData;
+        auto period = std::chrono::nanoseconds(1'000'000'000ull / std::max(w->desc.inputSampleRate, 1u));
+        auto next = std::chrono::steady_clock::now();
+
+        intptr_t gamepads = OS::OpenGamepads();
+        OS::GamepadState pads[Joystick::Count];
+        OS::GamepadState prev[Joystick::Count];
 
-            auto it = ctx.plugins.find(handle);
-            if (it == ctx.plugins.end()) return;
+        // droppedSamples is reset by each drain for the warning, the metric keeps the running total
+        Metrics::Counter& droppedMetric = Metrics::GetCounter("he_input_dropped_samples_total", "Input thread samples dropped because the queue was full");
 
-            Ref<Plugin> plugin = it->second;
-            const auto& dependences = plugin->desc.plugins;
+        auto push = [&state, &droppedMetric](const InputSample& sample) {
+            if (state.samples.Push(sample))
+                return true;
+
+            state.droppedSamples.fetch_add(1, std::memory_order_relaxed);
+            droppedMetric.Increment();
+            return false;
+        };
 
-            if (dependences.size() > 0)
+        while (state.inputThreadRunning.load(std::memory_order_relaxed))
+        {
+            OS::ReadGamepads(gamepads, pads);
+            uint64_t timestamp = Application::GetTimestamp();
+
+            for (int jid = 0; jid < Joystick::Count; jid++)
             {
-                auto pluginsDir = plugin->descFilePath.parent_path().parent_path();
+                const OS::GamepadState& gamepad = pads[jid];
+
+                // connection changes are reported in the same slot space as the buttons and axes, a change that
+                // did not fit in the queue is retried on the next sample so the connected state cannot get stuck
+                if (gamepad.connected != prev[jid].connected && !push({ timestamp, { .type = uint8_t(EventType::GamepadConnected), .flags = uint8_t(gamepad.connected), .code = uint16_t(jid) } }))
+                    continue;
 
-                for (const auto& dependencyPluginName : dependences)
+                if (!gamepad.connected)
                 {
-                    auto pluginsDescFilePath = pluginsDir / dependencyPluginName / (dependencyPluginName + c_PluginDescriptorExtension);
-                    if (std::filesystem::exists(pluginsDescFilePath))
-                        GetOrCreatePluginObject(pluginsDescFilePath);
+                    prev[jid] = {};
+                    continue;
                 }
-            }
-
-            for (const auto& dependencyPluginName : dependences)
-            {
-                PluginHandle dependencyPluginHandle = Hash(dependencyPluginName);
 
-                if (ctx.plugins.contains(dependencyPluginHandle))
+                for (uint32_t changed = gamepad.buttons ^ prev[jid].buttons; changed; changed &= changed - 1)
                 {
-                    auto dependencyPlugin = ctx.plugins.at(dependencyPluginHandle);
-                    if (!dependencyPlugin->enabled)
-                    {
-                        LoadPlugin(dependencyPluginHandle);
-                    }
+                    int button = std::countr_zero(changed);
+                    EventType type = (gamepad.buttons >> button) & 1 ? EventType::GamepadButtonPressed : EventType::GamepadButtonReleased;
+                    push({ timestamp, { .type = uint8_t(type), .code = uint16_t(jid), .value = uint32_t(button) } });
                 }
-            }
 
-            plugin->enabled = true;
+                for (int axis = 0; axis < GamepadAxis::Count; axis++)
+                {
+                    float x = gamepad.axes[axis * 2];
+                    float y = gamepad.axes[axis * 2 + 1];
+                    if (x == prev[jid].axes[axis * 2] && y == prev[jid].axes[axis * 2 + 1])
+                        continue;
 
-            HE_CORE_INFO("Plugins::LoadPlugin {}", plugin->desc.name);
+                    push({ timestamp, { .type = uint8_t(EventType::GamepadAxisMoved), .code = uint16_t(jid), .value = uint32_t(axis), .x = x, .y = y } });
+                }
 
-            // Load Modules
-            for (const auto& moduleName : plugin->desc.modules)
-            {
-                auto modulePath = plugin->BinariesDirectory() / std::format("{}-{}", c_System, c_Architecture) / c_BuildConfig / (moduleName + c_SharedLibExtension);
-                Modules::LoadModule(modulePath);
+                prev[jid] = gamepad;
             }
+
+            next += period;
+            std::this_thread::sleep_until(next);
         }
 
-        bool UnloadPlugin(PluginHandle handle)
+        OS::CloseGamepads(gamepads);
+    }
+
+    static void DrainInputSamples(Window& w)
+    {
+        HE_PROFILE_FUNCTION();
+
+        InputState& state = w.inputData;
+
+        uint32_t dropped = state.droppedSamples.exchange(0, std::memory_order_relaxed);
+        if (dropped)
+            HE_CORE_WARN("Input : input thread dropped {} samples", dropped);
+
+        InputSample sample;
+        while (state.samples.Pop(sample))
         {
-            HE_PROFILE_FUNCTION();
+            InputRecord& r = sample.record;
 
-            auto& ctx = GetAppContext().pluginContext;
+            switch (EventType(r.type))
+            {
+            case EventType::GamepadButtonPressed:
+            {
+                GamepadButtonPressedEvent e(r.code, GamepadCode(r.value));
+                e.timestamp = sample.timestamp;
+                EmitEvent(w, e);
+                break;
+            }
+            case EventType::GamepadButtonReleased:
+            {
+                GamepadButtonReleasedEvent e(r.code, GamepadCode(r.value));
+                e.timestamp = sample.timestamp;
+                EmitEvent(w, e);
+                break;
+            }
+            case EventType::GamepadConnected:
+            {
+                if (r.flags)
+                    state.activeGamepads.fetch_or(1u << r.code, std::memory_order_relaxed);
+                else
+                    state.activeGamepads.fetch_and(~(1u << r.code), std::memory_order_relaxed);
 
-            if (ctx.plugins.contains(handle))
+                GamepadConnectedEvent e(r.code, r.flags);
+                e.timestamp = sample.timestamp;
+                EmitEvent(w, e);
+                break;
+            }
+            case EventType::GamepadAxisMoved:
             {
-                const Ref<Plugin>& plugin = ctx.plugins.at(handle);
-                if (plugin->enabled)
-                {
-                    const auto& modulesNames = plugin->desc.modules;
+                float x = r.x, y = r.y;
+                ApplyDeadZone(&x, &y, 1, state.deadZoon);
 
-                    // Load Modules
-                    bool res = true;
-                    for (const auto& name : modulesNames)
-                    {
-                        auto modulePath = plugin->BinariesDirectory() / std::format("{}-{}", c_System, c_Architecture) / c_BuildConfig / (name + c_SharedLibExtension);
-                        auto moduleHandle = Hash(modulePath);
-                        res = Modules::UnloadModule(moduleHandle);
-                        if (!res) break;
-                    }
-                    if (res)
-                    {
-                        plugin->enabled = false;
-                    }
-                    return true;
-                }
-                else
+                // the stick returning into the dead zone still has to reach the input state
+                state.live.gamepadAxes[r.code][r.value] = { x, y };
+
+                if (x != 0.0f || y != 0.0f)
                 {
-                    return true;
+                    GamepadAxisMovedEvent e(r.code, GamepadAxisCode(r.value), x, y);
+                    e.timestamp = sample.timestamp;
+                    EmitEvent(w, e);
                 }
+                break;
+            }
+            default: break;
             }
-
-            HE_CORE_ERROR("UnloadPlugin : failed to Unload Plugin {}", handle);
-
-            return false;
         }
+    }
 
-        void ReloadPlugin(PluginHandle handle)
-        {
-            HE_PROFILE_FUNCTION();
-
-            auto& ctx = GetAppContext().pluginContext;
+    static void ReplayInputFrame(Window& w)
+    {
+        HE_PROFILE_FUNCTION();
 
-            std::filesystem::path pluginDescFilePath;
+        InputState& state = w.inputData;
+        uint64_t frame = GetAppContext().frameIndex - state.replayStartFrame;
 
-            if (ctx.plugins.contains(handle))
-                pluginDescFilePath = ctx.plugins.at(handle)->descFilePath;
+        // axis events are only emitted while a stick is outside the dead zone
+        for (auto& axes : state.live.gamepadAxes)
+            for (auto& axis : axes)
+                axis = {};
 
-            UnloadPlugin(handle);
-            ctx.plugins.erase(handle);
-            LoadPlugin(pluginDescFilePath);
-        }
+        while (state.replayCursor < state.replayRecords.size() && state.replayRecords[state.replayCursor].frameIndex <= frame)
+            EmitInputRecord(w, state.replayRecords[state.replayCursor++]);
 
-        const Ref<Plugin> GetPlugin(PluginHandle handle)
+        if (state.replayCursor >= state.replayRecords.size())
         {
-            auto& ctx = GetAppContext().pluginContext;
-            if (ctx.plugins.contains(handle))
-                return ctx.plugins.at(handle);
+            HE_CORE_INFO("Input : Replay finished after {} frames", frame);
+            state.replaying = false;
 
-            return nullptr;
+            if (GetAppContext().applicatoinDesc.exitAfterReplay)
+                Application::Shutdown();
         }
+    }
 
-        void LoadPluginsInDirectory(const std::filesystem::path& directory)
-        {
-            HE_PROFILE_FUNCTION();
-
-            auto& ctx = GetAppContext().pluginContext;
-
-            if (!std::filesystem::exists(directory))
-            {
-                HE_CORE_ERROR("LoadPluginsInDirectory failed: directory {} does not exist.", directory.string());
-                return;
-            }
+    // used when the window was created without callbacks, one GLFW query per key per frame instead of one per Input:: call
+    static void PollInputState(Window& w)
+    {
+        HE_PROFILE_FUNCTION();
 
-            PluginHandle discoveredPLugins[4096];
-            uint32_t count = 0;
+        GLFWwindow* window = (GLFWwindow*)w.handle;
+        InputSnapshot& live = w.inputData.live;
 
+        for (KeyCode key = 0; key < Key::Count; key++)
+        {
+            bool down = glfwGetKey(window, ToGLFWKeyCode(key)) == GLFW_PRESS;
+            if (down != live.keyDown.test(key))
             {
-                HE_PROFILE_SCOPE("Find Plugins");
-
-                for (const auto& entry : std::filesystem::directory_iterator(directory))
-                {
-                    auto pluginsDescFilePath = entry.path() / (entry.path().stem().string() + c_PluginDescriptorExtension);
-
-                    if (std::filesystem::exists(pluginsDescFilePath))
-                    {
-                        Ref<Plugin> plugin = GetOrCreatePluginObject(pluginsDescFilePath);
-                        discoveredPLugins[count] = Hash(plugin->desc.name);
-                        count++;
-                    }
-                }
+                down ? live.keyPressed.set(key) : live.keyReleased.set(key);
+                live.keyDown.set(key, down);
             }
+        }
 
+        for (MouseCode button = 0; button < MouseKey::Count; button++)
+        {
+            bool down = glfwGetMouseButton(window, button) == GLFW_PRESS;
+            if (down != live.mouseButtonDown.test(button))
             {
-                HE_PROFILE_SCOPE("Load Plugins");
-
-                for (uint32_t i = 0; i < count; i++)
-                {
-                    auto handle = discoveredPLugins[i];
-                    if (ctx.plugins.at(handle)->desc.enabledByDefault)
-                        LoadPlugin(handle);
-                }
+                down ? live.mouseButtonPressed.set(button) : live.mouseButtonReleased.set(button);
+                live.mouseButtonDown.set(button, down);
             }
         }
-    }
-       
-    //////////////////////////////////////////////////////////////////////////
-    // Window
-    //////////////////////////////////////////////////////////////////////////
 
-    static int ToGLFWKeyCode(KeyCode keyCode)
-    {
-        switch (keyCode)
-        {
-        case Key::Space:        return 32;
-        case Key::Apostrophe:   return 39;
-        case Key::Comma:        return 44;
-        case Key::Minus:        return 45;
-        case Key::Period:       return 46;
-        case Key::Slash:        return 47;
-        case Key::D0:           return 48;
-        case Key::D1:           return 49;
-        case Key::D2:           return 50;
-        case Key::D3:           return 51;
-        case Key::D4:           return 52;
-        case Key::D5:           return 53;
-        case Key::D6:           return 54;
-        case Key::D7:           return 55;
-        case Key::D8:           return 56;
-        case Key::D9:           return 57;
-        case Key::Semicolon:    return 59;
-        case Key::Equal:        return 61;
-        case Key::A:            return 65;
-        case Key::B:            return 66;
-        case Key::C:            return 67;
-        case Key::D:            return 68;
-        case Key::E:            return 69;
-        case Key::F:            return 70;
-        case Key::G:            return 71;
-        case Key::H:            return 72;
-        case Key::I:            return 73;
-        case Key::J:            return 74;
-        case Key::K:            return 75;
-        case Key::L:            return 76;
-        case Key::M:            return 77;
-        case Key::N:            return 78;
-        case Key::O:            return 79;
-        case Key::P:            return 80;
-        case Key::Q:            return 81;
-        case Key::R:            return 82;
-        case Key::S:            return 83;
-        case Key::T:            return 84;
-        case Key::U:            return 85;
-        case Key::V:            return 86;
-        case Key::W:            return 87;
-        case Key::X:            return 88;
-        case Key::Y:            return 89;
-        case Key::Z:            return 90;
-        case Key::LeftBracket:  return 91;
-        case Key::Backslash:    return 92;
-        case Key::RightBracket: return 93;
-        case Key::GraveAccent:  return 96;
-        case Key::World1:       return 161;
-        case Key::World2:       return 162;
-        case Key::Escape:       return 256;
-        case Key::Enter:        return 257;
-        case Key::Tab:          return 258;
-        case Key::Backspace:    return 259;
-        case Key::Insert:       return 260;
-        case Key::Delete:       return 261;
-        case Key::Right:        return 262;
-        case Key::Left:         return 263;
-        case Key::Down:         return 264;
-        case Key::Up:           return 265;
-        case Key::PageUp:       return 266;
-        case Key::PageDown:     return 267;
-        case Key::Home:         return 268;
-        case Key::End:          return 269;
-        case Key::CapsLock:     return 280;
-        case Key::ScrollLock:   return 281;
-        case Key::NumLock:      return 282;
-        case Key::PrintScreen:  return 283;
-        case Key::Pause:        return 284;
-        case Key::F1:           return 290;
-        case Key::F2:           return 291;
-        case Key::F3:           return 292;
-        case Key::F4:           return 293;
-        case Key::F5:           return 294;
-        case Key::F6:           return 295;
-        case Key::F7:           return 296;
-        case Key::F8:           return 297;
-        case Key::F9:           return 298;
-        case Key::F10:          return 299;
-        case Key::F11:          return 300;
-        case Key::F12:          return 301;
-        case Key::F13:          return 302;
-        case Key::F14:          return 303;
-        case Key::F15:          return 304;
-        case Key::F16:          return 305;
-        case Key::F17:          return 306;
-        case Key::F18:          return 307;
-        case Key::F19:          return 308;
-        case Key::F20:          return 309;
-        case Key::F21:          return 310;
-        case Key::F22:          return 311;
-        case Key::F23:          return 312;
-        case Key::F24:          return 313;
-        case Key::F25:          return 314;
-        case Key::KP0:          return 320;
-        case Key::KP1:          return 321;
-        case Key::KP2:          return 322;
-        case Key::KP3:          return 323;
-        case Key::KP4:          return 324;
-        case Key::KP5:          return 325;
-        case Key::KP6:          return 326;
-        case Key::KP7:          return 327;
-        case Key::KP8:          return 328;
-        case Key::KP9:          return 329;
-        case Key::KPDecimal:    return 330;
-        case Key::KPDivide:     return 331;
-        case Key::KPMultiply:   return 332;
-        case Key::KPSubtract:   return 333;
-        case Key::KPAdd:        return 334;
-        case Key::KPEnter:      return 335;
-        case Key::KPEqual:      return 336;
-        case Key::LeftShift:    return 340;
-        case Key::LeftControl:  return 341;
-        case Key::LeftAlt:      return 342;
-        case Key::LeftSuper:    return 343;
-        case Key::RightShift:   return 344;
-        case Key::RightControl: return 345;
-        case Key::RightAlt:     return 346;
-        case Key::RightSuper:   return 347;
-        case Key::Menu:         return 348;
-        }
-
-        HE_ASSERT("Unknown Key", false);
-        return -1;
-    }
+        double x, y;
+        glfwGetCursorPos(window, &x, &y);
+        live.mouseX = float(x);
+        live.mouseY = float(y);
 
-    static KeyCode ToHEKeyCode(int keyCode)
-    {
-        switch (keyCode)
-        {
-        case 32:  return Key::Space;
-        case 39:  return Key::Apostrophe;
-        case 44:  return Key::Comma;
-        case 45:  return Key::Minus;
-        case 46:  return Key::Period;
-        case 47:  return Key::Slash;
-        case 48:  return Key::D0;
-        case 49:  return Key::D1;
-        case 50:  return Key::D2;
-        case 51:  return Key::D3;
-        case 52:  return Key::D4;
-        case 53:  return Key::D5;
-        case 54:  return Key::D6;
-        case 55:  return Key::D7;
-        case 56:  return Key::D8;
-        case 57:  return Key::D9;
-        case 59:  return Key::Semicolon;
-        case 61:  return Key::Equal;
-        case 65:  return Key::A;
-        case 66:  return Key::B;
-        case 67:  return Key::C;
-        case 68:  return Key::D;
-        case 69:  return Key::E;
-        case 70:  return Key::F;
-        case 71:  return Key::G;
-        case 72:  return Key::H;
-        case 73:  return Key::I;
-        case 74:  return Key::J;
-        case 75:  return Key::K;
-        case 76:  return Key::L;
-        case 77:  return Key::M;
-        case 78:  return Key::N;
-        case 79:  return Key::O;
-        case 80:  return Key::P;
-        case 81:  return Key::Q;
-        case 82:  return Key::R;
-        case 83:  return Key::S;
-        case 84:  return Key::T;
-        case 85:  return Key::U;
-        case 86:  return Key::V;
-        case 87:  return Key::W;
-        case 88:  return Key::X;
-        case 89:  return Key::Y;
-        case 90:  return Key::Z;
-        case 91:  return Key::LeftBracket;
-        case 92:  return Key::Backslash;
-        case 93:  return Key::RightBracket;
-        case 96:  return Key::GraveAccent;
-        case 16:  return Key::World1;
-        case 162: return Key::World2;
-        case 256: return Key::Escape;
-        case 257: return Key::Enter;
-        case 258: return Key::Tab;
-        case 259: return Key::Backspace;
-        case 260: return Key::Insert;
-        case 261: return Key::Delete;
-        case 262: return Key::Right;
-        case 263: return Key::Left;
-        case 264: return Key::Down;
-        case 265: return Key::Up;
-        case 266: return Key::PageUp;
-        case 267: return Key::PageDown;
-        case 268: return Key::Home;
-        case 269: return Key::End;
-        case 280: return Key::CapsLock;
-        case 281: return Key::ScrollLock;
-        case 282: return Key::NumLock;
-        case 283: return Key::PrintScreen;
-        case 284: return Key::Pause;
-        case 290: return Key::F1;
-        case 291: return Key::F2;
-        case 292: return Key::F3;
-        case 293: return Key::F4;
-        case 294: return Key::F5;
-        case 295: return Key::F6;
-        case 296: return Key::F7;
-        case 297: return Key::F8;
-        case 298: return Key::F9;
-        case 299: return Key::F10;
-        case 300: return Key::F11;
-        case 301: return Key::F12;
-        case 302: return Key::F13;
-        case 303: return Key::F14;
-        case 304: return Key::F15;
-        case 305: return Key::F16;
-        case 306: return Key::F17;
-        case 307: return Key::F18;
-        case 308: return Key::F19;
-        case 309: return Key::F20;
-        case 310: return Key::F21;
-        case 311: return Key::F22;
-        case 312: return Key::F23;
-        case 313: return Key::F24;
-        case 314: return Key::F25;
-        case 320: return Key::KP0;
-        case 321: return Key::KP1;
-        case 322: return Key::KP2;
-        case 323: return Key::KP3;
-        case 324: return Key::KP4;
-        case 325: return Key::KP5;
-        case 326: return Key::KP6;
-        case 327: return Key::KP7;
-        case 328: return Key::KP8;
-        case 329: return Key::KP9;
-        case 330: return Key::KPDecimal;
-        case 331: return Key::KPDivide;
-        case 332: return Key::KPMultiply;
-        case 333: return Key::KPSubtract;
-        case 334: return Key::KPAdd;
-        case 335: return Key::KPEnter;
-        case 336: return Key::KPEqual;
-        case 340: return Key::LeftShift;
-        case 341: return Key::LeftControl;
-        case 342: return Key::LeftAlt;
-        case 343: return Key::LeftSuper;
-        case 344: return Key::RightShift;
-        case 345: return Key::RightControl;
-        case 346: return Key::RightAlt;
-        case 347: return Key::RightSuper;
-        case 348: return Key::Menu;
-        }
-
-        HE_ASSERT("Unknown Key", false);
-        return -1;
-    }
+        // no joystick callback either, the input thread reports connections itself
+        if (w.desc.inputThread)
+            return;
 
-    static int ToGLFWCursorMode(Cursor::Mode mode)
-    {
-        switch (mode)
+        uint32_t active = 0;
+        for (int jid = 0; jid < Joystick::Count; jid++)
         {
-        case Cursor::Mode::Normal:   return GLFW_CURSOR_NORMAL;
-        case Cursor::Mode::Hidden:   return GLFW_CURSOR_HIDDEN;
-        case Cursor::Mode::Disabled: return GLFW_CURSOR_DISABLED;
+            bool present = glfwJoystickPresent(jid);
+            live.gamepadConnected.set(jid, present);
+            active |= uint32_t(present) << jid;
         }
-
-        return GLFW_CURSOR_NORMAL;
+        w.inputData.activeGamepads = active;
     }
 
-    float Application::GetTime() { return static_cast<float>(glfwGetTime()); }
+    static void CaptureInputSnapshot(InputState& state, uint64_t frameIndex)
+    {
+        HE_PROFILE_FUNCTION();
 
-    static uint8_t s_GLFWWindowCount = 0;
+        // the next slot that no InputSnapshotHandle pins, the loads pair with the pin and recheck in Input::GetSnapshot
+        uint32_t current = state.currentSnapshot.load(std::memory_order_relaxed);
+        uint32_t next = current;
+        for (uint32_t i = 1; i < InputState::c_SnapshotCount; i++)
+        {
+            uint32_t slot = (current + i) % InputState::c_SnapshotCount;
+            if (state.snapshotPins[slot].load() == 0)
+            {
+                next = slot;
+                break;
+            }
+        }
 
-    static const struct
-    {
-        nvrhi::Format format;
-        uint32_t redBits;
-        uint32_t greenBits;
-        uint32_t blueBits;
-        uint32_t alphaBits;
-        uint32_t depthBits;
-        uint32_t stencilBits;
-    } formatInfo[] = {
-        { nvrhi::Format::UNKNOWN,            0,  0,  0,  0,  0,  0, },
-        { nvrhi::Format::R8_UINT,            8,  0,  0,  0,  0,  0, },
-        { nvrhi::Format::RG8_UINT,           8,  8,  0,  0,  0,  0, },
-        { nvrhi::Format::RG8_UNORM,          8,  8,  0,  0,  0,  0, },
-        { nvrhi::Format::R16_UINT,          16,  0,  0,  0,  0,  0, },
-        { nvrhi::Format::R16_UNORM,         16,  0,  0,  0,  0,  0, },
-        { nvrhi::Format::R16_FLOAT,         16,  0,  0,  0,  0,  0, },
-        { nvrhi::Format::RGBA8_UNORM,        8,  8,  8,  8,  0,  0, },
-        { nvrhi::Format::RGBA8_SNORM,        8,  8,  8,  8,  0,  0, },
-        { nvrhi::Format::BGRA8_UNORM,        8,  8,  8,  8,  0,  0, },
-        { nvrhi::Format::SRGBA8_UNORM,       8,  8,  8,  8,  0,  0, },
-        { nvrhi::Format::SBGRA8_UNORM,       8,  8,  8,  8,  0,  0, },
-        { nvrhi::Format::R10G10B10A2_UNORM, 10, 10, 10,  2,  0,  0, },
-        { nvrhi::Format::R11G11B10_FLOAT,   11, 11, 10,  0,  0,  0, },
-        { nvrhi::Format::RG16_UINT,         16, 16,  0,  0,  0,  0, },
-        { nvrhi::Format::RG16_FLOAT,        16, 16,  0,  0,  0,  0, },
-        { nvrhi::Format::R32_UINT,          32,  0,  0,  0,  0,  0, },
-        { nvrhi::Format::R32_FLOAT,         32,  0,  0,  0,  0,  0, },
-        { nvrhi::Format::RGBA16_FLOAT,      16, 16, 16, 16,  0,  0, },
-        { nvrhi::Format::RGBA16_UNORM,      16, 16, 16, 16,  0,  0, },
-        { nvrhi::Format::RGBA16_SNORM,      16, 16, 16, 16,  0,  0, },
-        { nvrhi::Format::RG32_UINT,         32, 32,  0,  0,  0,  0, },
-        { nvrhi::Format::RG32_FLOAT,        32, 32,  0,  0,  0,  0, },
-        { nvrhi::Format::RGB32_UINT,        32, 32, 32,  0,  0,  0, },
-        { nvrhi::Format::RGB32_FLOAT,       32, 32, 32,  0,  0,  0, },
-        { nvrhi::Format::RGBA32_UINT,       32, 32, 32, 32,  0,  0, },
-        { nvrhi::Format::RGBA32_FLOAT,      32, 32, 32, 32,  0,  0, },
-    };
+        // every other slot is held by jobs, the live state keeps accumulating and its edges carry into the next capture
+        if (next == current)
+        {
+            HE_CORE_WARN("Input : All input snapshots are pinned, frame {} keeps the previous snapshot", frameIndex);
+            return;
+        }
 
-    static void GLFWErrorCallback(int error, const char* description)
-    {
-        HE_CORE_ERROR("[GLFW] : ({}): {}", error, description);
+        const InputSnapshot& prev = state.snapshots[current];
+        InputSnapshot& snapshot = state.snapshots[next];
+
+        snapshot = state.live;
+        snapshot.mouseDeltaX = state.live.mouseX - prev.mouseX;
+        snapshot.mouseDeltaY = state.live.mouseY - prev.mouseY;
+        snapshot.frameIndex = frameIndex;
+
+        state.currentSnapshot.store(next);
+
+        InputSnapshot& live = state.live;
+        live.keyPressed.reset();
+        live.keyReleased.reset();
+        live.mouseButtonPressed.reset();
+        live.mouseButtonReleased.reset();
+        for (auto& b : live.gamepadButtonPressed) b.reset();
+        for (auto& b : live.gamepadButtonReleased) b.reset();
+        live.scrollX = live.scrollY = 0.0f;
+        live.latestInputTimestamp = 0;
     }
 
     void Window::Init(const WindowDesc& windowDesc)
@@ -1501,6 +5222,37 @@ namespace HE {
             desc.swapChainDesc.backBufferHeight = h;
         }
 
+        {
+            double x, y;
+            glfwGetCursorPos(glfwWindow, &x, &y);
+            inputData.live.mouseX = float(x);
+            inputData.live.mouseY = float(y);
+            for (auto& snapshot : inputData.snapshots)
+            {
+                snapshot.mouseX = inputData.live.mouseX;
+                snapshot.mouseY = inputData.live.mouseY;
+            }
+
+            // pads plugged in before startup never produce a connect event, the input thread reports them on its first sample
+            if (!desc.inputThread)
+            {
+                uint32_t active = 0;
+                for (int jid = 0; jid < Joystick::Count; jid++)
+                {
+                    bool present = glfwJoystickPresent(jid);
+                    inputData.live.gamepadConnected.set(jid, present);
+                    active |= uint32_t(present) << jid;
+                }
+                inputData.activeGamepads = active;
+            }
+        }
+
+        if (desc.inputThread)
+        {
+            inputData.inputThreadRunning = true;
+            inputData.inputThread = std::thread(InputThreadMain, this);
+        }
+
         if (!desc.setCallbacks)
             return;
 
@@ -1523,7 +5275,7 @@ namespace HE {
             w.desc.height = height;
 
             WindowResizeEvent event((uint32_t)width, (uint32_t)height);
-            w.eventCallback(event);
+            EmitEvent(w, event);
             });
 
         glfwSetWindowCloseCallback(glfwWindow, [](GLFWwindow* window) {
@@ -1532,7 +5284,7 @@ namespace HE {
 
             Window& w = *(Window*)glfwGetWindowUserPointer(window);
             WindowCloseEvent event;
-            w.eventCallback(event);
+            EmitEvent(w, event);
             });
 
         glfwSetWindowContentScaleCallback(glfwWindow, [](GLFWwindow* window, float xscale, float yscale) {
@@ -1542,7 +5294,7 @@ namespace HE {
             Window& w = *(Window*)glfwGetWindowUserPointer(window);
 
             WindowContentScaleEvent event(xscale, yscale);
-            w.eventCallback(event);
+            EmitEvent(w, event);
             });
 
         glfwSetWindowMaximizeCallback(glfwWindow, [](GLFWwindow* window, int maximized) {
@@ -1582,7 +5334,7 @@ namespace HE {
             isfirstTime = false;
 
             WindowMaximizeEvent event(maximized);
-            w.eventCallback(event);
+            EmitEvent(w, event);
             });
 
         glfwSetKeyCallback(glfwWindow, [](GLFWwindow* window, int key, int scancode, int action, int mods) {
@@ -1596,19 +5348,19 @@ namespace HE {
             case GLFW_PRESS:
             {
                 KeyPressedEvent event(ToHEKeyCode(key), false);
-                w.eventCallback(event);
+                EmitEvent(w, event);
                 break;
             }
             case GLFW_RELEASE:
             {
                 KeyReleasedEvent event(ToHEKeyCode(key));
-                w.eventCallback(event);
+                EmitEvent(w, event);
                 break;
             }
             case GLFW_REPEAT:
             {
                 KeyPressedEvent event(ToHEKeyCode(key), true);
-                w.eventCallback(event);
+                EmitEvent(w, event);
                 break;
             }
             }
@@ -1621,7 +5373,7 @@ namespace HE {
             Window& w = *(Window*)glfwGetWindowUserPointer(window);
 
             KeyTypedEvent event(codePoint);
-            w.eventCallback(event);
+            EmitEvent(w, event);
             });
 
         glfwSetMouseButtonCallback(glfwWindow, [](GLFWwindow* window, int button, int action, int mods) {
@@ -1635,13 +5387,13 @@ namespace HE {
             case GLFW_PRESS:
             {
                 MouseButtonPressedEvent event(button);
-                w.eventCallback(event);
+                EmitEvent(w, event);
                 break;
             }
             case GLFW_RELEASE:
             {
                 MouseButtonReleasedEvent event(button);
-                w.eventCallback(event);
+                EmitEvent(w, event);
                 break;
             }
             }
@@ -1654,7 +5406,7 @@ namespace HE {
             Window& w = *(Window*)glfwGetWindowUserPointer(window);
 
             MouseScrolledEvent event((float)xOffset, (float)yOffset);
-            w.eventCallback(event);
+            EmitEvent(w, event);
             });
 
         glfwSetCursorPosCallback(glfwWindow, [](GLFWwindow* window, double xPos, double yPos) {
@@ -1664,7 +5416,7 @@ namespace HE {
             Window& w = *(Window*)glfwGetWindowUserPointer(window);
 
             MouseMovedEvent event((float)xPos, (float)yPos);
-            w.eventCallback(event);
+            EmitEvent(w, event);
             });
 
         glfwSetCursorEnterCallback(glfwWindow, [](GLFWwindow* window, int entered) {
@@ -1674,7 +5426,7 @@ namespace HE {
             Window& w = *(Window*)glfwGetWindowUserPointer(window);
 
             MouseEnterEvent event((bool)entered);
-            w.eventCallback(event);
+            EmitEvent(w, event);
             });
 
         glfwSetDropCallback(glfwWindow, [](GLFWwindow* window, int pathCount, const char* paths[]) {
@@ -1684,7 +5436,7 @@ namespace HE {
             Window& w = *(Window*)glfwGetWindowUserPointer(window);
 
             WindowDropEvent event(paths, pathCount);
-            w.eventCallback(event);
+            EmitEvent(w, event);
             });
 
         glfwSetJoystickCallback([](int jid, int event) {
@@ -1693,15 +5445,24 @@ namespace HE {
 
             auto& w = GetAppContext().mainWindow;
 
+            // GLFW's joystick ids need not match the input thread's slots, which report connections themselves
+            if (w.desc.inputThread)
+                return;
+
             if (event == GLFW_CONNECTED)
             {
+                w.inputData.activeGamepads.fetch_or(1u << jid, std::memory_order_relaxed);
+
                 GamepadConnectedEvent event(jid, true);
-                w.eventCallback(event);
+                EmitEvent(w, event);
             }
             else if (event == GLFW_DISCONNECTED)
             {
+                w.inputData.activeGamepads.fetch_and(~(1u << jid), std::memory_order_relaxed);
+                w.inputData.gamepadButtonPrevFrame[jid].reset();
+
                 GamepadConnectedEvent event(jid, false);
-                w.eventCallback(event);
+                EmitEvent(w, event);
             }
             });
 
@@ -1718,7 +5479,7 @@ namespace HE {
 
             Window& w = *(Window*)glfwGetWindowUserPointer(window);
             WindowMinimizeEvent event(iconified);
-            w.eventCallback(event);
+            EmitEvent(w, event);
             });
 
         glfwSetWindowPosCallback(glfwWindow, [](GLFWwindow* window, int xpos, int ypos) {
@@ -1744,6 +5505,15 @@ namespace HE {
     {
         HE_PROFILE_FUNCTION();
 
+        if (inputData.inputThread.joinable())
+        {
+            inputData.inputThreadRunning = false;
+            inputData.inputThread.join();
+        }
+
+        if (inputData.recording)
+            FlushInputRecords(inputData);
+
         if (swapChain)
             delete swapChain;
 
@@ -1833,345 +5603,249 @@ namespace HE {
     {
         HE_PROFILE_FUNCTION();
 
-        for (int jid = 0; jid < Joystick::Count; jid++)
-        {
-            if (glfwJoystickPresent(jid))
-            {
-                GLFWgamepadstate state;
-                if (glfwGetGamepadState(jid, &state))
-                {
-                    for (int button = 0; button < GamepadButton::Count; button++)
-                    {
-                        bool isButtonDown = state.buttons[button] == GLFW_PRESS;
-
-                        bool isPressed = isButtonDown && !inputData.gamepadEventButtonDownPrevFrame[jid].test(button);
-                        inputData.gamepadEventButtonDownPrevFrame[jid].set(button, isButtonDown);
-                        if (isPressed)
-                        {
-                            GamepadButtonPressedEvent e(jid, button);
-                            eventCallback(e);
-                        }
-
-                        bool isReleased = !isButtonDown && !inputData.gamepadEventButtonUpPrevFrame[jid].test(button);
-                        inputData.gamepadEventButtonUpPrevFrame[jid].set(button, !isButtonDown);
-                        if (isReleased)
-                        {
-                            GamepadButtonReleasedEvent e(jid, button);
-                            eventCallback(e);
-                        }
-                    }
-
-                    // axes
-                    {
-                        auto createEvent = [](Window& window, int jid, GamepadAxisCode axisCode, Math::vec2 value) {
-
-                            if (Math::length(value) > 0)
-                            {
-                                GamepadAxisMovedEvent event(jid, axisCode, value.x, value.y);
-                                window.eventCallback(event);
-                            }
-                            };
-
-                        {
-                            Math::vec2 v(state.axes[GLFW_GAMEPAD_AXIS_LEFT_X], state.axes[GLFW_GAMEPAD_AXIS_LEFT_Y]);
-                            v *= Math::max(Math::length(v) - inputData.deadZoon, 0.0f) / (1.f - inputData.deadZoon);
-                            v = Math::clamp(v, Math::vec2(-1.0f), Math::vec2(1.0f));
-
-                            createEvent(*this, jid, GamepadAxis::Left, v);
-                        }
-
-                        {
-                            Math::vec2 v(state.axes[GLFW_GAMEPAD_AXIS_RIGHT_X], state.axes[GLFW_GAMEPAD_AXIS_RIGHT_Y]);
-                            v *= Math::max(Math::length(v) - inputData.deadZoon, 0.0f) / (1.f - inputData.deadZoon);
-                            v = Math::clamp(v, Math::vec2(-1.0f), Math::vec2(1.0f));
-
-                            createEvent(*this, jid, GamepadAxis::Right, v);
-                        }
-                    }
-                }
-            }
-        }
+        // headless runs have no window but can still replay input
+        if (handle && !inputData.replaying && !desc.inputThread)
+            PollGamepads(*this);
 
+        if (handle)
         {
             HE_PROFILE_SCOPE("glfwPollEvents");
             glfwPollEvents();
         }
+
+        if (desc.inputThread)
+            DrainInputSamples(*this);
+
+        if (inputData.replaying)
+            ReplayInputFrame(*this);
+        else if (handle && !desc.setCallbacks)
+            PollInputState(*this);
+
+        CaptureInputSnapshot(inputData, GetAppContext().frameIndex);
     }
 
     //////////////////////////////////////////////////////////////////////////
     // Input
     //////////////////////////////////////////////////////////////////////////
 
-    bool Input::IsKeyDown(const KeyCode key)
+    InputSnapshotHandle Input::GetSnapshot()
     {
-        auto& w = GetAppContext().mainWindow;
-        auto window = static_cast<GLFWwindow*>(w.handle);
-        int glfwKey = ToGLFWKeyCode(key);
-        auto state = glfwGetKey(window, glfwKey);
+        InputState& state = GetAppContext().mainWindow.inputData;
+
+        // a capture that moved on between the load and the pin may already be reusing the slot, pin the new one instead
+        while (true)
+        {
+            uint32_t current = state.currentSnapshot.load();
+            state.snapshotPins[current].fetch_add(1);
+            if (state.currentSnapshot.load() == current)
+                return InputSnapshotHandle(&state.snapshots[current], &state.snapshotPins[current]);
 
-        return state == GLFW_PRESS;
+            state.snapshotPins[current].fetch_sub(1, std::memory_order_release);
+        }
     }
 
-    bool Input::IsKeyUp(const KeyCode key)
-    {
-        auto& w = GetAppContext().mainWindow;
-        auto window = static_cast<GLFWwindow*>(w.handle);
-        int glfwKey = ToGLFWKeyCode(key);
-        auto state = glfwGetKey(window, glfwKey);
+    bool Input::IsKeyDown(const KeyCode key) { return GetSnapshot()->IsKeyDown(key); }
 
-        return state == GLFW_RELEASE;
-    }
+    bool Input::IsKeyUp(const KeyCode key) { return GetSnapshot()->IsKeyUp(key); }
 
-    bool Input::IsKeyPressed(const KeyCode key)
-    {
-        auto& w = GetAppContext().mainWindow;
-        auto window = static_cast<GLFWwindow*>(w.handle);
-        int glfwKey = ToGLFWKeyCode(key);
-        auto currentState = glfwGetKey(window, glfwKey);
+    bool Input::IsKeyPressed(const KeyCode key) { return GetSnapshot()->IsKeyPressed(key); }
 
-        bool isKeyDown = currentState == GLFW_PRESS && !w.inputData.keyDownPrevFrame.test(key);
-        w.inputData.keyDownPrevFrame.set(key, currentState == GLFW_PRESS);
+    bool Input::IsKeyReleased(const KeyCode key) { return GetSnapshot()->IsKeyReleased(key); }
 
-        return isKeyDown;
-    }
+    bool Input::IsMouseButtonDown(const MouseCode button) { return GetSnapshot()->IsMouseButtonDown(button); }
 
-    bool Input::IsKeyReleased(const KeyCode key)
-    {
-        auto& w = GetAppContext().mainWindow;
-        auto window = static_cast<GLFWwindow*>(w.handle);
-        int glfwKey = ToGLFWKeyCode(key);
-        auto currentState = glfwGetKey(window, glfwKey);
+    bool Input::IsMouseButtonUp(const MouseCode button) { return GetSnapshot()->IsMouseButtonUp(button); }
 
-        bool isKeyUp = currentState == GLFW_RELEASE && !w.inputData.keyUpPrevFrame.test(key);
-        w.inputData.keyUpPrevFrame.set(key, currentState == GLFW_RELEASE);
+    bool Input::IsMouseButtonPressed(const MouseCode button) { return GetSnapshot()->IsMouseButtonPressed(button); }
 
-        return isKeyUp;
-    }
+    bool Input::IsMouseButtonReleased(const MouseCode button) { return GetSnapshot()->IsMouseButtonReleased(button); }
 
-    bool Input::IsMouseButtonDown(const MouseCode button)
-    {
-        auto& w = GetAppContext().mainWindow;
-        auto window = static_cast<GLFWwindow*>(w.handle);
-        auto state = glfwGetMouseButton(window, static_cast<int32_t>(button));
-        return state == GLFW_PRESS;
-    }
+    std::pair<float, float> Input::GetMousePosition() { return GetSnapshot()->GetMousePosition(); }
+
+    float Input::GetMouseX() { return GetSnapshot()->mouseX; }
+    float Input::GetMouseY() { return GetSnapshot()->mouseY; }
+
+    bool Input::IsGamepadButtonDown(JoystickCode id, GamepadCode code) { return GetSnapshot()->IsGamepadButtonDown(id, code); }
 
-    bool Input::IsMouseButtonUp(const MouseCode button)
+    bool Input::IsGamepadButtonUp(JoystickCode id, GamepadCode code) { return GetSnapshot()->IsGamepadButtonUp(id, code); }
+
+    bool Input::IsGamepadButtonPressed(JoystickCode id, GamepadCode code) { return GetSnapshot()->IsGamepadButtonPressed(id, code); }
+
+    bool Input::IsGamepadButtonReleased(JoystickCode id, GamepadCode code) { return GetSnapshot()->IsGamepadButtonReleased(id, code); }
+
+    std::pair<float, float> Input::GetGamepadLeftAxis(JoystickCode code) { return GetSnapshot()->GetGamepadLeftAxis(code); }
+
+    std::pair<float, float> Input::GetGamepadRightAxis(JoystickCode code) { return GetSnapshot()->GetGamepadRightAxis(code); }
+
+    void Input::SetDeadZoon(float value)
     {
         auto& w = GetAppContext().mainWindow;
-        auto window = static_cast<GLFWwindow*>(w.handle);
-        auto state = glfwGetMouseButton(window, static_cast<int32_t>(button));
-        return state == GLFW_RELEASE;
+        w.inputData.deadZoon = value;
     }
 
-    bool Input::IsMouseButtonPressed(const MouseCode key)
+    void Input::SetCursorMode(Cursor::Mode mode)
     {
         auto& w = GetAppContext().mainWindow;
         auto window = static_cast<GLFWwindow*>(w.handle);
-        auto currentState = glfwGetMouseButton(window, static_cast<int32_t>(key));
-
-        bool isKeyDown = (currentState == GLFW_PRESS) && !w.inputData.mouseButtonDownPrevFrame.test(key);
-        w.inputData.mouseButtonDownPrevFrame.set(key, currentState == GLFW_PRESS);
-
-        return isKeyDown;
+        glfwSetInputMode(window, GLFW_CURSOR, ToGLFWCursorMode(mode));
+        w.inputData.cursor.CursorMode = mode;
     }
 
-    bool Input::IsMouseButtonReleased(const MouseCode key)
+    Cursor::Mode Input::GetCursorMode()
     {
         auto& w = GetAppContext().mainWindow;
-        auto window = static_cast<GLFWwindow*>(w.handle);
-        auto currentState = glfwGetMouseButton(window, static_cast<int32_t>(key));
-
-        bool isKeyUp = (currentState == GLFW_RELEASE) && !w.inputData.mouseButtonUpPrevFrame.test(key);
-        w.inputData.mouseButtonUpPrevFrame.set(key, currentState == GLFW_RELEASE);
-
-        return isKeyUp;
+        return w.inputData.cursor.CursorMode;
     }
 
-    std::pair<float, float> Input::GetMousePosition()
+    static void EvaluateKeyBindings(ApplicationContext& c)
     {
-        auto& w = GetAppContext().mainWindow;
-        auto window = static_cast<GLFWwindow*>(w.handle);
-        double xpos, ypos;
-        glfwGetCursorPos(window, &xpos, &ypos);
+        HE_PROFILE_FUNCTION();
 
-        return std::make_pair(float(xpos), float(ypos));
-    }
+        InputSnapshotHandle handle = Input::GetSnapshot();
+        const InputSnapshot& snapshot = *handle;
 
-    float Input::GetMouseX() { return GetMousePosition().first; }
-    float Input::GetMouseY() { return GetMousePosition().second; }
+        c.triggeredActions.assign((c.keyBindings.size() + 63) / 64, 0);
 
-    bool Input::IsGamepadButtonDown(JoystickCode id, GamepadCode code)
-    {
-        if (glfwJoystickPresent(id))
+        for (uint32_t i = 0; i < c.keyBindings.size(); i++)
         {
-            GLFWgamepadstate state;
-            if (glfwGetGamepadState(id, &state))
-                return state.buttons[code] == GLFW_PRESS;
-        }
+            const auto& desc = c.keyBindings[i];
 
-        return false;
-    }
+            bool modifiersDown = true;
+            for (const auto& m : desc.modifiers)
+                if (m != 0 && (m >= Key::Count || !snapshot.keyDown.test(m)))
+                    modifiersDown = false;
 
-    bool Input::IsGamepadButtonUp(JoystickCode id, GamepadCode code)
-    {
-        if (glfwJoystickPresent(id))
-        {
-            GLFWgamepadstate state;
-            if (glfwGetGamepadState(id, &state))
-                return state.buttons[code] == GLFW_RELEASE;
-        }
+            if (!modifiersDown)
+                continue;
 
-        return false;
+            bool triggered = false;
+            switch (desc.eventType)
+            {
+            case EventType::KeyPressed:          triggered = desc.code < Key::Count && snapshot.keyPressed.test(desc.code); break;
+            case EventType::KeyReleased:         triggered = desc.code < Key::Count && snapshot.keyReleased.test(desc.code); break;
+            case EventType::MouseButtonPressed:  triggered = desc.code < MouseKey::Count && snapshot.mouseButtonPressed.test(desc.code); break;
+            case EventType::MouseButtonReleased: triggered = desc.code < MouseKey::Count && snapshot.mouseButtonReleased.test(desc.code); break;
+            default: break;
+            }
+
+            if (triggered)
+                c.triggeredActions[i / 64] |= 1ull << (i % 64);
+        }
     }
 
-    bool Input::IsGamepadButtonPressed(JoystickCode id, GamepadCode code)
+    bool Input::StartRecording(const std::filesystem::path& filePath)
     {
-        bool b = false;
+        auto& c = GetAppContext();
+        InputState& state = c.mainWindow.inputData;
 
-        if (glfwJoystickPresent(id))
-        {
-            GLFWgamepadstate state;
-            if (glfwGetGamepadState(id, &state))
-            {
-                auto& w = GetAppContext().mainWindow;
+        if (state.recording)
+            StopRecording();
 
-                bool isPressed = state.buttons[code] == GLFW_PRESS;
-                b = isPressed && !w.inputData.gamepadButtonDownPrevFrame[id].test(code);
-                w.inputData.gamepadButtonDownPrevFrame[id].set(code, isPressed);
-            }
+        std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            HE_CORE_ERROR("Input::StartRecording : Unable to open file for writing, {}", filePath.string());
+            return false;
         }
 
-        return b;
-    }
+        InputRecordFileHeader header;
+        file.write((const char*)&header, sizeof(header));
+        file.close();
 
-    bool Input::IsGamepadButtonReleased(JoystickCode id, GamepadCode code)
-    {
-        bool b = false;
+        state.recordFilePath = filePath;
+        state.recordStartFrame = c.frameIndex;
+        state.recording = true;
 
-        if (glfwJoystickPresent(id))
+        // seed the recording with the state that no event will report
+        const InputSnapshot& live = state.live;
+        for (JoystickCode jid = 0; jid < Joystick::Count; jid++)
         {
-            GLFWgamepadstate state;
-            if (glfwGetGamepadState(id, &state))
-            {
-                auto& w = GetAppContext().mainWindow;
-
-                bool isReleased = state.buttons[code] == GLFW_RELEASE;
-                b = isReleased && !w.inputData.gamepadButtonUpPrevFrame[id].test(code);
-                w.inputData.gamepadButtonUpPrevFrame[id].set(code, isReleased);
-            }
+            if (live.gamepadConnected.test(jid))
+                state.records.push_back({ .type = uint8_t(EventType::GamepadConnected), .flags = 1, .code = jid });
         }
+        state.records.push_back({ .type = uint8_t(EventType::MouseMoved), .x = live.mouseX, .y = live.mouseY });
 
-        return b;
+        HE_CORE_INFO("Input : Recording to {}", filePath.string());
+        return true;
     }
 
-    std::pair<float, float> Input::GetGamepadLeftAxis(JoystickCode code)
+    void Input::StopRecording()
     {
-        if (glfwJoystickPresent(code))
-        {
-            GLFWgamepadstate state;
-            if (glfwGetGamepadState(code, &state))
-            {
-                auto& w = GetAppContext().mainWindow;
-
-                Math::vec2 v(state.axes[GLFW_GAMEPAD_AXIS_LEFT_X], state.axes[GLFW_GAMEPAD_AXIS_LEFT_Y]);
-                v *= Math::max(Math::length(v) - w.inputData.deadZoon, 0.0f) / (1.f - w.inputData.deadZoon);
-                v = Math::clamp(v, Math::vec2(-1.0f), Math::vec2(1.0f));
-
-                return std::pair<float, float>(v.x, v.y);
-            }
-        }
+        InputState& state = GetAppContext().mainWindow.inputData;
+        if (!state.recording)
+            return;
 
-        return std::pair<float, float>(0.0f, 0.0f);
+        FlushInputRecords(state);
+        state.recording = false;
     }
 
-    std::pair<float, float> Input::GetGamepadRightAxis(JoystickCode code)
+    bool Input::IsRecording() { return GetAppContext().mainWindow.inputData.recording; }
+
+    bool Input::StartReplay(const std::filesystem::path& filePath)
     {
-        if (glfwJoystickPresent(code))
+        auto& c = GetAppContext();
+        InputState& state = c.mainWindow.inputData;
+
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
         {
-            GLFWgamepadstate state;
-            if (glfwGetGamepadState(code, &state))
-            {
-                auto& w = GetAppContext().mainWindow;
+            HE_CORE_ERROR("Input::StartReplay : Unable to open file for reading, {}", filePath.string());
+            return false;
+        }
 
-                Math::vec2 v(state.axes[GLFW_GAMEPAD_AXIS_RIGHT_X], state.axes[GLFW_GAMEPAD_AXIS_RIGHT_Y]);
-                v *= Math::max(Math::length(v) - w.inputData.deadZoon, 0.0f) / (1.f - w.inputData.deadZoon);
-                v = Math::clamp(v, Math::vec2(-1.0f), Math::vec2(1.0f));
+        size_t fileSize = file.tellg();
+        file.seekg(0);
 
-                return std::pair<float, float>(v.x, v.y);
-            }
+        InputRecordFileHeader expected, header;
+        file.read((char*)&header, sizeof(header));
+        if (!file || std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.version != expected.version || header.recordSize != expected.recordSize)
+        {
+            HE_CORE_ERROR("Input::StartReplay : {} is not a valid input record file", filePath.string());
+            return false;
         }
 
-        return std::pair<float, float>(0.0f, 0.0f);
-    }
+        state.replayRecords.resize((fileSize - sizeof(header)) / sizeof(InputRecord));
+        file.read((char*)state.replayRecords.data(), state.replayRecords.size() * sizeof(InputRecord));
 
-    void Input::SetDeadZoon(float value)
-    {
-        auto& w = GetAppContext().mainWindow;
-        w.inputData.deadZoon = value;
-    }
+        state.live = {};
+        state.replayCursor = 0;
+        state.replayStartFrame = c.frameIndex;
+        state.replaying = true;
 
-    void Input::SetCursorMode(Cursor::Mode mode)
-    {
-        auto& w = GetAppContext().mainWindow;
-        auto window = static_cast<GLFWwindow*>(w.handle);
-        glfwSetInputMode(window, GLFW_CURSOR, ToGLFWCursorMode(mode));
-        w.inputData.cursor.CursorMode = mode;
+        HE_CORE_INFO("Input : Replaying {} input records from {}", state.replayRecords.size(), filePath.string());
+        return true;
     }
 
-    Cursor::Mode Input::GetCursorMode()
+    void Input::StopReplay()
     {
-        auto& w = GetAppContext().mainWindow;
-        return w.inputData.cursor.CursorMode;
+        InputState& state = GetAppContext().mainWindow.inputData;
+        state.replaying = false;
+        state.replayRecords.clear();
     }
 
-    bool Input::Triggered(const std::string_view& name)
+    bool Input::IsReplaying() { return GetAppContext().mainWindow.inputData.replaying; }
+
+    bool Input::Triggered(ActionHandle action)
     {
         auto& c = GetAppContext();
 
-        auto hash = Hash(name);
-
-        if (c.blockingEventsUntilNextFrame || !c.keyBindings.contains(hash))
+        if (c.blockingEventsUntilNextFrame || !action || action.index >= c.keyBindings.size())
             return false;
 
-        const auto& keysData = c.keyBindings.at(hash);
-
-        for (const auto& m : keysData.modifiers)
-            if (m != 0 && !Input::IsKeyDown(m))
-                return false;
-
-        if (keysData.eventCategory == EventCategory::Keyboard)
-        {
-            if (keysData.eventType == EventType::KeyPressed && Input::IsKeyPressed(keysData.code))
-            {
-                BlockEventsUntilNextFrame();
-                return true;
-            }
-
-            if (keysData.eventType == EventType::KeyReleased && Input::IsKeyReleased(keysData.code))
-            {
-                BlockEventsUntilNextFrame();
-                return true;
-            }
-        }
-        else if(keysData.eventCategory == EventCategory::Mouse)
+        if (c.triggeredActions[action.index / 64] & (1ull << (action.index % 64)))
         {
-            if (keysData.eventType == EventType::MouseButtonPressed && Input::IsMouseButtonPressed(keysData.code))
-            {
-                BlockEventsUntilNextFrame();
-                return true;
-            }
-
-            if (keysData.eventType == EventType::MouseButtonReleased && Input::IsMouseButtonReleased(keysData.code))
-            {
-                BlockEventsUntilNextFrame();
-                return true;
-            }
+            BlockEventsUntilNextFrame();
+            return true;
         }
 
         return false;
     }
 
+    bool Input::Triggered(ActionName name)
+    {
+        return Triggered(GetActionHandle(name));
+    }
+
     void Input::BlockEventsUntilNextFrame()
     {
         GetAppContext().blockingEventsUntilNextFrame = true;
@@ -2182,34 +5856,46 @@ namespace HE {
         return GetAppContext().blockingEventsUntilNextFrame;
     }
 
-    bool Input::RegisterKeyBinding(const KeyBindingDesc& action)
+    ActionHandle Input::RegisterKeyBinding(const KeyBindingDesc& desc)
     {
         auto& c = GetAppContext();
 
-        auto hash = Hash(action.name);
+        auto hash = HashString(desc.name);
 
-        if (!c.keyBindings.contains(hash))
+        if (!c.keyBindingLookup.contains(hash))
         {
-            c.keyBindings[hash] = action;
-            return true;
+            ActionHandle handle = { uint32_t(c.keyBindings.size()) };
+            c.keyBindings.push_back(desc);
+            c.keyBindingLookup[hash] = handle;
+            c.triggeredActions.resize((c.keyBindings.size() + 63) / 64, 0);
+            return handle;
         }
 
-        HE_CORE_ERROR("Input::RegisterKeyBinding action with name '{}' already regestered", action.name);
-        return false;
+        HE_CORE_ERROR("Input::RegisterKeyBinding action with name '{}' already regestered", desc.name);
+        return {};
+    }
+
+    ActionHandle Input::GetActionHandle(ActionName name)
+    {
+        auto& keyBindingLookup = GetAppContext().keyBindingLookup;
+
+        auto it = keyBindingLookup.find(name.hash);
+        if (it != keyBindingLookup.end())
+            return it->second;
+
+        return {};
     }
 
-    std::map<uint64_t, KeyBindingDesc>& Input::GetKeyBindings()
+    std::vector<KeyBindingDesc>& Input::GetKeyBindings()
     {
         return GetAppContext().keyBindings;
     }
 
-    std::string_view Input::GetShortCut(std::string_view name)
+    std::string_view Input::GetShortCut(ActionName name)
     {
-        auto& keyBindings = GetAppContext().keyBindings;
-        auto hash = Hash(name);
-
-        if (keyBindings.contains(hash))
-            return keyBindings.at(hash).shortCut;
+        ActionHandle handle = GetActionHandle(name);
+        if (handle)
+            return GetAppContext().keyBindings[handle.index].shortCut;
 
         return "None";
     }
@@ -2222,6 +5908,11 @@ namespace HE {
     {
         bool isHDR = filename.extension() == ".hdr";
 
+        // decoded straight from the mapped pages, no stdio copy of the encoded file
+        FileSystem::MappedFile file = FileSystem::MapFile(filename, FileSystem::AccessPattern::Sequential);
+        if (!file.IsMapped())
+            return;
+
         stbi_set_flip_vertically_on_load(flipVertically);
 
         if (isHDR)
@@ -2232,11 +5923,11 @@ namespace HE {
                 return;
             }
 
-            data = (uint8_t*)stbi_loadf(filename.string().c_str(), &width, &height, &channels, 0);
+            data = (uint8_t*)stbi_loadf_from_memory(file.Data(), (int)file.Size(), &width, &height, &channels, 0);
         }
         else
         {
-            data = stbi_load(filename.string().c_str(), &width, &height, &channels, desiredChannels);
+            data = stbi_load_from_memory(file.Data(), (int)file.Size(), &width, &height, &channels, desiredChannels);
         }
 
         if (!data)
@@ -2341,6 +6032,96 @@ namespace HE {
     // Utils
     //////////////////////////////////////////////////////////////////////////
 
+    // Compile-time perfect hash over the names of a CodeStrPair table (hash and displace).
+    // Every name gets its own slot, so a lookup is two hashes and a single string compare.
+    template<size_t N>
+    struct PerfectHashMap
+    {
+        static constexpr size_t c_Size = std::bit_ceil(N + N / 4 + 1);
+
+        const CodeStrPair* pairs;
+        uint32_t seeds[c_Size] = {};
+        int16_t slots[c_Size] = {};
+
+        static constexpr uint64_t Hash(std::string_view str, uint64_t seed)
+        {
+            uint64_t hash = 0xcbf29ce484222325ull ^ (seed * 0x9e3779b97f4a7c15ull);
+            for (char c : str)
+            {
+                hash ^= uint8_t(c);
+                hash *= 0x100000001b3ull;
+            }
+            hash ^= hash >> 32;
+            return hash;
+        }
+
+        consteval PerfectHashMap(const CodeStrPair(&table)[N]) : pairs(table)
+        {
+            for (auto& slot : slots)
+                slot = -1;
+
+            size_t bucketOf[N] = {};
+            size_t bucketSize[c_Size] = {};
+            size_t maxBucketSize = 0;
+            for (size_t i = 0; i < N; i++)
+            {
+                bucketOf[i] = Hash(table[i].codeStr, 0) & (c_Size - 1);
+                maxBucketSize = std::max(maxBucketSize, ++bucketSize[bucketOf[i]]);
+            }
+
+            // largest buckets first, they are the hardest to place
+            for (size_t size = maxBucketSize; size > 0; size--)
+            {
+                for (size_t bucket = 0; bucket < c_Size; bucket++)
+                {
+                    if (bucketSize[bucket] != size)
+                        continue;
+
+                    for (uint32_t seed = 1;; seed++)
+                    {
+                        if (seed > 1'000'000)
+                            throw "PerfectHashMap : unable to place bucket, the table has duplicate names";
+
+                        size_t placed[N] = {};
+                        size_t placedCount = 0;
+                        bool fits = true;
+
+                        for (size_t i = 0; i < N && fits; i++)
+                        {
+                            if (bucketOf[i] != bucket)
+                                continue;
+
+                            size_t slot = Hash(table[i].codeStr, seed) & (c_Size - 1);
+                            fits = slots[slot] == -1;
+                            for (size_t j = 0; j < placedCount && fits; j++)
+                                fits = placed[j] != slot;
+
+                            placed[placedCount++] = slot;
+                        }
+
+                        if (!fits)
+                            continue;
+
+                        for (size_t i = 0, j = 0; i < N; i++)
+                            if (bucketOf[i] == bucket)
+                                slots[placed[j++]] = int16_t(i);
+
+                        seeds[bucket] = seed;
+                        break;
+                    }
+                }
+            }
+        }
+
+        // index into the table, -1 when the name is unknown
+        constexpr int Find(std::string_view str) const
+        {
+            size_t bucket = Hash(str, 0) & (c_Size - 1);
+            int index = slots[Hash(str, seeds[bucket]) & (c_Size - 1)];
+            return index >= 0 && pairs[index].codeStr == str ? index : -1;
+        }
+    };
+
     namespace MouseKey
     {
         constexpr CodeStrPair c_CodeToStringMap[] = {
@@ -2351,11 +6132,12 @@ namespace HE {
 
         constexpr std::string_view ToString(MouseCode code) { return c_CodeToStringMap[code].codeStr; }
 
+        constexpr PerfectHashMap c_StringToCode(c_CodeToStringMap);
+
         constexpr MouseCode FromString(std::string_view code)
         {
-            for (auto& pair : c_CodeToStringMap)
-                if (pair.codeStr == code)
-                    return pair.code;
+            if (int index = c_StringToCode.Find(code); index >= 0)
+                return c_CodeToStringMap[index].code;
 
             HE_CORE_VERIFY(false);
             return -1;
@@ -2380,11 +6162,12 @@ namespace HE {
 
         constexpr std::string_view ToString(JoystickCode code) { return c_CodeToStringMap[code].codeStr; }
 
+        constexpr PerfectHashMap c_StringToCode(c_CodeToStringMap);
+
         constexpr JoystickCode FromString(std::string_view codeStr)
         {
-            for (auto& pair : c_CodeToStringMap)
-                if (pair.codeStr == codeStr)
-                    return pair.code;
+            if (int index = c_StringToCode.Find(codeStr); index >= 0)
+                return c_CodeToStringMap[index].code;
 
             HE_CORE_VERIFY(false);
             return -1;
@@ -2407,11 +6190,12 @@ namespace HE {
 
         constexpr std::string_view ToString(GamepadCode code) { return c_CodeToStringMap[code].codeStr; }
 
+        constexpr PerfectHashMap c_StringToCode(c_CodeToStringMap);
+
         constexpr GamepadCode FromString(std::string_view codeStr)
         {
-            for (auto& pair : c_CodeToStringMap)
-                if (pair.codeStr == codeStr)
-                    return pair.code;
+            if (int index = c_StringToCode.Find(codeStr); index >= 0)
+                return c_CodeToStringMap[index].code;
 
             HE_CORE_VERIFY(false);
             return -1;
@@ -2431,11 +6215,12 @@ namespace HE {
 
         constexpr std::string_view ToString(GamepadAxisCode code) { return c_CodeToStringMap[code].codeStr; }
 
+        constexpr PerfectHashMap c_StringToCode(c_CodeToStringMap);
+
         constexpr GamepadAxisCode FromString(std::string_view codeStr)
         {
-            for (auto& pair : c_CodeToStringMap)
-                if (pair.codeStr == codeStr)
-                    return pair.code;
+            if (int index = c_StringToCode.Find(codeStr); index >= 0)
+                return c_CodeToStringMap[index].code;
 
             HE_CORE_VERIFY(false);
             return -1;
@@ -2574,11 +6359,12 @@ namespace HE {
 
         constexpr std::string_view ToString(KeyCode code) { return c_CodeToStringMap[code].codeStr; }
 
+        constexpr PerfectHashMap c_StringToCode(c_CodeToStringMap);
+
         constexpr KeyCode FromString(std::string_view code)
         {
-            for (auto& pair : c_CodeToStringMap)
-                if (pair.codeStr == code)
-                    return pair.code;
+            if (int index = c_StringToCode.Find(code); index >= 0)
+                return c_CodeToStringMap[index].code;
 
             HE_CORE_VERIFY(false);
             return -1;
@@ -2617,11 +6403,12 @@ namespace HE {
 
     constexpr std::string_view ToString(EventType code) { return c_EventTypeMap[int(code)].codeStr; }
 
+    constexpr PerfectHashMap c_StringToEventType(c_EventTypeMap);
+
     constexpr EventType FromStringToEventType(std::string_view code)
     {
-        for (auto& pair : c_EventTypeMap)
-            if (pair.codeStr == code)
-                return (EventType)pair.code;
+        if (int index = c_StringToEventType.Find(code); index >= 0)
+            return (EventType)c_EventTypeMap[index].code;
 
         HE_CORE_VERIFY(false);
         return EventType::None;
@@ -2641,16 +6428,28 @@ namespace HE {
 
     constexpr std::string_view ToString(EventCategory code) { return c_EventCategoryMap[int(code)].codeStr; }
 
+    constexpr PerfectHashMap c_StringToEventCategory(c_EventCategoryMap);
+
     constexpr EventCategory FromStringToEventCategory(std::string_view code)
     {
-        for (auto& pair : c_EventCategoryMap)
-            if (pair.codeStr == code)
-                return (EventCategory)pair.code;
+        if (int index = c_StringToEventCategory.Find(code); index >= 0)
+            return (EventCategory)c_EventCategoryMap[index].code;
 
         HE_CORE_VERIFY(false);
         return EventCategory::None;
     }
 
+    constexpr EventCategory c_EventTypeCategoryMap[] = {
+        EventCategory::Keyboard, EventCategory::Keyboard, EventCategory::Keyboard,
+        EventCategory::Mouse, EventCategory::Mouse, EventCategory::Mouse, EventCategory::Mouse, EventCategory::Mouse,
+        EventCategory::Gamepad, EventCategory::Gamepad, EventCategory::Gamepad, EventCategory::Gamepad,
+        EventCategory::Window, EventCategory::Window, EventCategory::Window, EventCategory::Window, EventCategory::Window, EventCategory::Window, EventCategory::Window, EventCategory::Window, EventCategory::Window,
+        EventCategory::None,
+    };
+    static_assert(std::size(c_EventTypeCategoryMap) == size_t(EventType::None) + 1);
+
+    constexpr EventCategory GetEventCategory(EventType type) { return c_EventTypeCategoryMap[int(type)]; }
+
     void Input::SerializeKeyBindings(const std::filesystem::path& filePath)
     {
         std::ofstream file(filePath);
@@ -2664,7 +6463,7 @@ namespace HE {
         os << "\t\"bindings\" : [\n";
 
 
-        for (int bindingIndex = 0; auto & [key, desc] : Input::GetKeyBindings())
+        for (int bindingIndex = 0; auto & desc : Input::GetKeyBindings())
         {
             if (bindingIndex != 0) os << ",\n"; bindingIndex++;
 
@@ -2755,6 +6554,387 @@ namespace HE {
 
     namespace FileSystem {
 
+        constexpr uint64_t c_CompressedEntry = ~0ull;
+
+        struct VirtualMount
+        {
+            struct File
+            {
+                uint64_t key;       // HashString of the virtual path
+                uint32_t fileIndex; // archive entries only
+                uint64_t size;
+                uint64_t dataOffset = c_CompressedEntry; // stored archive entries, where their bytes start in the mapping
+            };
+
+            std::string prefix;      // normalized, ends with '/'
+            std::filesystem::path source;
+            int priority = 0;
+            std::vector<File> files; // scanned once at mount time
+
+            bool archive = false;
+            MappedFile archiveFile;  // archives are read straight from their mapping
+            mz_zip_archive zip = {};
+            std::mutex zipMutex;     // miniz readers keep per archive state
+
+            ~VirtualMount()
+            {
+                if (archive)
+                    mz_zip_reader_end(&zip);
+            }
+        };
+
+        struct VirtualEntry
+        {
+            uint32_t mount;
+            uint32_t fileIndex;
+            uint64_t size;
+            uint64_t dataOffset;
+        };
+
+        struct VirtualFile
+        {
+            std::filesystem::path realPath;        // the path itself unless it names a file in a mounted directory
+            std::shared_ptr<VirtualMount> archive; // set for archive entries
+            uint32_t fileIndex = 0;
+            uint64_t size = 0;
+            uint64_t dataOffset = c_CompressedEntry;
+        };
+
+        static std::shared_mutex s_VFSMutex;
+        static std::vector<std::shared_ptr<VirtualMount>> s_Mounts;   // ascending priority, later mounts after earlier ones of equal priority
+        static std::unordered_map<uint64_t, VirtualEntry> s_VFSIndex; // HashString(virtual path) -> file of the highest priority mount
+        static std::atomic<uint32_t> s_MountCount = 0;                // keeps real paths off the lock while nothing is mounted
+
+        static std::string NormalizePrefix(std::string_view prefix)
+        {
+            std::string normalized = std::filesystem::path(prefix).lexically_normal().generic_string();
+            if (normalized.empty() || normalized.back() != '/')
+                normalized += '/';
+
+            return normalized;
+        }
+
+        static void RebuildVirtualIndex()
+        {
+            s_VFSIndex.clear();
+
+            for (uint32_t m = 0; m < (uint32_t)s_Mounts.size(); m++)
+            {
+                for (const auto& file : s_Mounts[m]->files)
+                    s_VFSIndex.insert_or_assign(file.key, VirtualEntry{ m, file.fileIndex, file.size, file.dataOffset });
+            }
+
+            s_MountCount.store((uint32_t)s_Mounts.size(), std::memory_order_relaxed);
+        }
+
+        // true when the path names a mounted file, file.realPath stays the path itself otherwise
+        static bool Locate(const std::filesystem::path& path, VirtualFile& file)
+        {
+            file.realPath = path;
+
+            if (s_MountCount.load(std::memory_order_relaxed) == 0)
+                return false;
+
+            std::string key = path.lexically_normal().generic_string();
+
+            std::shared_lock lock(s_VFSMutex);
+
+            auto it = s_VFSIndex.find(HashString(key));
+            if (it != s_VFSIndex.end())
+            {
+                const auto& mount = s_Mounts[it->second.mount];
+                file.size = it->second.size;
+
+                if (mount->archive)
+                {
+                    file.archive = mount;
+                    file.fileIndex = it->second.fileIndex;
+                    file.dataOffset = it->second.dataOffset;
+                }
+                else
+                {
+                    file.realPath = mount->source / key.substr(mount->prefix.size());
+                }
+
+                return true;
+            }
+
+            // files created after their directory was mounted are not indexed
+            for (auto m = s_Mounts.rbegin(); m != s_Mounts.rend(); m++)
+            {
+                const VirtualMount& mount = **m;
+                if (mount.archive || !key.starts_with(mount.prefix))
+                    continue;
+
+                std::filesystem::path realPath = mount.source / key.substr(mount.prefix.size());
+
+                std::error_code ec;
+                if (std::filesystem::is_regular_file(realPath, ec))
+                {
+                    file.realPath = realPath;
+                    file.size = std::filesystem::file_size(realPath, ec);
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        // where a stored, unencrypted entry's bytes start in the archive, c_CompressedEntry for anything miniz has to decode
+        static uint64_t GetStoredDataOffset(const MappedFile& archive, const mz_zip_archive_file_stat& stat)
+        {
+            if (stat.m_method != 0 || stat.m_is_encrypted || stat.m_comp_size != stat.m_uncomp_size)
+                return c_CompressedEntry;
+
+            if (stat.m_local_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE > archive.Size())
+                return c_CompressedEntry;
+
+            // the local header repeats the name and carries its own extra field, its lengths decide where the data starts
+            const uint8_t* header = archive.Data() + stat.m_local_header_ofs;
+            if (MZ_READ_LE32(header) != MZ_ZIP_LOCAL_DIR_HEADER_SIG)
+                return c_CompressedEntry;
+
+            uint64_t dataOffset = stat.m_local_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + MZ_READ_LE16(header + MZ_ZIP_LDH_FILENAME_LEN_OFS) + MZ_READ_LE16(header + MZ_ZIP_LDH_EXTRA_LEN_OFS);
+            if (dataOffset + stat.m_uncomp_size > archive.Size())
+                return c_CompressedEntry;
+
+            return dataOffset;
+        }
+
+        static bool ReadArchiveFile(const VirtualFile& file, uint64_t offset, void* data, uint64_t size)
+        {
+            HE_PROFILE_FUNCTION();
+
+            if (offset + size > file.size)
+                return false;
+
+            VirtualMount& mount = *file.archive;
+
+            // stored entries are plain bytes in the mapping, no lock and no copy beyond this one
+            if (file.dataOffset != c_CompressedEntry)
+            {
+                std::memcpy(data, mount.archiveFile.Data() + file.dataOffset + offset, size);
+                return true;
+            }
+
+            if (offset == 0 && size == file.size)
+            {
+                std::scoped_lock lock(mount.zipMutex);
+                return mz_zip_reader_extract_to_mem(&mount.zip, file.fileIndex, data, size, 0);
+            }
+
+            // a deflate stream cannot be entered midway, ranges inflate up to the offset through a fixed size window and discard it.
+            // The lock covers creating and freeing the iterator, reads only touch the iterator and the read-only mapping
+            mz_zip_reader_extract_iter_state* iter;
+            {
+                std::scoped_lock lock(mount.zipMutex);
+                iter = mz_zip_reader_extract_iter_new(&mount.zip, file.fileIndex, 0);
+            }
+            if (!iter)
+                return false;
+
+            uint8_t discard[16 * 1024];
+            uint64_t skipped = 0;
+            while (skipped < offset)
+            {
+                size_t read = mz_zip_reader_extract_iter_read(iter, discard, size_t(std::min<uint64_t>(offset - skipped, sizeof(discard))));
+                if (read == 0)
+                    break;
+                skipped += read;
+            }
+
+            bool success = skipped == offset && mz_zip_reader_extract_iter_read(iter, data, size_t(size)) == size;
+
+            std::scoped_lock lock(mount.zipMutex);
+            mz_zip_reader_extract_iter_free(iter); // its CRC check only covers entries read to the end
+            return success;
+        }
+
+        static bool LocateArchiveFile(const std::filesystem::path& filePath, uint64_t& size)
+        {
+            VirtualFile file;
+            if (!Locate(filePath, file) || !file.archive)
+                return false;
+
+            size = file.size;
+            return true;
+        }
+
+        static bool ReadArchiveFile(const std::filesystem::path& filePath, uint64_t offset, void* data, uint64_t size)
+        {
+            VirtualFile file;
+            return Locate(filePath, file) && file.archive && ReadArchiveFile(file, offset, data, size);
+        }
+
+        bool Mount(std::string_view prefix, const std::filesystem::path& source, int priority)
+        {
+            HE_PROFILE_FUNCTION();
+
+            auto mount = std::make_shared<VirtualMount>();
+            mount->prefix = NormalizePrefix(prefix);
+            mount->source = source;
+            mount->priority = priority;
+
+            std::error_code ec;
+            if (std::filesystem::is_directory(source, ec))
+            {
+                try
+                {
+                    for (const auto& entry : std::filesystem::recursive_directory_iterator(source))
+                    {
+                        if (!entry.is_regular_file())
+                            continue;
+
+                        std::string key = mount->prefix + entry.path().lexically_relative(source).generic_string();
+                        mount->files.push_back({ HashString(key), 0, entry.file_size() });
+                    }
+                }
+                catch (const std::exception& e)
+                {
+                    HE_CORE_ERROR("Mount : Unable to scan {} : {}", source.string(), e.what());
+                    return false;
+                }
+            }
+            else if (std::filesystem::is_regular_file(source, ec) && mount->archiveFile.Map(source, AccessPattern::Random))
+            {
+                if (!mz_zip_reader_init_mem(&mount->zip, mount->archiveFile.Data(), mount->archiveFile.Size(), 0))
+                {
+                    HE_CORE_ERROR("Mount : {} is not a zip archive", source.string());
+                    return false;
+                }
+
+                mount->archive = true;
+
+                uint32_t fileCount = mz_zip_reader_get_num_files(&mount->zip);
+                mount->files.reserve(fileCount);
+
+                for (uint32_t i = 0; i < fileCount; i++)
+                {
+                    mz_zip_archive_file_stat stat;
+                    if (!mz_zip_reader_file_stat(&mount->zip, i, &stat) || stat.m_is_directory)
+                        continue;
+
+                    std::string key = mount->prefix + std::filesystem::path(stat.m_filename).lexically_normal().generic_string();
+                    mount->files.push_back({ HashString(key), i, stat.m_uncomp_size, GetStoredDataOffset(mount->archiveFile, stat) });
+                }
+            }
+            else
+            {
+                HE_CORE_ERROR("Mount : {} is neither a directory nor an archive", source.string());
+                return false;
+            }
+
+            std::unique_lock lock(s_VFSMutex);
+
+            auto it = std::upper_bound(s_Mounts.begin(), s_Mounts.end(), priority, [](int p, const auto& m) { return p < m->priority; });
+            s_Mounts.insert(it, std::move(mount));
+            RebuildVirtualIndex();
+
+            return true;
+        }
+
+        bool Unmount(std::string_view prefix, const std::filesystem::path& source)
+        {
+            HE_PROFILE_FUNCTION();
+
+            std::string normalized = NormalizePrefix(prefix);
+
+            std::unique_lock lock(s_VFSMutex);
+
+            // readers holding an archive keep it alive through their VirtualFile
+            size_t erased = std::erase_if(s_Mounts, [&](const auto& m) { return m->prefix == normalized && m->source == source; });
+            if (erased == 0)
+                return false;
+
+            RebuildVirtualIndex();
+            return true;
+        }
+
+        bool IsVirtualPath(const std::filesystem::path& path)
+        {
+            if (s_MountCount.load(std::memory_order_relaxed) == 0)
+                return false;
+
+            std::string key = path.generic_string();
+
+            std::shared_lock lock(s_VFSMutex);
+            return std::any_of(s_Mounts.begin(), s_Mounts.end(), [&](const auto& m) { return key.starts_with(m->prefix); });
+        }
+
+        bool Exists(const std::filesystem::path& path)
+        {
+            VirtualFile file;
+            if (Locate(path, file))
+                return true;
+
+            std::error_code ec;
+            return !IsVirtualPath(path) && std::filesystem::exists(path, ec);
+        }
+
+        std::filesystem::path ResolvePath(const std::filesystem::path& path)
+        {
+            VirtualFile file;
+            if (Locate(path, file))
+                return file.archive ? std::filesystem::path() : file.realPath;
+
+            if (!IsVirtualPath(path))
+                return path;
+
+            std::string key = path.lexically_normal().generic_string();
+
+            std::shared_lock lock(s_VFSMutex);
+            for (auto m = s_Mounts.rbegin(); m != s_Mounts.rend(); m++)
+            {
+                if (!(*m)->archive && key.starts_with((*m)->prefix))
+                    return (*m)->source / key.substr((*m)->prefix.size());
+            }
+
+            return {};
+        }
+
+        // archive entries are inflated into memory, padded with zeros past the end like the last page of a real mapping
+        static constexpr uint64_t c_InflatedPadding = 64;
+
+        bool MappedFile::Map(const std::filesystem::path& filePath, AccessPattern pattern)
+        {
+            Unmap();
+
+            VirtualFile file;
+            if (!Locate(filePath, file) || !file.archive)
+                return MapNative(file.realPath, pattern);
+
+            uint8_t* memory = (uint8_t*)calloc(1, file.size + c_InflatedPadding);
+            if (!ReadArchiveFile(file, 0, memory, file.size))
+            {
+                HE_CORE_ERROR("MapFile : Unable to inflate {}", filePath.string());
+                free(memory);
+                return false;
+            }
+
+            data = memory;
+            size = file.size;
+            readableSize = file.size + c_InflatedPadding;
+            mapped = true;
+            owned = true;
+            return true;
+        }
+
+        void MappedFile::Unmap()
+        {
+            if (!owned)
+            {
+                UnmapNative();
+                return;
+            }
+
+            free((void*)data);
+            data = nullptr;
+            size = 0;
+            readableSize = 0;
+            mapped = false;
+            owned = false;
+        }
+
         bool Delete(const std::filesystem::path& path)
         {
             namespace fs = std::filesystem;
@@ -2827,7 +7007,20 @@ namespace HE {
 
         std::vector<uint8_t> ReadBinaryFile(const std::filesystem::path& filePath)
         {
-            std::ifstream inputFile(filePath, std::ios::binary | std::ios::ate);
+            VirtualFile file;
+            if (Locate(filePath, file) && file.archive)
+            {
+                std::vector<uint8_t> buffer(file.size);
+                if (!ReadArchiveFile(file, 0, buffer.data(), buffer.size()))
+                {
+                    HE_CORE_ERROR("Unable to inflate {}", filePath.string());
+                    return {};
+                }
+
+                return buffer;
+            }
+
+            std::ifstream inputFile(file.realPath, std::ios::binary | std::ios::ate);
 
             if (!inputFile)
             {
@@ -2847,7 +7040,25 @@ namespace HE {
 
         bool ReadBinaryFile(const std::filesystem::path& filePath, Buffer buffer)
         {
-            std::ifstream inputFile(filePath, std::ios::binary | std::ios::ate);
+            VirtualFile file;
+            if (Locate(filePath, file) && file.archive)
+            {
+                if (buffer.size < file.size)
+                {
+                    HE_CORE_ERROR("Provided buffer is too small. Required size: {}", file.size);
+                    return false;
+                }
+
+                if (!ReadArchiveFile(file, 0, buffer.data, file.size))
+                {
+                    HE_CORE_ERROR("Unable to inflate {}", filePath.string());
+                    return false;
+                }
+
+                return true;
+            }
+
+            std::ifstream inputFile(file.realPath, std::ios::binary | std::ios::ate);
             if (!inputFile)
             {
                 HE_CORE_ERROR("Unable to open input file {}", filePath.string());
@@ -2870,7 +7081,20 @@ namespace HE {
 
         std::string FileSystem::ReadTextFile(const std::filesystem::path& filePath)
         {
-            std::ifstream infile(filePath, std::ios::in | std::ios::ate);
+            VirtualFile file;
+            if (Locate(filePath, file) && file.archive)
+            {
+                std::string content(file.size, '\0');
+                if (!ReadArchiveFile(file, 0, content.data(), content.size()))
+                {
+                    HE_CORE_ERROR("Unable to inflate {}", filePath.string());
+                    return {};
+                }
+
+                return content;
+            }
+
+            std::ifstream infile(file.realPath, std::ios::in | std::ios::ate);
             if (!infile)
             {
                 HE_CORE_ERROR("Could not open input file: {}", filePath.string());
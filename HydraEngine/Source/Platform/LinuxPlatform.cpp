@@ -3,6 +3,19 @@ module;
 #include <sys/wait.h>
 #include <unistd.h>
 #include <dlfcn.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include <linux/input.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <cstring>
+#include <cerrno>
 
 module HE;
 
@@ -15,11 +28,11 @@ module HE;
 using NativeHandleType = void*;
 using NativeSymbolType = void*;
 
-void* HE::Modules::SharedLib::Open(const char* path) noexcept
+void* HE::Modules::SharedLib::Open(const char* path, bool lazyBinding) noexcept
 {
     HE_PROFILE_FUNCTION();
 
-    return dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    return dlopen(path, (lazyBinding ? RTLD_LAZY : RTLD_NOW) | RTLD_LOCAL);
 }
 
 void* HE::Modules::SharedLib::GetSymbolAddress(void* handle, const char* name) noexcept
@@ -31,7 +44,7 @@ void HE::Modules::SharedLib::Close(void* handle) noexcept
 {
     HE_PROFILE_FUNCTION();
 
-    dlclose((NativeHandleType)lib);
+    dlclose((NativeHandleType)handle);
 }
 
 std::string HE::Modules::SharedLib::GetError() noexcept
@@ -71,6 +84,62 @@ std::filesystem::path HE::FileSystem::GetAppDataPath(const std::string& appName,
     return {};
 }
 
+bool HE::FileSystem::MappedFile::MapNative(const std::filesystem::path& filePath, AccessPattern pattern)
+{
+    HE_PROFILE_FUNCTION();
+
+    int fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        HE_CORE_ERROR("MapFile : Unable to open file {}", filePath.string());
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode))
+    {
+        HE_CORE_ERROR("MapFile : {} is not a regular file", filePath.string());
+        close(fd);
+        return false;
+    }
+
+    uint64_t fileSize = uint64_t(st.st_size);
+    if (fileSize > 0)
+    {
+        void* view = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED)
+        {
+            HE_CORE_ERROR("MapFile : Unable to map file {} : {}", filePath.string(), strerror(errno));
+            close(fd);
+            return false;
+        }
+
+        int advice = pattern == AccessPattern::Sequential ? MADV_SEQUENTIAL : pattern == AccessPattern::Random ? MADV_RANDOM : MADV_NORMAL;
+        madvise(view, fileSize, advice);
+
+        data = (const uint8_t*)view;
+    }
+
+    // the mapping keeps the file alive
+    close(fd);
+
+    size = fileSize;
+    readableSize = AlignUp(fileSize, uint64_t(sysconf(_SC_PAGESIZE)));
+    mapped = true;
+    return true;
+}
+
+void HE::FileSystem::MappedFile::UnmapNative()
+{
+    if (data)
+        munmap((void*)data, size);
+
+    data = nullptr;
+    size = 0;
+    readableSize = 0;
+    mapped = false;
+}
+
 void HE::OS::SetEnvVar(const char* var, const char* value)
 {
     NOT_YET_IMPLEMENTED();
@@ -81,4 +150,650 @@ void HE::OS::RemoveEnvVar(const char* var)
     NOT_YET_IMPLEMENTED();
 }
 
+intptr_t HE::OS::CreateLocalSocket(const std::filesystem::path& path)
+{
+    HE_PROFILE_FUNCTION();
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+
+    std::string str = path.string();
+    if (str.size() >= sizeof(addr.sun_path))
+        return -1;
+
+    std::memcpy(addr.sun_path, str.c_str(), str.size() + 1);
+
+    // a socket left behind by a previous run would make bind fail, anything else is not ours to remove
+    struct stat st;
+    if (stat(str.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+        unlink(str.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 8) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+intptr_t HE::OS::AcceptLocalSocket(intptr_t socket, uint32_t timeoutMs)
+{
+    pollfd pfd{ int(socket), POLLIN, 0 };
+    if (poll(&pfd, 1, int(timeoutMs)) <= 0)
+        return -1;
+
+    int fd = accept4(int(socket), nullptr, nullptr, SOCK_CLOEXEC);
+    return fd < 0 ? -1 : fd;
+}
+
+int HE::OS::ReadLocalSocket(intptr_t socket, void* data, size_t size, uint32_t timeoutMs)
+{
+    pollfd pfd{ int(socket), POLLIN, 0 };
+    if (poll(&pfd, 1, int(timeoutMs)) <= 0)
+        return 0;
+
+    ssize_t n = recv(int(socket), data, size, 0);
+    return n < 0 ? -1 : int(n);
+}
+
+bool HE::OS::WriteLocalSocket(intptr_t socket, const void* data, size_t size)
+{
+    const char* p = (const char*)data;
+    while (size > 0)
+    {
+        ssize_t n = send(int(socket), p, size, MSG_NOSIGNAL);
+        if (n <= 0)
+            return false;
+
+        p += n;
+        size -= size_t(n);
+    }
+
+    return true;
+}
+
+void HE::OS::CloseLocalSocket(intptr_t socket)
+{
+    close(int(socket));
+}
+
+struct FileWatcher
+{
+    int fd = -1;
+    std::mutex mutex;
+    std::unordered_map<int, std::filesystem::path> directories; // watch descriptor -> directory
+};
+
+intptr_t HE::OS::CreateFileWatcher()
+{
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+        return -1;
+
+    FileWatcher* watcher = new FileWatcher();
+    watcher->fd = fd;
+    return intptr_t(watcher);
+}
+
+bool HE::OS::AddFileWatch(intptr_t watcher, const std::filesystem::path& directory)
+{
+    FileWatcher* w = (FileWatcher*)watcher;
+
+    // close-write catches in place rebuilds, moved-to catches linkers that write aside and rename
+    int wd = inotify_add_watch(w->fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd < 0)
+        return false;
+
+    std::scoped_lock lock(w->mutex);
+    w->directories[wd] = directory;
+    return true;
+}
+
+bool HE::OS::ReadFileWatcher(intptr_t watcher, std::vector<std::filesystem::path>& changedFiles, uint32_t timeoutMs)
+{
+    FileWatcher* w = (FileWatcher*)watcher;
+
+    pollfd pfd{ w->fd, POLLIN, 0 };
+    int ready = poll(&pfd, 1, int(timeoutMs));
+    if (ready < 0)
+        return errno == EINTR;
+
+    if (ready == 0)
+        return true;
+
+    alignas(inotify_event) char buffer[4096];
+    while (true)
+    {
+        ssize_t size = read(w->fd, buffer, sizeof(buffer));
+        if (size <= 0)
+            return size == 0 || errno == EAGAIN || errno == EINTR;
+
+        std::scoped_lock lock(w->mutex);
+        for (char* p = buffer; p < buffer + size;)
+        {
+            auto* event = (inotify_event*)p;
+            p += sizeof(inotify_event) + event->len;
+
+            auto it = w->directories.find(event->wd);
+            if (event->len > 0 && it != w->directories.end())
+                changedFiles.push_back(it->second / event->name);
+        }
+    }
+}
+
+void HE::OS::CloseFileWatcher(intptr_t watcher)
+{
+    FileWatcher* w = (FileWatcher*)watcher;
+    close(w->fd);
+    delete w;
+}
+
+// evdev gamepads following the kernel gamepad layout (Documentation/input/gamepad.rst). X and Y use the
+// BTN_X/BTN_Y codes xpad and most Xbox style pads report, devices are rescanned once a second for hotplug.
+struct GamepadDevice
+{
+    int fd = -1;
+    uint32_t node = 0;      // N in /dev/input/eventN
+    input_absinfo abs[4];   // ABS_X, ABS_Y, ABS_RX, ABS_RY
+    HE::OS::GamepadState state;
+};
+
+struct Gamepads
+{
+    std::vector<GamepadDevice> devices; // by slot
+    uint64_t nextScan = 0;
+};
+
+static constexpr int c_StickCodes[4] = { ABS_X, ABS_Y, ABS_RX, ABS_RY };
+
+static int GamepadButtonBit(int code)
+{
+    switch (code)
+    {
+    case BTN_SOUTH:      return HE::GamepadButton::A;
+    case BTN_EAST:       return HE::GamepadButton::B;
+    case BTN_X:          return HE::GamepadButton::X;
+    case BTN_Y:          return HE::GamepadButton::Y;
+    case BTN_TL:         return HE::GamepadButton::LeftBumper;
+    case BTN_TR:         return HE::GamepadButton::RightBumper;
+    case BTN_SELECT:     return HE::GamepadButton::Back;
+    case BTN_START:      return HE::GamepadButton::Start;
+    case BTN_MODE:       return HE::GamepadButton::Guide;
+    case BTN_THUMBL:     return HE::GamepadButton::LeftThumb;
+    case BTN_THUMBR:     return HE::GamepadButton::RightThumb;
+    case BTN_DPAD_UP:    return HE::GamepadButton::Up;
+    case BTN_DPAD_RIGHT: return HE::GamepadButton::Right;
+    case BTN_DPAD_DOWN:  return HE::GamepadButton::Down;
+    case BTN_DPAD_LEFT:  return HE::GamepadButton::Left;
+    default:             return -1;
+    }
+}
+
+static bool TestBit(const unsigned long* bits, int bit)
+{
+    constexpr int c_Bits = sizeof(unsigned long) * 8;
+    return (bits[bit / c_Bits] >> (bit % c_Bits)) & 1;
+}
+
+static float NormalizeAxis(const input_absinfo& info, int value)
+{
+    if (info.maximum <= info.minimum)
+        return 0.0f;
+
+    return std::clamp(2.0f * float(value - info.minimum) / float(info.maximum - info.minimum) - 1.0f, -1.0f, 1.0f);
+}
+
+static void SetGamepadButton(HE::OS::GamepadState& state, int bit, bool down)
+{
+    if (down)
+        state.buttons |= 1u << bit;
+    else
+        state.buttons &= ~(1u << bit);
+}
+
+static void ApplyGamepadEvent(GamepadDevice& device, const input_event& e)
+{
+    if (e.type == EV_KEY)
+    {
+        int bit = GamepadButtonBit(e.code);
+        if (bit >= 0)
+            SetGamepadButton(device.state, bit, e.value != 0);
+    }
+    else if (e.type == EV_ABS)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            if (e.code == c_StickCodes[i])
+                device.state.axes[i] = NormalizeAxis(device.abs[i], e.value);
+        }
+
+        // pads without BTN_DPAD_* report the d-pad as a hat
+        if (e.code == ABS_HAT0X)
+        {
+            SetGamepadButton(device.state, HE::GamepadButton::Left, e.value < 0);
+            SetGamepadButton(device.state, HE::GamepadButton::Right, e.value > 0);
+        }
+        else if (e.code == ABS_HAT0Y)
+        {
+            SetGamepadButton(device.state, HE::GamepadButton::Up, e.value < 0);
+            SetGamepadButton(device.state, HE::GamepadButton::Down, e.value > 0);
+        }
+    }
+}
+
+static void CloseGamepadDevice(GamepadDevice& device)
+{
+    if (device.fd >= 0)
+        close(device.fd);
+
+    device = {};
+}
+
+static bool OpenGamepadDevice(GamepadDevice& device, uint32_t node)
+{
+    std::string path = "/dev/input/event" + std::to_string(node);
+    int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    constexpr int c_Bits = sizeof(unsigned long) * 8;
+    unsigned long keyBits[KEY_CNT / c_Bits + 1] = {};
+    unsigned long absBits[ABS_CNT / c_Bits + 1] = {};
+    unsigned long keyState[KEY_CNT / c_Bits + 1] = {};
+
+    if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits) < 0 || ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(absBits)), absBits) < 0 ||
+        !TestBit(keyBits, BTN_GAMEPAD) || !TestBit(absBits, ABS_X))
+    {
+        close(fd);
+        return false;
+    }
+
+    device.fd = fd;
+    device.node = node;
+    device.state = {};
+    device.state.connected = true;
+
+    for (int i = 0; i < 4; i++)
+    {
+        device.abs[i] = {};
+        if (TestBit(absBits, c_StickCodes[i]) && ioctl(fd, EVIOCGABS(c_StickCodes[i]), &device.abs[i]) == 0)
+            device.state.axes[i] = NormalizeAxis(device.abs[i], device.abs[i].value);
+    }
+
+    // buttons already held when the pad is opened
+    if (ioctl(fd, EVIOCGKEY(sizeof(keyState)), keyState) >= 0)
+    {
+        for (int code = BTN_MISC; code < KEY_CNT; code++)
+        {
+            int bit = GamepadButtonBit(code);
+            if (bit >= 0 && TestBit(keyState, code))
+                SetGamepadButton(device.state, bit, true);
+        }
+    }
+
+    return true;
+}
+
+static void ScanGamepads(Gamepads& gamepads)
+{
+    std::vector<uint32_t> nodes;
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/dev/input", ec))
+    {
+        std::string name = entry.path().filename().string();
+        if (name.starts_with("event"))
+            nodes.push_back((uint32_t)std::strtoul(name.c_str() + 5, nullptr, 10));
+    }
+
+    std::sort(nodes.begin(), nodes.end());
+
+    for (uint32_t node : nodes)
+    {
+        bool open = std::any_of(gamepads.devices.begin(), gamepads.devices.end(), [node](const GamepadDevice& d) { return d.fd >= 0 && d.node == node; });
+        if (open)
+            continue;
+
+        auto slot = std::find_if(gamepads.devices.begin(), gamepads.devices.end(), [](const GamepadDevice& d) { return d.fd < 0; });
+        if (slot == gamepads.devices.end())
+            break;
+
+        OpenGamepadDevice(*slot, node);
+    }
+}
+
+intptr_t HE::OS::OpenGamepads()
+{
+    return (intptr_t)new Gamepads();
+}
+
+void HE::OS::ReadGamepads(intptr_t handle, std::span<GamepadState> states)
+{
+    Gamepads& gamepads = *(Gamepads*)handle;
+
+    if (gamepads.devices.size() != states.size())
+        gamepads.devices.resize(states.size());
+
+    uint64_t now = HE::Application::GetTimestamp();
+    if (now >= gamepads.nextScan)
+    {
+        ScanGamepads(gamepads);
+        gamepads.nextScan = now + 1'000'000'000ull;
+    }
+
+    for (size_t slot = 0; slot < states.size(); slot++)
+    {
+        GamepadDevice& device = gamepads.devices[slot];
+
+        input_event events[64];
+        while (device.fd >= 0)
+        {
+            ssize_t bytes = read(device.fd, events, sizeof(events));
+            if (bytes <= 0)
+            {
+                // ENODEV once the pad is unplugged
+                if (bytes < 0 && errno != EAGAIN && errno != EINTR)
+                    CloseGamepadDevice(device);
+                break;
+            }
+
+            for (size_t i = 0; i < size_t(bytes) / sizeof(input_event); i++)
+                ApplyGamepadEvent(device, events[i]);
+        }
+
+        states[slot] = device.state;
+    }
+}
+
+void HE::OS::CloseGamepads(intptr_t handle)
+{
+    Gamepads* gamepads = (Gamepads*)handle;
+
+    for (GamepadDevice& device : gamepads->devices)
+        CloseGamepadDevice(device);
+
+    delete gamepads;
+}
+
+// raw io_uring, one thread submits and one reaps, the reaper resubmits the rest of short transfers
+struct IORing
+{
+    struct Slot
+    {
+        int file = -1;
+        int32_t error = 0; // open failure, reported through a NOP
+        uint8_t* data = nullptr;
+        uint64_t size = 0;
+        uint64_t offset = 0;
+        uint64_t done = 0; // bytes transferred so far
+        bool write = false;
+    };
+
+    int fd = -1;
+
+    void* sqRing = MAP_FAILED;
+    void* cqRing = MAP_FAILED;
+    size_t sqRingSize = 0;
+    size_t cqRingSize = 0;
+    io_uring_sqe* sqes = (io_uring_sqe*)MAP_FAILED;
+    size_t sqesSize = 0;
+
+    uint32_t* sqHead = nullptr;
+    uint32_t* sqTail = nullptr;
+    uint32_t* sqMask = nullptr;
+    uint32_t* sqArray = nullptr;
+    uint32_t* cqHead = nullptr;
+    uint32_t* cqTail = nullptr;
+    uint32_t* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    std::mutex mutex;              // the submission queue and the slots, both threads queue transfers
+    std::vector<Slot> slots;
+    std::vector<uint32_t> requeued; // reaper scratch, slots resubmitted in one wait
+};
+
+static void DestroyIORing(IORing* ring)
+{
+    if (ring->sqes != MAP_FAILED)
+        munmap(ring->sqes, ring->sqesSize);
+    if (ring->cqRing != MAP_FAILED && ring->cqRing != ring->sqRing)
+        munmap(ring->cqRing, ring->cqRingSize);
+    if (ring->sqRing != MAP_FAILED)
+        munmap(ring->sqRing, ring->sqRingSize);
+    if (ring->fd >= 0)
+        close(ring->fd);
+
+    for (const IORing::Slot& slot : ring->slots)
+    {
+        if (slot.file >= 0)
+            close(slot.file);
+    }
+
+    delete ring;
+}
+
+// queues what is left of a slot, the kernel caps a single transfer just below 2 GiB
+static void QueueTransfer(IORing* ring, uint32_t slot, uint32_t& tail)
+{
+    const IORing::Slot& transfer = ring->slots[slot];
+
+    uint32_t index = tail & *ring->sqMask;
+    io_uring_sqe& sqe = ring->sqes[index];
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.user_data = slot;
+
+    if (transfer.file < 0)
+    {
+        sqe.opcode = IORING_OP_NOP;
+    }
+    else
+    {
+        sqe.opcode = transfer.write ? IORING_OP_WRITE : IORING_OP_READ;
+        sqe.fd = transfer.file;
+        sqe.addr = (uint64_t)(transfer.data + transfer.done);
+        sqe.len = (uint32_t)std::min<uint64_t>(transfer.size - transfer.done, 0x7ffff000);
+        sqe.off = transfer.offset + transfer.done;
+    }
+
+    ring->sqArray[index] = index;
+    tail++;
+}
+
+// hands the queued entries to the kernel, on a hard failure the ones it did not take are dropped from the queue
+static uint32_t EnterQueued(IORing* ring, uint32_t tail, uint32_t count)
+{
+    __atomic_store_n(ring->sqTail, tail, __ATOMIC_RELEASE);
+
+    uint32_t submitted = 0;
+    while (submitted < count)
+    {
+        int result = (int)syscall(__NR_io_uring_enter, ring->fd, count - submitted, 0, 0, nullptr, 0);
+        if (result < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY))
+            continue;
+
+        if (result <= 0)
+        {
+            HE_CORE_ERROR("IORing : io_uring_enter failed : {}", strerror(result < 0 ? errno : EIO));
+
+            // entries past the kernel's head were never read, without SQPOLL the tail can be moved back over them
+            __atomic_store_n(ring->sqTail, __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+            break;
+        }
+
+        submitted += result;
+    }
+
+    return submitted;
+}
+
+intptr_t HE::OS::CreateIORing(uint32_t queueDepth)
+{
+    HE_PROFILE_FUNCTION();
+
+    io_uring_params params = {};
+    int fd = (int)syscall(__NR_io_uring_setup, queueDepth, &params);
+    if (fd < 0)
+    {
+        // missing or filtered by seccomp, callers fall back to blocking workers
+        HE_CORE_WARN("CreateIORing : io_uring is unavailable : {}", strerror(errno));
+        return -1;
+    }
+
+    IORing* ring = new IORing();
+    ring->fd = fd;
+    ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    ring->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+    bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMap)
+        ring->sqRingSize = ring->cqRingSize = std::max(ring->sqRingSize, ring->cqRingSize);
+
+    ring->sqRing = mmap(nullptr, ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    ring->cqRing = singleMap ? ring->sqRing : mmap(nullptr, ring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    ring->sqes = (io_uring_sqe*)mmap(nullptr, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+    if (ring->sqRing == MAP_FAILED || ring->cqRing == MAP_FAILED || ring->sqes == MAP_FAILED)
+    {
+        HE_CORE_ERROR("CreateIORing : Unable to map the rings : {}", strerror(errno));
+        DestroyIORing(ring);
+        return -1;
+    }
+
+    uint8_t* sq = (uint8_t*)ring->sqRing;
+    ring->sqHead = (uint32_t*)(sq + params.sq_off.head);
+    ring->sqTail = (uint32_t*)(sq + params.sq_off.tail);
+    ring->sqMask = (uint32_t*)(sq + params.sq_off.ring_mask);
+    ring->sqArray = (uint32_t*)(sq + params.sq_off.array);
+
+    uint8_t* cq = (uint8_t*)ring->cqRing;
+    ring->cqHead = (uint32_t*)(cq + params.cq_off.head);
+    ring->cqTail = (uint32_t*)(cq + params.cq_off.tail);
+    ring->cqMask = (uint32_t*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    ring->slots.resize(queueDepth);
+    ring->requeued.reserve(queueDepth);
+
+    return (intptr_t)ring;
+}
+
+uint32_t HE::OS::SubmitIORing(intptr_t handle, std::span<const IOOperation> operations)
+{
+    HE_PROFILE_FUNCTION();
+
+    IORing* ring = (IORing*)handle;
+
+    std::scoped_lock lock(ring->mutex);
+
+    uint32_t tail = *ring->sqTail;
+    for (const IOOperation& op : operations)
+    {
+        int flags = op.write ? O_WRONLY | O_CREAT | O_CLOEXEC | (op.truncate ? O_TRUNC : 0) : O_RDONLY | O_CLOEXEC;
+        int file = open(op.path.c_str(), flags, 0644);
+
+        IORing::Slot& slot = ring->slots[op.slot];
+        slot.error = file < 0 ? -errno : 0;
+        slot.file = file;
+        slot.data = op.data;
+        slot.size = op.size;
+        slot.offset = op.offset;
+        slot.done = 0;
+        slot.write = op.write;
+
+        QueueTransfer(ring, op.slot, tail);
+    }
+
+    uint32_t submitted = EnterQueued(ring, tail, (uint32_t)operations.size());
+    for (size_t i = submitted; i < operations.size(); i++)
+    {
+        IORing::Slot& slot = ring->slots[operations[i].slot];
+        if (slot.file >= 0)
+            close(slot.file);
+        slot = {};
+    }
+
+    return submitted;
+}
+
+int32_t HE::OS::WaitIORing(intptr_t handle, std::span<IOCompletion> completions)
+{
+    IORing* ring = (IORing*)handle;
+
+    uint32_t count = 0;
+    while (count == 0)
+    {
+        uint32_t head = *ring->cqHead; // only the reaping thread moves the head
+        uint32_t tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+
+        while (head == tail)
+        {
+            if (syscall(__NR_io_uring_enter, ring->fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR)
+            {
+                HE_CORE_ERROR("WaitIORing : io_uring_enter failed : {}", strerror(errno));
+                return -1;
+            }
+
+            tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+        }
+
+        std::scoped_lock lock(ring->mutex);
+
+        // room is kept for every requeued slot, they complete here if the kernel refuses them
+        uint32_t sqTail = *ring->sqTail;
+        ring->requeued.clear();
+
+        while (head != tail && count + ring->requeued.size() < completions.size())
+        {
+            const io_uring_cqe& cqe = ring->cqes[head & *ring->cqMask];
+            uint32_t slot = (uint32_t)cqe.user_data;
+            IORing::Slot& transfer = ring->slots[slot];
+            head++;
+
+            // zero bytes is the end of the file, the short result is reported
+            if (!transfer.error && cqe.res > 0)
+            {
+                transfer.done += cqe.res;
+                if (transfer.done < transfer.size)
+                {
+                    QueueTransfer(ring, slot, sqTail);
+                    ring->requeued.push_back(slot);
+                    continue;
+                }
+            }
+
+            completions[count++] = { slot, transfer.error ? transfer.error : cqe.res < 0 ? cqe.res : int64_t(transfer.done) };
+
+            if (transfer.file >= 0)
+                close(transfer.file);
+            transfer = {};
+        }
+
+        __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+
+        uint32_t submitted = EnterQueued(ring, sqTail, (uint32_t)ring->requeued.size());
+        for (size_t i = submitted; i < ring->requeued.size(); i++)
+        {
+            uint32_t slot = ring->requeued[i];
+            IORing::Slot& transfer = ring->slots[slot];
+            completions[count++] = { slot, -EIO };
+
+            close(transfer.file);
+            transfer = {};
+        }
+    }
+
+    return (int32_t)count;
+}
+
+void HE::OS::CloseIORing(intptr_t ring)
+{
+    DestroyIORing((IORing*)ring);
+}
+
 #pragma endregion
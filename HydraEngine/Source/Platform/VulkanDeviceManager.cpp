@@ -80,6 +80,7 @@ struct VKDeviceManager : public HE::RHI::DeviceManager
             VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME,
             VK_NV_MESH_SHADER_EXTENSION_NAME,
             VK_EXT_MUTABLE_DESCRIPTOR_TYPE_EXTENSION_NAME,
+            VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME,
         },
     };
 
@@ -109,6 +110,7 @@ struct VKDeviceManager : public HE::RHI::DeviceManager
     int presentQueueFamily = -1;
     bool bufferDeviceAddressSupported = false;
     bool swapChainMutableFormatSupported = false;
+    bool displayTimingSupported = false;
     HE::Window* tempWindow = nullptr;
 
 #if VK_HEADER_VERSION >= 301
@@ -163,6 +165,7 @@ struct VKSwapChain : public HE::SwapChain
     void ResizeSwapChain(uint32_t width, uint32_t height) override;
     bool BeginFrame() override;
     bool Present() override;
+    bool GetPastPresentTimings(std::vector<HE::PresentTiming>& timings) override;
     nvrhi::ITexture* GetCurrentBackBuffer() override { return swapChainImages[swapChainIndex].rhiHandle; }
     nvrhi::ITexture* GetBackBuffer(uint32_t index) override { return (index < swapChainImages.size()) ? swapChainImages[index].rhiHandle : nullptr; }
     uint32_t GetCurrentBackBufferIndex() override { return swapChainIndex; }
@@ -974,6 +977,8 @@ bool VKDeviceManager::CreateDeviceImp()
             clusterAccelerationStructureSupported = true;
         else if (ext == VK_EXT_MUTABLE_DESCRIPTOR_TYPE_EXTENSION_NAME)
             mutableDescriptorTypeSupported = true;
+        else if (ext == VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME)
+            displayTimingSupported = true;
     }
 
     void* pNext = nullptr;
@@ -1378,6 +1383,17 @@ bool VKSwapChain::Present()
         .setPSwapchains(&swapChain)
         .setPImageIndices(&swapChainIndex);
 
+    // tag the present so its display time can be matched in GetPastPresentTimings
+    vk::PresentTimeGOOGLE presentTime = vk::PresentTimeGOOGLE()
+        .setPresentID(uint32_t(presentCount));
+
+    vk::PresentTimesInfoGOOGLE presentTimesInfo = vk::PresentTimesInfoGOOGLE()
+        .setSwapchainCount(1)
+        .setPTimes(&presentTime);
+
+    if (vkDeviceManager->displayTimingSupported)
+        info.setPNext(&presentTimesInfo);
+
     const vk::Result res = vkDeviceManager->presentQueue.presentKHR(&info);
     
     if (!(res == vk::Result::eSuccess || res == vk::Result::eErrorOutOfDateKHR || res == vk::Result::eSuboptimalKHR))
@@ -1421,3 +1437,29 @@ bool VKSwapChain::Present()
 
     return true;
 }
+
+bool VKSwapChain::GetPastPresentTimings(std::vector<HE::PresentTiming>& timings)
+{
+    timings.clear();
+
+    // actualPresentTime is CLOCK_MONOTONIC, the clock behind std::chrono::steady_clock on Linux only
+#ifdef HE_PLATFORM_LINUX
+    if (!vkDeviceManager->displayTimingSupported)
+        return false;
+
+    uint32_t count = 0;
+    if (vkDeviceManager->device.getPastPresentationTimingGOOGLE(swapChain, &count, nullptr) != vk::Result::eSuccess)
+        return true;
+
+    std::vector<vk::PastPresentationTimingGOOGLE> pastTimings(count);
+    if (count == 0 || vkDeviceManager->device.getPastPresentationTimingGOOGLE(swapChain, &count, pastTimings.data()) != vk::Result::eSuccess)
+        return true;
+
+    for (uint32_t i = 0; i < count; i++)
+        timings.push_back({ pastTimings[i].presentID, pastTimings[i].actualPresentTime });
+
+    return true;
+#else
+    return false;
+#endif
+}
@@ -2,6 +2,14 @@ module;
 
 #define NOMINMAX
 
+// winsock2 has to come before anything that pulls in windows.h
+#include <winsock2.h>
+#include <afunix.h>
+#pragma comment(lib, "Ws2_32.lib")
+
+#include <Xinput.h>
+#pragma comment(lib, "Xinput.lib")
+
 #include "HydraEngine/Base.h"
 
 #if defined(NVRHI_HAS_D3D11) | defined(NVRHI_HAS_D3D12)
@@ -1053,10 +1061,11 @@ void DX12SwapChain::ReleaseRenderTargets()
 using NativeHandleType = HINSTANCE;
 using NativeSymbolType = FARPROC;
 
-void* HE::Modules::SharedLib::Open(const char* path) noexcept
+void* HE::Modules::SharedLib::Open(const char* path, bool lazyBinding) noexcept
 {
     HE_PROFILE_FUNCTION();
 
+    // imports are always bound at load, deferring them is a link time choice (/DELAYLOAD)
     return LoadLibraryA(path);
 }
 
@@ -1120,6 +1129,79 @@ std::filesystem::path HE::FileSystem::GetAppDataPath(const std::string& appName,
     return appDataPath;
 }
 
+bool HE::FileSystem::MappedFile::MapNative(const std::filesystem::path& filePath, AccessPattern pattern)
+{
+    HE_PROFILE_FUNCTION();
+
+    DWORD flags = FILE_ATTRIBUTE_NORMAL;
+    if (pattern == AccessPattern::Sequential)
+        flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+    else if (pattern == AccessPattern::Random)
+        flags |= FILE_FLAG_RANDOM_ACCESS;
+
+    HANDLE file = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, flags, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        HE_CORE_ERROR("MapFile : Unable to open file {}", filePath.string());
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        HE_CORE_ERROR("MapFile : Unable to get the size of {}", filePath.string());
+        CloseHandle(file);
+        return false;
+    }
+
+    if (fileSize.QuadPart > 0)
+    {
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+        // the view keeps the mapping and the file alive
+        if (mapping)
+            CloseHandle(mapping);
+
+        if (!view)
+        {
+            HE_CORE_ERROR("MapFile : Unable to map file {}", filePath.string());
+            CloseHandle(file);
+            return false;
+        }
+
+        // there is no madvise, queue the whole range up front for sequential readers
+        if (pattern == AccessPattern::Sequential)
+        {
+            WIN32_MEMORY_RANGE_ENTRY range = { view, SIZE_T(fileSize.QuadPart) };
+            PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+        }
+
+        data = (const uint8_t*)view;
+    }
+
+    CloseHandle(file);
+
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+
+    size = uint64_t(fileSize.QuadPart);
+    readableSize = AlignUp(size, uint64_t(info.dwPageSize));
+    mapped = true;
+    return true;
+}
+
+void HE::FileSystem::MappedFile::UnmapNative()
+{
+    if (data)
+        UnmapViewOfFile(data);
+
+    data = nullptr;
+    size = 0;
+    readableSize = 0;
+    mapped = false;
+}
+
 void HE::OS::SetEnvVar(const char* var, const char* value)
 {
     HKEY hKey;
@@ -1154,4 +1236,294 @@ void HE::OS::RemoveEnvVar(const char* var)
     }
 }
 
+static bool InitWinsock()
+{
+    static bool s_Initialized = [] { WSADATA data; return WSAStartup(MAKEWORD(2, 2), &data) == 0; }();
+    return s_Initialized;
+}
+
+intptr_t HE::OS::CreateLocalSocket(const std::filesystem::path& path)
+{
+    HE_PROFILE_FUNCTION();
+
+    if (!InitWinsock())
+        return -1;
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+
+    std::string str = path.string();
+    if (str.size() >= sizeof(addr.sun_path))
+        return -1;
+
+    std::memcpy(addr.sun_path, str.c_str(), str.size() + 1);
+
+    // AF_UNIX sockets are reparse points on Windows, one left behind by a previous run would make bind fail
+    DWORD attributes = GetFileAttributesW(path.c_str());
+    if (attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_REPARSE_POINT))
+        DeleteFileW(path.c_str());
+
+    SOCKET s = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s == INVALID_SOCKET)
+        return -1;
+
+    if (bind(s, (sockaddr*)&addr, sizeof(addr)) == SOCKET_ERROR || listen(s, 8) == SOCKET_ERROR)
+    {
+        closesocket(s);
+        return -1;
+    }
+
+    return intptr_t(s);
+}
+
+intptr_t HE::OS::AcceptLocalSocket(intptr_t socket, uint32_t timeoutMs)
+{
+    WSAPOLLFD pfd{ SOCKET(socket), POLLRDNORM, 0 };
+    if (WSAPoll(&pfd, 1, int(timeoutMs)) <= 0)
+        return -1;
+
+    SOCKET s = accept(SOCKET(socket), nullptr, nullptr);
+    return s == INVALID_SOCKET ? -1 : intptr_t(s);
+}
+
+int HE::OS::ReadLocalSocket(intptr_t socket, void* data, size_t size, uint32_t timeoutMs)
+{
+    WSAPOLLFD pfd{ SOCKET(socket), POLLRDNORM, 0 };
+    if (WSAPoll(&pfd, 1, int(timeoutMs)) <= 0)
+        return 0;
+
+    int n = recv(SOCKET(socket), (char*)data, int(size), 0);
+    return n == SOCKET_ERROR ? -1 : n;
+}
+
+bool HE::OS::WriteLocalSocket(intptr_t socket, const void* data, size_t size)
+{
+    const char* p = (const char*)data;
+    while (size > 0)
+    {
+        int n = send(SOCKET(socket), p, int(std::min<size_t>(size, INT_MAX)), 0);
+        if (n == SOCKET_ERROR || n == 0)
+            return false;
+
+        p += n;
+        size -= size_t(n);
+    }
+
+    return true;
+}
+
+void HE::OS::CloseLocalSocket(intptr_t socket)
+{
+    closesocket(SOCKET(socket));
+}
+
+struct FileWatcher
+{
+    struct Directory
+    {
+        std::filesystem::path path;
+        HANDLE handle = INVALID_HANDLE_VALUE;
+        OVERLAPPED overlapped = {};
+        alignas(DWORD) uint8_t buffer[16 * 1024];
+    };
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Directory>> directories;
+};
+
+static bool IssueDirectoryRead(FileWatcher::Directory& d)
+{
+    return ReadDirectoryChangesW(d.handle, d.buffer, sizeof(d.buffer), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME, nullptr, &d.overlapped, nullptr);
+}
+
+intptr_t HE::OS::CreateFileWatcher()
+{
+    return intptr_t(new FileWatcher());
+}
+
+bool HE::OS::AddFileWatch(intptr_t watcher, const std::filesystem::path& directory)
+{
+    FileWatcher* w = (FileWatcher*)watcher;
+
+    auto d = std::make_unique<FileWatcher::Directory>();
+    d->path = directory;
+    d->handle = CreateFileW(directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (d->handle == INVALID_HANDLE_VALUE)
+        return false;
+
+    d->overlapped.hEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (!d->overlapped.hEvent || !IssueDirectoryRead(*d))
+    {
+        if (d->overlapped.hEvent)
+            CloseHandle(d->overlapped.hEvent);
+        CloseHandle(d->handle);
+        return false;
+    }
+
+    std::scoped_lock lock(w->mutex);
+    w->directories.push_back(std::move(d));
+    return true;
+}
+
+bool HE::OS::ReadFileWatcher(intptr_t watcher, std::vector<std::filesystem::path>& changedFiles, uint32_t timeoutMs)
+{
+    FileWatcher* w = (FileWatcher*)watcher;
+
+    std::vector<HANDLE> events;
+    {
+        std::scoped_lock lock(w->mutex);
+        for (const auto& d : w->directories)
+            events.push_back(d->overlapped.hEvent);
+    }
+
+    if (events.empty())
+    {
+        Sleep(timeoutMs);
+        return true;
+    }
+
+    DWORD result = WaitForMultipleObjects(DWORD(std::min<size_t>(events.size(), MAXIMUM_WAIT_OBJECTS)), events.data(), FALSE, timeoutMs);
+    if (result == WAIT_TIMEOUT)
+        return true;
+
+    if (result == WAIT_FAILED)
+        return false;
+
+    std::scoped_lock lock(w->mutex);
+    for (const auto& d : w->directories)
+    {
+        DWORD size = 0;
+        if (!GetOverlappedResult(d->handle, &d->overlapped, &size, FALSE))
+            continue; // still pending
+
+        // size 0 means the buffer overflowed and the changes were lost, the next build event catches up
+        for (uint8_t* p = d->buffer; size > 0;)
+        {
+            auto* info = (FILE_NOTIFY_INFORMATION*)p;
+            if (info->Action == FILE_ACTION_MODIFIED || info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_RENAMED_NEW_NAME)
+                changedFiles.push_back(d->path / std::wstring(info->FileName, info->FileNameLength / sizeof(WCHAR)));
+
+            if (info->NextEntryOffset == 0)
+                break;
+
+            p += info->NextEntryOffset;
+        }
+
+        if (!IssueDirectoryRead(*d))
+            return false;
+    }
+
+    return true;
+}
+
+void HE::OS::CloseFileWatcher(intptr_t watcher)
+{
+    FileWatcher* w = (FileWatcher*)watcher;
+
+    for (const auto& d : w->directories)
+    {
+        DWORD size = 0;
+        CancelIoEx(d->handle, &d->overlapped);
+        GetOverlappedResult(d->handle, &d->overlapped, &size, TRUE);
+        CloseHandle(d->overlapped.hEvent);
+        CloseHandle(d->handle);
+    }
+
+    delete w;
+}
+
+// XInput pads by user index, XInputGetState is safe to call from any thread. Guide is not exposed by XInput.
+struct XInputPads
+{
+    bool connected[XUSER_MAX_COUNT] = {};
+    uint64_t nextProbe[XUSER_MAX_COUNT] = {}; // XInputGetState stalls on empty slots, they are probed once a second
+};
+
+intptr_t HE::OS::OpenGamepads()
+{
+    return (intptr_t)new XInputPads();
+}
+
+void HE::OS::ReadGamepads(intptr_t gamepads, std::span<GamepadState> states)
+{
+    static constexpr std::pair<WORD, int> c_Buttons[] = {
+        { XINPUT_GAMEPAD_A, HE::GamepadButton::A },
+        { XINPUT_GAMEPAD_B, HE::GamepadButton::B },
+        { XINPUT_GAMEPAD_X, HE::GamepadButton::X },
+        { XINPUT_GAMEPAD_Y, HE::GamepadButton::Y },
+        { XINPUT_GAMEPAD_LEFT_SHOULDER, HE::GamepadButton::LeftBumper },
+        { XINPUT_GAMEPAD_RIGHT_SHOULDER, HE::GamepadButton::RightBumper },
+        { XINPUT_GAMEPAD_BACK, HE::GamepadButton::Back },
+        { XINPUT_GAMEPAD_START, HE::GamepadButton::Start },
+        { XINPUT_GAMEPAD_LEFT_THUMB, HE::GamepadButton::LeftThumb },
+        { XINPUT_GAMEPAD_RIGHT_THUMB, HE::GamepadButton::RightThumb },
+        { XINPUT_GAMEPAD_DPAD_UP, HE::GamepadButton::Up },
+        { XINPUT_GAMEPAD_DPAD_RIGHT, HE::GamepadButton::Right },
+        { XINPUT_GAMEPAD_DPAD_DOWN, HE::GamepadButton::Down },
+        { XINPUT_GAMEPAD_DPAD_LEFT, HE::GamepadButton::Left },
+    };
+
+    // same normalization as GLFW, y flipped to point down
+    auto axis = [](SHORT v) { return std::clamp((float(v) + 0.5f) / 32767.5f, -1.0f, 1.0f); };
+
+    XInputPads& pads = *(XInputPads*)gamepads;
+    uint64_t now = HE::Application::GetTimestamp();
+
+    for (size_t slot = 0; slot < states.size(); slot++)
+    {
+        GamepadState& state = states[slot];
+        state = {};
+
+        if (slot >= XUSER_MAX_COUNT || (!pads.connected[slot] && now < pads.nextProbe[slot]))
+            continue;
+
+        XINPUT_STATE xinput;
+        pads.connected[slot] = XInputGetState(DWORD(slot), &xinput) == ERROR_SUCCESS;
+        if (!pads.connected[slot])
+        {
+            pads.nextProbe[slot] = now + 1'000'000'000ull;
+            continue;
+        }
+
+        const XINPUT_GAMEPAD& pad = xinput.Gamepad;
+        state.connected = true;
+
+        for (const auto& [mask, button] : c_Buttons)
+        {
+            if (pad.wButtons & mask)
+                state.buttons |= 1u << button;
+        }
+
+        state.axes[0] = axis(pad.sThumbLX);
+        state.axes[1] = -axis(pad.sThumbLY);
+        state.axes[2] = axis(pad.sThumbRX);
+        state.axes[3] = -axis(pad.sThumbRY);
+    }
+}
+
+void HE::OS::CloseGamepads(intptr_t gamepads)
+{
+    delete (XInputPads*)gamepads;
+}
+
+// no kernel ring here, AsyncIO runs its blocking workers (the Windows 11 IoRing API could back this later)
+intptr_t HE::OS::CreateIORing(uint32_t queueDepth)
+{
+    return -1;
+}
+
+uint32_t HE::OS::SubmitIORing(intptr_t ring, std::span<const IOOperation> operations)
+{
+    return 0;
+}
+
+int32_t HE::OS::WaitIORing(intptr_t ring, std::span<IOCompletion> completions)
+{
+    return -1;
+}
+
+void HE::OS::CloseIORing(intptr_t ring)
+{
+}
+
 #pragma endregion
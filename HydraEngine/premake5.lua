@@ -116,6 +116,7 @@ project "HydraEngine"
 
     filter "configurations:Dist"
         defines "HE_DIST"
+        if distLogging then defines "HE_DIST_LOGGING" end
         runtime "Release"
         optimize "Speed"
         symbols "Off"
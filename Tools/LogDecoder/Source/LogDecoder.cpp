@@ -0,0 +1,220 @@
+// Renders .helog files written by HydraEngine's binary log mode (LogDesc::Mode::Binary) back to text.
+// usage: LogDecoder <file.helog> [output.txt]
+
+#define FMT_HEADER_ONLY
+#include <spdlog/fmt/bundled/format.h>
+#include <spdlog/fmt/bundled/args.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// must match HydraEngine.cpp and Log::BinaryArgType
+enum class RecordKind : uint8_t { Format, Message, Text };
+enum class ArgType : uint8_t { Int, UInt, Float, Double, Bool, Char, String };
+constexpr uint32_t c_Version = 1;
+
+constexpr const char* c_LevelNames[] = { "trace", "info", "warning", "error", "critical", "off" };
+
+struct Reader
+{
+    std::vector<uint8_t> data;
+    size_t offset = 0;
+
+    bool Has(size_t n) const { return offset + n <= data.size(); }
+
+    template<typename T>
+    bool Read(T& v)
+    {
+        if (!Has(sizeof(T)))
+            return false;
+
+        std::memcpy(&v, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    bool Read(std::string& s, size_t n)
+    {
+        if (!Has(n))
+            return false;
+
+        s.assign((const char*)data.data() + offset, n);
+        offset += n;
+        return true;
+    }
+};
+
+struct RecordHeader
+{
+    uint64_t time;
+    uint32_t thread;
+    uint8_t logger;
+    uint8_t level;
+};
+
+static std::string FormatPrefix(const RecordHeader& h, uint64_t startTime, const std::string& clientName)
+{
+    uint64_t ns = startTime + h.time;
+    std::time_t seconds = std::time_t(ns / 1'000'000'000);
+    std::tm tm = *std::localtime(&seconds);
+
+    const char* level = h.level < std::size(c_LevelNames) ? c_LevelNames[h.level] : "unknown";
+    const char* name = h.logger == 0 ? "Core" : clientName.c_str();
+
+    return fmt::format("[{:02}:{:02}:{:02}.{:03}] [{}] [{}] {}: ", tm.tm_hour, tm.tm_min, tm.tm_sec, (ns / 1'000'000) % 1000, level, h.thread, name);
+}
+
+static bool ReadArgs(Reader& r, uint8_t count, fmt::dynamic_format_arg_store<fmt::format_context>& store)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        ArgType type;
+        if (!r.Read(type))
+            return false;
+
+        switch (type)
+        {
+        case ArgType::Int:    { int64_t v;  if (!r.Read(v)) return false; store.push_back(v); break; }
+        case ArgType::UInt:   { uint64_t v; if (!r.Read(v)) return false; store.push_back(v); break; }
+        case ArgType::Float:  { float v;    if (!r.Read(v)) return false; store.push_back(v); break; }
+        case ArgType::Double: { double v;   if (!r.Read(v)) return false; store.push_back(v); break; }
+        case ArgType::Bool:   { uint8_t v;  if (!r.Read(v)) return false; store.push_back(v != 0); break; }
+        case ArgType::Char:   { char v;     if (!r.Read(v)) return false; store.push_back(v); break; }
+        case ArgType::String:
+        {
+            uint32_t size;
+            std::string v;
+            if (!r.Read(size) || !r.Read(v, size))
+                return false;
+            store.push_back(v);
+            break;
+        }
+        default: return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "usage: LogDecoder <file.helog> [output.txt]\n");
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in.is_open())
+    {
+        std::fprintf(stderr, "LogDecoder : unable to open %s\n", argv[1]);
+        return 1;
+    }
+
+    Reader r;
+    r.data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    std::FILE* out = stdout;
+    if (argc > 2)
+    {
+        out = std::fopen(argv[2], "w");
+        if (!out)
+        {
+            std::fprintf(stderr, "LogDecoder : unable to open %s\n", argv[2]);
+            return 1;
+        }
+    }
+
+    char magic[4];
+    uint32_t version;
+    uint64_t startTime;
+    uint16_t nameSize;
+    std::string clientName;
+    if (!r.Read(magic) || std::string_view(magic, 4) != "HELG" || !r.Read(version) || !r.Read(startTime) || !r.Read(nameSize) || !r.Read(clientName, nameSize))
+    {
+        std::fprintf(stderr, "LogDecoder : %s is not a .helog file\n", argv[1]);
+        return 1;
+    }
+
+    if (version != c_Version)
+    {
+        std::fprintf(stderr, "LogDecoder : unsupported version %u, expected %u\n", version, c_Version);
+        return 1;
+    }
+
+    std::unordered_map<uint64_t, std::string> formats;
+    size_t messageCount = 0;
+    bool truncated = false;
+
+    while (r.offset < r.data.size() && !truncated)
+    {
+        RecordKind kind;
+        r.Read(kind);
+
+        if (kind == RecordKind::Format)
+        {
+            uint64_t id;
+            uint32_t size;
+            std::string format;
+            if (!r.Read(id) || !r.Read(size) || !r.Read(format, size)) { truncated = true; break; }
+            formats[id] = std::move(format);
+            continue;
+        }
+
+        RecordHeader h;
+        if (!r.Read(h.time) || !r.Read(h.thread) || !r.Read(h.logger) || !r.Read(h.level)) { truncated = true; break; }
+
+        std::string message;
+        if (kind == RecordKind::Text)
+        {
+            uint32_t size;
+            if (!r.Read(size) || !r.Read(message, size)) { truncated = true; break; }
+        }
+        else if (kind == RecordKind::Message)
+        {
+            uint64_t id;
+            uint8_t argCount;
+            fmt::dynamic_format_arg_store<fmt::format_context> store;
+            if (!r.Read(id) || !r.Read(argCount) || !ReadArgs(r, argCount, store)) { truncated = true; break; }
+
+            auto it = formats.find(id);
+            if (it == formats.end())
+            {
+                message = fmt::format("<unknown format {:016x}>", id);
+            }
+            else
+            {
+                try { message = fmt::vformat(it->second, store); }
+                catch (const fmt::format_error& e) { message = fmt::format("<{}> {}", e.what(), it->second); }
+            }
+        }
+        else
+        {
+            std::fprintf(stderr, "LogDecoder : unknown record kind %u at offset %zu\n", uint32_t(kind), r.offset - 1);
+            truncated = true;
+            break;
+        }
+
+        std::string line = FormatPrefix(h, startTime, clientName) + message + "\n";
+        std::fwrite(line.data(), 1, line.size(), out);
+        messageCount++;
+    }
+
+    if (truncated)
+        std::fprintf(stderr, "LogDecoder : file ends with an incomplete record, it was probably not flushed\n");
+
+    std::fprintf(stderr, "LogDecoder : decoded %zu messages\n", messageCount);
+
+    if (out != stdout)
+        std::fclose(out);
+
+    return 0;
+}
@@ -0,0 +1,47 @@
+project "LogDecoder"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++latest"
+    staticruntime "off"
+    location (projectLocation)
+    targetdir (binOutputDir)
+    objdir (IntermediatesOutputDir)
+
+    files {
+
+        "Source/**.cpp",
+        "*.lua",
+    }
+
+    defines {
+
+        "_CRT_SECURE_NO_WARNINGS",
+    }
+
+    includedirs {
+
+        "%{IncludeDir.spdlog}",
+    }
+
+    filter "system:windows"
+        systemversion "latest"
+
+    filter "system:linux"
+        systemversion "latest"
+
+    filter "configurations:Debug"
+        runtime "Debug"
+        symbols "On"
+
+    filter "configurations:Release"
+        runtime "Release"
+        optimize "On"
+
+    filter "configurations:Profile"
+        runtime "Release"
+        optimize "On"
+
+    filter "configurations:Dist"
+        runtime "Release"
+        optimize "Speed"
+        symbols "Off"
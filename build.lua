@@ -3,6 +3,7 @@
 -------------------------------------------------------------------------------------
 HE = path.getabsolute(".")
 if includSourceCode == nil then includSourceCode = true end -- includSourceCode defaults to true, it should be included in client project
+if distLogging == nil then distLogging = false end -- keeps HE_* logging in Dist (HE_DIST_LOGGING), meant for LogDesc::Mode::Binary
 
 if RHI == nil then RHI = {} end
 if RHI.enableD3D11  == nil then RHI.enableD3D11 = os.host() == "windows" end 
@@ -274,6 +275,7 @@ function SetHydraFilters()
 
     filter "configurations:Dist"
         defines "HE_DIST"
+        if distLogging then defines "HE_DIST_LOGGING" end
         runtime "Release"
         optimize "Speed"
         symbols "Off"
@@ -31,4 +31,7 @@ workspace "HydraEngine"
 
     group "HydraEngine"
         include "HydraEngine"
+
+    group "Tools"
+        include "Tools/LogDecoder"
         
\ No newline at end of file